@@ -0,0 +1,81 @@
+#!/usr/bin/env bash
+# Runs a dedicated server and N headless bot clients of the bomb game on this machine, over loopback,
+# and collects the server's load test CSVs. Only the server runs the instrumented ULoadTestNetDriver,
+# through an engine ini it gets on the command line. Every other session keeps the default driver.
+#
+# Usage: Scripts/RunLoadTest.sh [NumClients] [Seconds]
+#
+# Environment:
+#   UE4_EDITOR   Path to the Linux UE4Editor binary (required)
+#   MAP          Map the server opens. Its game mode has to spawn ACharacterV2 pawns
+#   GAME_MODE    Optional ?game= override for the map
+#   PORT         Server port (default 7777)
+#   OUT_DIR      Where the CSVs and logs go (default Saved/LoadTest/<timestamp>)
+#   PKT_LAG      Optional lag, in ms, the clients add to their outgoing packets. Needs a non-shipping build
+
+set -euo pipefail
+
+NUM_CLIENTS="${1:-8}"
+DURATION="${2:-60}"
+
+PROJECT_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+PROJECT="$PROJECT_DIR/TestingGrounds.uproject"
+MAP="${MAP:-/Game/Static/Levels/FirstPersonExampleMap}"
+PORT="${PORT:-7777}"
+OUT_DIR="${OUT_DIR:-$PROJECT_DIR/Saved/LoadTest/$(date +%Y%m%d-%H%M%S)}"
+
+if [ -z "${UE4_EDITOR:-}" ] || [ ! -x "$UE4_EDITOR" ]; then
+    echo "Set UE4_EDITOR to the UE4Editor binary" >&2
+    exit 1
+fi
+
+mkdir -p "$OUT_DIR"
+
+SERVER_URL="$MAP"
+if [ -n "${GAME_MODE:-}" ]; then
+    SERVER_URL="$SERVER_URL?game=$GAME_MODE"
+fi
+
+# The project's engine ini with the load test driver as the game net driver. The repeated section merges into the first
+SERVER_ENGINE_INI="$OUT_DIR/LoadTestEngine.ini"
+cp "$PROJECT_DIR/Config/DefaultEngine.ini" "$SERVER_ENGINE_INI"
+cat >> "$SERVER_ENGINE_INI" <<'INI'
+
+[/Script/Engine.Engine]
+!NetDriverDefinitions=ClearArray
++NetDriverDefinitions=(DefName="GameNetDriver",DriverClassName="/Script/TestingGrounds.LoadTestNetDriver",DriverClassNameFallback="/Script/OnlineSubsystemUtils.IpNetDriver")
++NetDriverDefinitions=(DefName="DemoNetDriver",DriverClassName="/Script/Engine.DemoNetDriver",DriverClassNameFallback="/Script/Engine.DemoNetDriver")
+INI
+
+CLIENT_PIDS=()
+cleanup() {
+    # Bash before 4.4 treats an empty array as unset under set -u
+    for PID in ${CLIENT_PIDS[@]+"${CLIENT_PIDS[@]}"}; do
+        kill "$PID" 2>/dev/null || true
+    done
+}
+trap cleanup EXIT
+
+# Seconds the clients get to join. The first rows of the CSVs cover that ramp up
+JOIN_TIME=10
+
+# The server records from the start, then writes the CSVs and exits on its own
+echo "Starting the server on port $PORT"
+"$UE4_EDITOR" "$PROJECT" "$SERVER_URL" -server -nullrhi -nosound -unattended -log \
+    -port="$PORT" -abslog="$OUT_DIR/Server.log" -DEFENGINEINI="$SERVER_ENGINE_INI" \
+    -ExecCmds="tg.LoadTest.Start $((DURATION + JOIN_TIME)) $OUT_DIR/LoadTest exit" &
+SERVER_PID=$!
+
+sleep "$JOIN_TIME"
+
+for ((i = 0; i < NUM_CLIENTS; i++)); do
+    echo "Starting bot client $i"
+    "$UE4_EDITOR" "$PROJECT" "127.0.0.1:$PORT" -game -nullrhi -nosound -unattended -LoadTestBot \
+        -abslog="$OUT_DIR/Client$i.log" -ExecCmds="Net PktLag=${PKT_LAG:-0}" &
+    CLIENT_PIDS+=($!)
+done
+
+wait "$SERVER_PID"
+
+echo "Results:"
+ls -1 "$OUT_DIR"/LoadTest_*.csv
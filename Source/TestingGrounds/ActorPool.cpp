@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "ActorPool.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogActorPool, Log, All);
+
+// Sets default values
+AActorPool::AActorPool()
+{
+    // The pool only reacts to acquire/release calls
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+void AActorPool::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    Super::EndPlay(EndPlayReason);
+
+    // Useful when sizing the pre-warm counts
+    UE_LOG(LogActorPool, Log, TEXT("%s: %d spawned, peak %d active, %d overflows"),
+           *GetClass()->GetName(), GetNumActive() + GetNumFree(), PeakActive, OverflowCount);
+}
+
+void AActorPool::PrewarmActors(UClass* ActorClass, int32 Count)
+{
+    if (ActorClass == nullptr) return;
+
+    FActorPoolBucket& Bucket = FindOrAddBucket(ActorClass);
+    while (Bucket.NumSpawned < Count)
+    {
+        AActor* Actor = SpawnPooledActor(Bucket);
+        if (Actor == nullptr) break;
+
+        Bucket.FreeActors.Add(Actor);
+    }
+}
+
+AActor* AActorPool::AcquireActor(UClass* ActorClass)
+{
+    if (ActorClass == nullptr) return nullptr;
+
+    FActorPoolBucket& Bucket = FindOrAddBucket(ActorClass);
+
+    AActor* Actor = nullptr;
+    while (Actor == nullptr && Bucket.FreeActors.Num() > 0)
+    {
+        // Something else may have destroyed a parked actor (level streaming, editor)
+        Actor = Bucket.FreeActors.Pop(false);
+        if (Actor && Actor->IsPendingKill())
+        {
+            Bucket.NumSpawned--;
+            Actor = nullptr;
+        }
+    }
+
+    if (Actor == nullptr)
+    {
+        // Every pooled actor is in use - grow the pool
+        Actor = SpawnPooledActor(Bucket);
+        if (Actor == nullptr) return nullptr;
+
+        OverflowCount++;
+    }
+
+    Bucket.NumActive++;
+    PeakActive = FMath::Max(PeakActive, GetNumActive());
+    return Actor;
+}
+
+void AActorPool::ReleaseActor(AActor* Actor)
+{
+    if (Actor == nullptr) return;
+
+    FActorPoolBucket& Bucket = FindOrAddBucket(Actor->GetClass());
+    Bucket.NumActive--;
+    Bucket.FreeActors.Add(Actor);
+
+    ParkPooledActor(Actor);
+}
+
+int32 AActorPool::GetNumActive() const
+{
+    int32 NumActive = 0;
+    for (const FActorPoolBucket& Bucket : Buckets) NumActive += Bucket.NumActive;
+    return NumActive;
+}
+
+int32 AActorPool::GetNumFree() const
+{
+    int32 NumFree = 0;
+    for (const FActorPoolBucket& Bucket : Buckets) NumFree += Bucket.FreeActors.Num();
+    return NumFree;
+}
+
+FActorPoolBucket& AActorPool::FindOrAddBucket(UClass* ActorClass)
+{
+    // A pool only ever sees a handful of classes, a linear search is fine
+    for (FActorPoolBucket& Bucket : Buckets)
+    {
+        if (Bucket.ActorClass == ActorClass) return Bucket;
+    }
+
+    FActorPoolBucket& NewBucket = Buckets[Buckets.AddDefaulted()];
+    NewBucket.ActorClass = ActorClass;
+    return NewBucket;
+}
+
+AActor* AActorPool::SpawnPooledActor(FActorPoolBucket& Bucket)
+{
+    // Spawn deferred so the actor knows it's pooled by the time BeginPlay runs
+    AActor* Actor = GetWorld()->SpawnActorDeferred<AActor>(Bucket.ActorClass, GetActorTransform());
+    if (Actor == nullptr) return nullptr;
+
+    InitPooledActor(Actor);
+    Actor->FinishSpawning(GetActorTransform());
+    ParkPooledActor(Actor);
+
+    Bucket.NumSpawned++;
+    return Actor;
+}
@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "ActorPool.generated.h"
+
+// The pooled instances of a single actor class
+USTRUCT()
+struct FActorPoolBucket
+{
+    GENERATED_BODY()
+
+    // The class every actor in this bucket was spawned from
+    UPROPERTY()
+    UClass* ActorClass = nullptr;
+
+    // Actors that are parked and ready to be handed out
+    UPROPERTY()
+    TArray<AActor*> FreeActors;
+
+    // The number of actors currently handed out
+    int32 NumActive = 0;
+
+    // The number of actors this bucket has ever spawned
+    int32 NumSpawned = 0;
+};
+
+/**
+ * Base of the per-world pools of short-lived combat actors, keyed by class.
+ * Actors are spawned once, handed out and parked again, so sustained fire doesn't churn actor spawns and garbage collection.
+ * Subclasses hand out a typed actor and tell the pool how to mark and park it.
+ */
+UCLASS(Abstract)
+class TESTINGGROUNDS_API AActorPool : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AActorPool();
+
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    // Returns the number of actors currently handed out
+    UFUNCTION(BlueprintCallable, Category = "ActorPool")
+    int32 GetNumActive() const;
+
+    // Returns the number of actors waiting in the pool
+    UFUNCTION(BlueprintCallable, Category = "ActorPool")
+    int32 GetNumFree() const;
+
+    // Returns how many times the pool had to grow past its pre-warmed size
+    UFUNCTION(BlueprintCallable, Category = "ActorPool")
+    int32 GetOverflowCount() const { return OverflowCount; }
+
+    // Returns the highest number of actors that were handed out at once
+    UFUNCTION(BlueprintCallable, Category = "ActorPool")
+    int32 GetPeakActive() const { return PeakActive; }
+
+protected:
+    // Makes sure at least Count actors of the given class exist in the pool
+    void PrewarmActors(UClass* ActorClass, int32 Count);
+
+    /**
+     * Hands out a parked actor of the given class, for the subclass to launch.
+     * Spawns a new one (and counts an overflow) if every pooled actor is in use.
+     */
+    AActor* AcquireActor(UClass* ActorClass);
+
+    // Parks the actor until it gets handed out again. The subclass checks it isn't parked already
+    void ReleaseActor(AActor* Actor);
+
+    // Called on every actor the pool spawns, before FinishSpawning
+    virtual void InitPooledActor(AActor* Actor) {}
+
+    // Stops and hides the actor. Called when it gets spawned and every time it gets released
+    virtual void ParkPooledActor(AActor* Actor) {}
+
+private:
+    // Returns the bucket of the given class, creating it if needed
+    FActorPoolBucket& FindOrAddBucket(UClass* ActorClass);
+
+    // Spawns a new parked actor for the given bucket
+    AActor* SpawnPooledActor(FActorPoolBucket& Bucket);
+
+    UPROPERTY()
+    TArray<FActorPoolBucket> Buckets;
+
+    int32 OverflowCount = 0;
+
+    int32 PeakActive = 0;
+};
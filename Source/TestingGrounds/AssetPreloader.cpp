@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "AssetPreloader.h"
+#include "WorldManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogAssetPreloader, Log, All);
+
+
+// Sets default values
+AAssetPreloader::AAssetPreloader()
+{
+    // Driven by the streamable manager's callbacks
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+void AAssetPreloader::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    // The next map requests what it needs itself
+    for (FAssetBundleState& Bundle : Bundles)
+    {
+        for (const FStringAssetReference& Asset : Bundle.Assets) Streamable.Unload(Asset);
+        Bundle.Assets.Empty();
+        Bundle.NumPendingRequests = 0;
+    }
+    NumPendingRequests = 0;
+
+    Super::EndPlay(EndPlayReason);
+}
+
+AAssetPreloader* AAssetPreloader::Get(UWorld* World)
+{
+    return GetWorldManager<AAssetPreloader>(World);
+}
+
+void AAssetPreloader::RequestAssets(EAssetBundle Bundle, const TArray<FStringAssetReference>& Assets, FSimpleDelegate OnLoaded)
+{
+    TArray<FStringAssetReference> ValidAssets;
+    for (const FStringAssetReference& Asset : Assets)
+    {
+        if (Asset.IsValid()) ValidAssets.AddUnique(Asset);
+    }
+
+    if (ValidAssets.Num() == 0)
+    {
+        OnLoaded.ExecuteIfBound();
+        return;
+    }
+
+    FAssetBundleState& BundleState = Bundles[(int32)Bundle];
+    for (const FStringAssetReference& Asset : ValidAssets) BundleState.Assets.AddUnique(Asset);
+
+    // Counted before the request, the streamable manager calls back right away when everything is in already
+    BundleState.NumPendingRequests++;
+    NumPendingRequests++;
+    Streamable.RequestAsyncLoad(ValidAssets, FStreamableDelegate::CreateUObject(this, &AAssetPreloader::OnRequestLoaded, Bundle, OnLoaded));
+}
+
+bool AAssetPreloader::IsBundleLoaded(EAssetBundle Bundle) const
+{
+    return Bundles[(int32)Bundle].NumPendingRequests == 0;
+}
+
+void AAssetPreloader::OnRequestLoaded(EAssetBundle Bundle, FSimpleDelegate OnLoaded)
+{
+    FAssetBundleState& BundleState = Bundles[(int32)Bundle];
+    BundleState.NumPendingRequests = FMath::Max(BundleState.NumPendingRequests - 1, 0);
+    NumPendingRequests = FMath::Max(NumPendingRequests - 1, 0);
+
+    OnLoaded.ExecuteIfBound();
+
+    // The first time nothing is left to load, the game is playable
+    if (NumPendingRequests == 0 && !bReportedFirstPlayableFrame)
+    {
+        bReportedFirstPlayableFrame = true;
+        const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+        UE_LOG(LogAssetPreloader, Log, TEXT("First playable frame %.2f s after startup, %.1f MB resident"),
+               FPlatformTime::Seconds() - GStartTime, MemoryStats.UsedPhysical / (1024.f * 1024.f));
+    }
+}
+
+void AAssetPreloader::LogReport() const
+{
+    const UEnum* BundleEnum = FindObject<UEnum>(ANY_PACKAGE, TEXT("EAssetBundle"));
+    for (int32 i = 0; i < (int32)EAssetBundle::MAX; i++)
+    {
+        const FAssetBundleState& BundleState = Bundles[i];
+        int32 NumResident = 0;
+        for (const FStringAssetReference& Asset : BundleState.Assets)
+        {
+            if (Asset.ResolveObject()) NumResident++;
+        }
+        UE_LOG(LogAssetPreloader, Log, TEXT("%s: %d assets, %d resident, %d requests loading"),
+               BundleEnum ? *BundleEnum->GetEnumName(i) : *FString::FromInt(i), BundleState.Assets.Num(), NumResident, BundleState.NumPendingRequests);
+        for (const FStringAssetReference& Asset : BundleState.Assets)
+        {
+            UE_LOG(LogAssetPreloader, Log, TEXT("    %s%s"), *Asset.ToString(), Asset.ResolveObject() ? TEXT("") : TEXT(" (not loaded)"));
+        }
+    }
+
+    const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+    UE_LOG(LogAssetPreloader, Log, TEXT("%.1f MB resident, %.2f s since startup"),
+           MemoryStats.UsedPhysical / (1024.f * 1024.f), FPlatformTime::Seconds() - GStartTime);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Console commands
+
+static void ReportAssets(UWorld* World)
+{
+    AAssetPreloader* Preloader = AAssetPreloader::Get(World);
+    if (Preloader) Preloader->LogReport();
+}
+
+static FAutoConsoleCommandWithWorld ReportAssetsCommand(
+    TEXT("tg.Assets.Report"),
+    TEXT("Logs the asset bundles of the world, what of them is resident, and the memory in use"),
+    FConsoleCommandWithWorldDelegate::CreateStatic(&ReportAssets));
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "Engine/StreamableManager.h"
+#include "AssetPreloader.generated.h"
+
+// The groups of soft-referenced assets the game loads together
+UENUM(BlueprintType)
+enum class EAssetBundle : uint8
+{
+    // Guns, bombs and their effects
+    Combat,
+    // Crosshair and inventory icons
+    UI,
+    // Skill classes and their effects
+    Skills,
+    MAX UMETA(Hidden)
+};
+
+/**
+ * Per-world asynchronous loader of the game's soft references, grouped in bundles.
+ * Actors request the assets they need when they begin play, so only what the current map uses gets loaded.
+ * Everything a world requested is released when the world ends.
+ * Logs the time to the first frame with every bundle in; tg.Assets.Report logs the bundles and memory.
+ */
+UCLASS()
+class TESTINGGROUNDS_API AAssetPreloader : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AAssetPreloader();
+
+    // Releases everything the world requested
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    // Returns the preloader of the given world, spawning it if needed
+    static AAssetPreloader* Get(UWorld* World);
+
+    /**
+     * Adds the assets to the bundle and loads them asynchronously.
+     * OnLoaded runs once they're all in, right away if they already are. Null references are skipped.
+     */
+    void RequestAssets(EAssetBundle Bundle, const TArray<FStringAssetReference>& Assets, FSimpleDelegate OnLoaded = FSimpleDelegate());
+
+    // True while a request is still loading, the HUD shows the loading screen meanwhile
+    UFUNCTION(BlueprintCallable, Category = "Assets")
+    bool IsLoading() const { return NumPendingRequests > 0; }
+
+    UFUNCTION(BlueprintCallable, Category = "Assets")
+    bool IsBundleLoaded(EAssetBundle Bundle) const;
+
+    // Logs the assets of every bundle and the memory in use
+    void LogReport() const;
+
+private:
+    // Called by the streamable manager once a request is in
+    void OnRequestLoaded(EAssetBundle Bundle, FSimpleDelegate OnLoaded);
+
+    struct FAssetBundleState
+    {
+        TArray<FStringAssetReference> Assets;
+        int32 NumPendingRequests = 0;
+    };
+
+    FAssetBundleState Bundles[(int32)EAssetBundle::MAX];
+
+    FStreamableManager Streamable;
+
+    int32 NumPendingRequests = 0;
+
+    bool bReportedFirstPlayableFrame = false;
+};
@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "BenchmarkUtils.h"
+
+DEFINE_LOG_CATEGORY(LogBenchmark);
+
+
+FScopedBenchmarkCVar::FScopedBenchmarkCVar(const TCHAR* Name, int32 Value)
+    : CVar(IConsoleManager::Get().FindConsoleVariable(Name))
+{
+    if (CVar)
+    {
+        PreviousValue = CVar->GetInt();
+        CVar->Set(Value);
+    }
+    else
+    {
+        UE_LOG(LogBenchmark, Warning, TEXT("No console variable %s, the benchmark runs with the current settings"), Name);
+    }
+}
+
+FScopedBenchmarkCVar::~FScopedBenchmarkCVar()
+{
+    if (CVar) CVar->Set(PreviousValue);
+}
+
+void FScopedBenchmarkCVar::Set(int32 Value)
+{
+    if (CVar) CVar->Set(Value);
+}
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Every tg.Bench* command logs its results here
+DECLARE_LOG_CATEGORY_EXTERN(LogBenchmark, Log, All);
+
+// The positional arguments of a benchmark command, with a default for every missing or too small one
+class FBenchmarkArgs
+{
+public:
+    explicit FBenchmarkArgs(const TArray<FString>& InArgs) : Args(InArgs) {}
+
+    int32 GetInt(int32 Index, int32 Default, int32 Min = 1) const
+    {
+        return Args.IsValidIndex(Index) ? FMath::Max(FCString::Atoi(*Args[Index]), Min) : Default;
+    }
+
+    float GetFloat(int32 Index, float Default, float Min = 1.f) const
+    {
+        return Args.IsValidIndex(Index) ? FMath::Max(FCString::Atof(*Args[Index]), Min) : Default;
+    }
+
+private:
+    const TArray<FString>& Args;
+};
+
+// Wall clock time since construction or the last Restart
+class FBenchmarkTimer
+{
+public:
+    FBenchmarkTimer() : StartTime(FPlatformTime::Seconds()) {}
+
+    void Restart() { StartTime = FPlatformTime::Seconds(); }
+
+    double GetSeconds() const { return FPlatformTime::Seconds() - StartTime; }
+
+    double GetMs() const { return GetSeconds() * 1000.0; }
+
+private:
+    double StartTime;
+};
+
+// Adds the wall clock time of its scope to Seconds
+class FScopedBenchmarkTimer
+{
+public:
+    explicit FScopedBenchmarkTimer(double& InSeconds) : Seconds(InSeconds) {}
+
+    ~FScopedBenchmarkTimer() { Seconds += Timer.GetSeconds(); }
+
+private:
+    double& Seconds;
+    FBenchmarkTimer Timer;
+};
+
+// Sets an integer console variable for the length of a benchmark and puts the old value back afterwards
+class FScopedBenchmarkCVar
+{
+public:
+    FScopedBenchmarkCVar(const TCHAR* Name, int32 Value);
+
+    ~FScopedBenchmarkCVar();
+
+    void Set(int32 Value);
+
+private:
+    IConsoleVariable* CVar;
+    int32 PreviousValue = 0;
+};
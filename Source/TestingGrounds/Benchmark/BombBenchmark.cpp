@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "BenchmarkUtils.h"
+#include "EngineUtils.h"
+#include "../Weapons/Bomb.h"
+#include "../Player/CharacterV2.h"
+#include "../LoadTest/LoadTestNetDriver.h"
+
+// The state of a running bomb replication benchmark
+struct FBombReplicationBenchmark
+{
+    FBombReplicationBenchmark() : Dormancy(TEXT("tg.Net.BombDormancy"), 0) {}
+
+    TWeakObjectPtr<UWorld> World;
+    TSubclassOf<ABomb> BombClass;
+    int32 NumBombs = 0;
+    float MeasureSeconds = 0.f;
+    TArray<TWeakObjectPtr<ABomb>> Bombs;
+    FTimerHandle TimerHandle;
+
+    // Back to what it was once the last phase lets go of the benchmark
+    FScopedBenchmarkCVar Dormancy;
+};
+
+static void DestroyBenchmarkBombs(FBombReplicationBenchmark& Benchmark)
+{
+    for (const TWeakObjectPtr<ABomb>& Bomb : Benchmark.Bombs)
+    {
+        if (Bomb.IsValid()) Bomb->Destroy();
+    }
+    Benchmark.Bombs.Reset();
+}
+
+// Spawns the bombs, lets them settle, then measures the replication time of the net driver
+static void RunBombReplicationPhase(TSharedRef<FBombReplicationBenchmark> Benchmark, bool bDormancy)
+{
+    UWorld* World = Benchmark->World.Get();
+    if (World == nullptr) return;
+
+    Benchmark->Dormancy.Set(bDormancy ? 1 : 0);
+
+    // Spread the bombs around the players, with a fuse long enough to outlast the measurement
+    const float SettleSeconds = 3.f;
+    const float SpawnRadius = 2000.f;
+    FRandomStream Random(Benchmark->NumBombs);
+
+    TArray<AActor*> Players;
+    for (TActorIterator<APawn> It(World); It; ++It)
+    {
+        Players.Add(*It);
+    }
+
+    for (int32 i = 0; i < Benchmark->NumBombs && Players.Num() > 0; i++)
+    {
+        const FVector Origin = Players[i % Players.Num()]->GetActorLocation();
+        const FVector Offset(Random.FRandRange(-1.f, 1.f) * SpawnRadius, Random.FRandRange(-1.f, 1.f) * SpawnRadius, 200.f);
+        const FTransform Transform(FRotator(-45.f, Random.FRandRange(0.f, 360.f), 0.f), Origin + Offset);
+
+        ABomb* Bomb = World->SpawnActorDeferred<ABomb>(Benchmark->BombClass, Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+        if (Bomb == nullptr) continue;
+
+        Bomb->SetFuseTime(SettleSeconds + Benchmark->MeasureSeconds + 60.f);
+        UGameplayStatics::FinishSpawningActor(Bomb, Transform);
+        Benchmark->Bombs.Add(Bomb);
+    }
+
+    World->GetTimerManager().SetTimer(Benchmark->TimerHandle, FTimerDelegate::CreateLambda([Benchmark, bDormancy]()
+    {
+        UWorld* World = Benchmark->World.Get();
+        ULoadTestNetDriver* NetDriver = World ? Cast<ULoadTestNetDriver>(World->GetNetDriver()) : nullptr;
+        if (NetDriver == nullptr) return;
+
+        NetDriver->ResetCounters();
+
+        World->GetTimerManager().SetTimer(Benchmark->TimerHandle, FTimerDelegate::CreateLambda([Benchmark, bDormancy]()
+        {
+            UWorld* World = Benchmark->World.Get();
+            ULoadTestNetDriver* NetDriver = World ? Cast<ULoadTestNetDriver>(World->GetNetDriver()) : nullptr;
+            if (NetDriver == nullptr) return;
+
+            int32 NumDormant = 0;
+            for (const TWeakObjectPtr<ABomb>& Bomb : Benchmark->Bombs)
+            {
+                if (Bomb.IsValid() && Bomb->NetDormancy > DORM_Awake) NumDormant++;
+            }
+
+            UE_LOG(LogBenchmark, Log, TEXT("%d bombs, dormancy %s: %.4f ms replication per net frame (%d dormant)"),
+                   Benchmark->Bombs.Num(), bDormancy ? TEXT("on") : TEXT("off"),
+                   NetDriver->GetReplicationTimeMs() / FMath::Max(NetDriver->GetNumReplicationFrames(), 1), NumDormant);
+
+            DestroyBenchmarkBombs(*Benchmark);
+
+            if (!bDormancy) RunBombReplicationPhase(Benchmark, true);
+        }), Benchmark->MeasureSeconds, false);
+    }), SettleSeconds, false);
+}
+
+// Measures the server replication time with hundreds of resting bombs, with and without dormancy
+static void BenchmarkBombReplication(const TArray<FString>& Args, UWorld* World)
+{
+    ULoadTestNetDriver* NetDriver = Cast<ULoadTestNetDriver>(World->GetNetDriver());
+    if (NetDriver == nullptr || World->GetNetMode() == NM_Client || NetDriver->ClientConnections.Num() == 0)
+    {
+        UE_LOG(LogBenchmark, Warning, TEXT("tg.BenchBombReplication needs a server with a LoadTestNetDriver and connected clients"));
+        return;
+    }
+
+    const FBenchmarkArgs BenchmarkArgs(Args);
+    TSharedRef<FBombReplicationBenchmark> Benchmark = MakeShareable(new FBombReplicationBenchmark());
+    Benchmark->World = World;
+    Benchmark->NumBombs = BenchmarkArgs.GetInt(0, 300);
+    Benchmark->MeasureSeconds = BenchmarkArgs.GetFloat(1, 5.f);
+
+    // Use the bomb blueprint of the characters, so the bombs have their real mesh and collision
+    Benchmark->BombClass = ABomb::StaticClass();
+    for (TActorIterator<ACharacterV2> It(World); It; ++It)
+    {
+        if (It->BombActorBP.Get())
+        {
+            Benchmark->BombClass = It->BombActorBP.Get();
+            break;
+        }
+    }
+
+    RunBombReplicationPhase(Benchmark, false);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchBombReplicationCommand(
+    TEXT("tg.BenchBombReplication"),
+    TEXT("Times server replication with hundreds of resting bombs, without and with dormancy. Usage: tg.BenchBombReplication [NumBombs] [Seconds]"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchmarkBombReplication));
@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "BenchmarkUtils.h"
+#include "../LagCompensation.h"
+
+// Records a history of characters running around at 60 fps and validates hits against it, half of them off target
+static void BenchLagCompensation(const TArray<FString>& Args)
+{
+    const FBenchmarkArgs BenchmarkArgs(Args);
+    const int32 NumCharacters = BenchmarkArgs.GetInt(0, 64);
+    const int32 ValidationsPerSecond = BenchmarkArgs.GetInt(1, 1000);
+    const float Seconds = BenchmarkArgs.GetFloat(2, 10.f);
+    const float FrameSeconds = 1.f / 60.f;
+    const float MaxRewindSeconds = 0.5f;
+    const float Radius = 34.f;
+    const float HalfHeight = 88.f;
+
+    FCapsuleHistory History;
+    History.Init(128, NumCharacters);
+    for (int32 i = 0; i < NumCharacters; i++) History.AddSlot();
+
+    // Everybody runs circles of their own
+    FRandomStream Random(NumCharacters);
+    TArray<FVector> Centers;
+    TArray<float> Phases;
+    for (int32 i = 0; i < NumCharacters; i++)
+    {
+        Centers.Add(FVector(Random.FRandRange(-5000.f, 5000.f), Random.FRandRange(-5000.f, 5000.f), HalfHeight));
+        Phases.Add(Random.FRandRange(0.f, 2.f * PI));
+    }
+    auto GetLocation = [&Centers, &Phases](int32 Character, float Time)
+    {
+        const float Angle = Phases[Character] + Time * 1.5f;
+        return Centers[Character] + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f) * 400.f;
+    };
+
+    TArray<FCapsuleHitQuery> Queries;
+    const int32 NumFrames = FMath::CeilToInt(Seconds / FrameSeconds);
+    double RecordSeconds = 0.0;
+    double ValidateSeconds = 0.0;
+    double WorstFrameMs = 0.0;
+    int32 NumValidations = 0;
+    int32 NumWrong = 0;
+    float PendingValidations = 0.f;
+
+    for (int32 Frame = 0; Frame < NumFrames; Frame++)
+    {
+        const float Now = Frame * FrameSeconds;
+
+        FBenchmarkTimer Timer;
+        History.BeginFrame(Now);
+        for (int32 i = 0; i < NumCharacters; i++) History.Record(i, GetLocation(i, Now), Radius, HalfHeight);
+        const double RecordFrameSeconds = Timer.GetSeconds();
+        RecordSeconds += RecordFrameSeconds;
+
+        // The hits reported this frame, seen up to MaxRewindSeconds ago. Even ones on target, odd ones a meter off
+        Queries.Reset();
+        PendingValidations += ValidationsPerSecond * FrameSeconds;
+        for (; PendingValidations >= 1.f; PendingValidations -= 1.f)
+        {
+            const int32 Victim = Random.RandHelper(NumCharacters);
+            const float ViewTime = FMath::Max(Now - Random.FRandRange(0.f, MaxRewindSeconds), 0.f);
+            const bool bOnTarget = (Queries.Num() % 2 == 0);
+
+            FCapsuleHitQuery& Query = Queries[Queries.AddDefaulted()];
+            Query.Slot = Victim;
+            Query.Time = ViewTime;
+            Query.Location = GetLocation(Victim, ViewTime) + Random.GetUnitVector() * (bOnTarget ? Radius * 0.5f : Radius + 100.f);
+            Query.UserIndex = bOnTarget ? 1 : 0;
+        }
+
+        Timer.Restart();
+        History.TestHits(Queries, 30.f);
+        const double ValidateFrameSeconds = Timer.GetSeconds();
+        ValidateSeconds += ValidateFrameSeconds;
+        WorstFrameMs = FMath::Max(WorstFrameMs, (RecordFrameSeconds + ValidateFrameSeconds) * 1000.0);
+
+        NumValidations += Queries.Num();
+        for (const FCapsuleHitQuery& Query : Queries)
+        {
+            if (Query.bHit != (Query.UserIndex == 1)) NumWrong++;
+        }
+    }
+
+    UE_LOG(LogBenchmark, Log, TEXT("%d characters, %d frames at 60 fps, %d validations a second:"), NumCharacters, NumFrames, ValidationsPerSecond);
+    UE_LOG(LogBenchmark, Log, TEXT("  History: %.2f us a frame, %.1f KB"),
+           RecordSeconds * 1000000.0 / NumFrames, 128 * NumCharacters * (sizeof(FVector) + 2 * sizeof(float)) / 1024.f);
+    UE_LOG(LogBenchmark, Log, TEXT("  Validation: %.2f us a frame, %.0f validations a second of CPU, worst frame %.3f ms, %d of %d decided wrong"),
+           ValidateSeconds * 1000000.0 / NumFrames, ValidateSeconds > 0.0 ? NumValidations / ValidateSeconds : 0.0, WorstFrameMs, NumWrong, NumValidations);
+}
+
+static FAutoConsoleCommand BenchLagCompensationCommand(
+    TEXT("tg.BenchLagCompensation"),
+    TEXT("Measures the capsule history and hit validation of the lag compensation. Usage: tg.BenchLagCompensation [NumCharacters=64] [ValidationsPerSecond=1000] [Seconds=10]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&BenchLagCompensation));
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "BenchmarkUtils.h"
+#include "../NPC/PatrolPathCache.h"
+#include "../NPC/PatrolRoute.h"
+#include "AI/Navigation/NavigationSystem.h"
+#include "AI/Navigation/NavigationData.h"
+
+// Paths every leg of every route once per guard, as without the cache, then takes the same legs from the cache
+static void BenchmarkPatrolPaths(const TArray<FString>& Args, UWorld* World)
+{
+    APatrolPathCache* Cache = APatrolPathCache::Get(World);
+    UNavigationSystem* NavSys = UNavigationSystem::GetCurrent<UNavigationSystem>(World);
+    ANavigationData* NavData = NavSys ? NavSys->GetMainNavData(FNavigationSystem::DontCreate) : nullptr;
+    if (Cache == nullptr || NavData == nullptr)
+    {
+        UE_LOG(LogBenchmark, Warning, TEXT("tg.BenchPatrolPaths needs a navmesh"));
+        return;
+    }
+
+    const int32 NumGuards = FBenchmarkArgs(Args).GetInt(0, 200);
+
+    // The routes of the level, shared out between the guards
+    TArray<UPatrolRoute*> Routes;
+    for (TObjectIterator<UPatrolRoute> It; It; ++It)
+    {
+        if (It->GetWorld() == World && It->GetNumPatrolPoints() > 1) Routes.Add(*It);
+    }
+    if (Routes.Num() == 0)
+    {
+        UE_LOG(LogBenchmark, Warning, TEXT("tg.BenchPatrolPaths needs a guard with patrol points"));
+        return;
+    }
+
+    // Legs come in asynchronously, a cold cache needs a second run
+    for (UPatrolRoute* Route : Routes) Cache->PrecomputeRoute(Route, NavData->GetConfig());
+
+    int32 NumLegs = 0;
+    double UncachedSeconds = 0.0;
+    double CachedSeconds = 0.0;
+    int32 NumHits = 0;
+    for (int32 Guard = 0; Guard < NumGuards; Guard++)
+    {
+        const UPatrolRoute* Route = Routes[Guard % Routes.Num()];
+        const TArray<FVector>& Locations = Route->GetPatrolLocations();
+        for (int32 FromIndex = 0; FromIndex < Locations.Num(); FromIndex++)
+        {
+            const int32 ToIndex = (FromIndex + 1) % Locations.Num();
+            NumLegs++;
+
+            {
+                FScopedBenchmarkTimer Timer(UncachedSeconds);
+                FPathFindingQuery Query(Cache, *NavData, Locations[FromIndex], Locations[ToIndex]);
+                NavSys->FindPathSync(Query);
+            }
+
+            FNavPathSharedPtr Path;
+            {
+                FScopedBenchmarkTimer Timer(CachedSeconds);
+                Path = Cache->FindLegPath(Route, FromIndex, ToIndex, Locations[FromIndex]);
+            }
+            if (Path.IsValid()) NumHits++;
+        }
+    }
+
+    UE_LOG(LogBenchmark, Log, TEXT("%d guards on %d routes, %d legs: pathfinding %.3f ms, cache %.3f ms (%d hits), saved %.3f ms"),
+           NumGuards, Routes.Num(), NumLegs, UncachedSeconds * 1000.0, CachedSeconds * 1000.0, NumHits,
+           (UncachedSeconds - CachedSeconds) * 1000.0);
+    if (NumHits < NumLegs)
+    {
+        UE_LOG(LogBenchmark, Warning, TEXT("%d legs weren't cached yet, run tg.BenchPatrolPaths again"), NumLegs - NumHits);
+    }
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchmarkPatrolPathsCommand(
+    TEXT("tg.BenchPatrolPaths"),
+    TEXT("Compares pathfinding every patrol leg per guard against the patrol path cache. Usage: tg.BenchPatrolPaths [NumGuards]"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchmarkPatrolPaths));
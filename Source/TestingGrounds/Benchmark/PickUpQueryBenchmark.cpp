@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "BenchmarkUtils.h"
+#include "EngineUtils.h"
+#include "../Inventory/PickUpRegistry.h"
+#include "../Inventory/PickUp.h"
+
+// Spawns 100, 1k and 10k pickups around the player and times the registry against a physics trace
+static void BenchmarkPickUpQueries(const TArray<FString>& Args, UWorld* World)
+{
+    ACharacter* Player = UGameplayStatics::GetPlayerCharacter(World, 0);
+    APickUpRegistry* Registry = APickUpRegistry::Get(World);
+    if (Player == nullptr || Registry == nullptr)
+    {
+        UE_LOG(LogBenchmark, Warning, TEXT("tg.BenchPickUpQuery needs a player character"));
+        return;
+    }
+
+    const int32 NumQueries = FBenchmarkArgs(Args).GetInt(0, 1000);
+    const float Range = 250.f;
+    const float ConeHalfAngle = 10.f;
+    const float SpawnRadius = 3000.f;
+
+    // Spawn copies of a pickup placed in the level so they have a mesh the trace can hit
+    UClass* PickUpClass = APickUp::StaticClass();
+    for (TActorIterator<APickUp> It(World); It; ++It)
+    {
+        PickUpClass = It->GetClass();
+        break;
+    }
+
+    FCollisionQueryParams QueryParams(FName("PickUpBenchmark"), false, Player);
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+    const int32 PickUpCounts[] = { 100, 1000, 10000 };
+    for (int32 NumPickUps : PickUpCounts)
+    {
+        FRandomStream Random(NumPickUps);
+        const FVector Origin = Player->GetActorLocation();
+
+        TArray<AActor*> SpawnedPickUps;
+        for (int32 i = 0; i < NumPickUps; i++)
+        {
+            const FVector Offset = FVector(Random.FRandRange(-1.f, 1.f), Random.FRandRange(-1.f, 1.f), 0.f) * SpawnRadius;
+            SpawnedPickUps.Add(World->SpawnActor<APickUp>(PickUpClass, Origin + Offset, FRotator::ZeroRotator, SpawnParams));
+        }
+
+        // Both approaches answer the same random views
+        TArray<FVector> ViewDirections;
+        for (int32 i = 0; i < NumQueries; i++)
+        {
+            ViewDirections.Add(FRotator(Random.FRandRange(-20.f, 20.f), Random.FRandRange(0.f, 360.f), 0.f).Vector());
+        }
+        const FVector ViewLocation = Origin + FVector(0.f, 0.f, 64.f);
+
+        FBenchmarkTimer Timer;
+        int32 TraceFound = 0;
+        for (const FVector& ViewDirection : ViewDirections)
+        {
+            FHitResult Hit;
+            World->LineTraceSingleByChannel(Hit, ViewLocation, ViewLocation + ViewDirection * Range, ECC_WorldDynamic, QueryParams);
+            if (Cast<APickUp>(Hit.GetActor())) TraceFound++;
+        }
+        const double TraceSeconds = Timer.GetSeconds();
+
+        Timer.Restart();
+        int32 RegistryFound = 0;
+        for (const FVector& ViewDirection : ViewDirections)
+        {
+            if (Registry->FindClosestInViewCone(ViewLocation, ViewDirection, Range, ConeHalfAngle, QueryParams)) RegistryFound++;
+        }
+        const double RegistrySeconds = Timer.GetSeconds();
+
+        UE_LOG(LogBenchmark, Log, TEXT("%6d pickups, %d queries: trace %.4f ms/query (%d found), registry %.4f ms/query (%d found)"),
+               NumPickUps, NumQueries,
+               TraceSeconds * 1000.0 / NumQueries, TraceFound,
+               RegistrySeconds * 1000.0 / NumQueries, RegistryFound);
+
+        for (AActor* PickUp : SpawnedPickUps)
+        {
+            if (PickUp) PickUp->Destroy();
+        }
+    }
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchPickUpQueryCommand(
+    TEXT("tg.BenchPickUpQuery"),
+    TEXT("Times the pickup registry against a physics trace with 100, 1k and 10k pickups. Usage: tg.BenchPickUpQuery [NumQueries]"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchmarkPickUpQueries));
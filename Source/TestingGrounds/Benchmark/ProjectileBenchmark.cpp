@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "BenchmarkUtils.h"
+#include "../Weapons/ProjectileSimulation.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+
+// Flies the same projectiles through the simulation, serial and parallel, and through a movement component each
+static void BenchmarkProjectiles(const TArray<FString>& Args, UWorld* World)
+{
+    AProjectileSimulation* Simulation = AProjectileSimulation::Get(World);
+    ACharacter* Player = UGameplayStatics::GetPlayerCharacter(World, 0);
+    if (Simulation == nullptr || Player == nullptr)
+    {
+        UE_LOG(LogBenchmark, Warning, TEXT("tg.BenchProjectiles needs a player character"));
+        return;
+    }
+
+    const FBenchmarkArgs BenchmarkArgs(Args);
+    const int32 NumProjectiles = BenchmarkArgs.GetInt(0, 10000);
+    const int32 NumFrames = BenchmarkArgs.GetInt(1, 60);
+    const float DeltaSeconds = 1.f / 60.f;
+    const float Speed = 3000.f;
+
+    FProjectileSimParams SimParams;
+    SimParams.MaxSpeed = Speed;
+    SimParams.bShouldBounce = true;
+    SimParams.LifeSpan = NumFrames * DeltaSeconds * 2.f;
+    SimParams.Channel = ECC_WorldDynamic;
+
+    // Launched upwards in every direction from above the player
+    const FVector Origin = Player->GetActorLocation() + FVector(0.f, 0.f, 200.f);
+    FRandomStream Random(NumProjectiles);
+    TArray<FVector> Velocities;
+    for (int32 i = 0; i < NumProjectiles; i++)
+    {
+        FVector Direction = Random.GetUnitVector();
+        Direction.Z = FMath::Abs(Direction.Z);
+        Velocities.Add(Direction * Speed);
+    }
+
+    // Simulation, serial then parallel
+    {
+        FScopedBenchmarkCVar ParallelCVar(TEXT("tg.ProjectileSim.Parallel"), 0);
+        for (int32 Parallel = 0; Parallel <= 2; Parallel++)
+        {
+            ParallelCVar.Set(Parallel);
+
+            TArray<int32> Handles;
+            for (const FVector& Velocity : Velocities) Handles.Add(Simulation->AddProjectile(Origin, Velocity, SimParams));
+
+            const FBenchmarkTimer Timer;
+            for (int32 Frame = 0; Frame < NumFrames; Frame++) Simulation->Simulate(DeltaSeconds);
+            const double SimulationMs = Timer.GetMs();
+
+            for (int32 Handle : Handles) Simulation->RemoveProjectile(Handle);
+
+            UE_LOG(LogBenchmark, Log, TEXT("%d projectiles, simulation (parallel %d): %.3f ms/frame"),
+                   NumProjectiles, Parallel, SimulationMs / NumFrames);
+        }
+    }
+
+    // One actor and movement component each, ticked by hand so only their movement is timed
+    TArray<UProjectileMovementComponent*> Components;
+    TArray<AActor*> Actors;
+    for (const FVector& Velocity : Velocities)
+    {
+        AActor* Actor = World->SpawnActor<AActor>(AActor::StaticClass(), Origin, FRotator::ZeroRotator);
+        if (Actor == nullptr) continue;
+
+        USphereComponent* Sphere = NewObject<USphereComponent>(Actor);
+        Sphere->InitSphereRadius(SimParams.Radius);
+        Sphere->SetCollisionProfileName(FName("Projectile"));
+        Actor->SetRootComponent(Sphere);
+        Sphere->RegisterComponent();
+
+        UProjectileMovementComponent* Movement = NewObject<UProjectileMovementComponent>(Actor);
+        Movement->bShouldBounce = true;
+        Movement->MaxSpeed = Speed;
+        Movement->SetUpdatedComponent(Sphere);
+        Movement->RegisterComponent();
+        Movement->SetComponentTickEnabled(false);
+        Movement->Velocity = Velocity;
+
+        Components.Add(Movement);
+        Actors.Add(Actor);
+    }
+
+    const FBenchmarkTimer ComponentTimer;
+    for (int32 Frame = 0; Frame < NumFrames; Frame++)
+    {
+        for (UProjectileMovementComponent* Movement : Components)
+        {
+            Movement->TickComponent(DeltaSeconds, LEVELTICK_All, &Movement->PrimaryComponentTick);
+        }
+    }
+    const double ComponentMs = ComponentTimer.GetMs();
+
+    for (AActor* Actor : Actors) Actor->Destroy();
+
+    UE_LOG(LogBenchmark, Log, TEXT("%d projectiles, movement components: %.3f ms/frame"),
+           Actors.Num(), ComponentMs / NumFrames);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchProjectilesCommand(
+    TEXT("tg.BenchProjectiles"),
+    TEXT("Times the projectile simulation against one movement component per projectile. Usage: tg.BenchProjectiles [NumProjectiles] [NumFrames]"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchmarkProjectiles));
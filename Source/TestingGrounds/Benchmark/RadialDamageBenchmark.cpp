@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "BenchmarkUtils.h"
+#include "../Weapons/RadialDamageResolver.h"
+
+// Sets off 1, 10 and 100 simultaneous explosions around the player, resolved one by one and batched
+static void BenchmarkRadialDamage(const TArray<FString>& Args, UWorld* World)
+{
+    ACharacter* Player = UGameplayStatics::GetPlayerCharacter(World, 0);
+    ARadialDamageResolver* Resolver = ARadialDamageResolver::Get(World);
+    if (Player == nullptr || Resolver == nullptr)
+    {
+        UE_LOG(LogBenchmark, Warning, TEXT("tg.BenchRadialDamage needs a player character"));
+        return;
+    }
+
+    const int32 NumFrames = FBenchmarkArgs(Args).GetInt(0, 100);
+    const float Radius = 200.f;
+    const float SpreadRadius = 600.f;
+
+    // No damage, so the benchmark doesn't hurt anyone - the queries and dispatch still run
+    const float Damage = 0.f;
+    TSubclassOf<UDamageType> DamageType;
+    TArray<AActor*> IgnoreActors;
+
+    const int32 ExplosionCounts[] = { 1, 10, 100 };
+    for (int32 NumExplosions : ExplosionCounts)
+    {
+        FRandomStream Random(NumExplosions);
+        TArray<FVector> Origins;
+        for (int32 i = 0; i < NumExplosions; i++)
+        {
+            Origins.Add(Player->GetActorLocation() + FVector(Random.FRandRange(-1.f, 1.f), Random.FRandRange(-1.f, 1.f), 0.f) * SpreadRadius);
+        }
+
+        FBenchmarkTimer Timer;
+        for (int32 Frame = 0; Frame < NumFrames; Frame++)
+        {
+            for (const FVector& Origin : Origins)
+            {
+                UGameplayStatics::ApplyRadialDamage(World, Damage, Origin, Radius, DamageType, IgnoreActors, nullptr, nullptr);
+            }
+        }
+        const double SeparateSeconds = Timer.GetSeconds();
+
+        Timer.Restart();
+        for (int32 Frame = 0; Frame < NumFrames; Frame++)
+        {
+            for (const FVector& Origin : Origins)
+            {
+                Resolver->QueueExplosion(Origin, Radius, Damage, DamageType, nullptr, nullptr);
+            }
+            Resolver->ResolveExplosions();
+        }
+        const double BatchedSeconds = Timer.GetSeconds();
+
+        UE_LOG(LogBenchmark, Log, TEXT("%3d explosions: ApplyRadialDamage %.4f ms/frame, resolver %.4f ms/frame"),
+               NumExplosions,
+               SeparateSeconds * 1000.0 / NumFrames,
+               BatchedSeconds * 1000.0 / NumFrames);
+    }
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchRadialDamageCommand(
+    TEXT("tg.BenchRadialDamage"),
+    TEXT("Times 1, 10 and 100 explosions in one frame, one ApplyRadialDamage each against the batched resolver. Usage: tg.BenchRadialDamage [NumFrames]"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchmarkRadialDamage));
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "BenchmarkUtils.h"
+#include "../Magic/SkillsComponent.h"
+#include "../Magic/Skill.h"
+
+// Logs the memory of the local player's skill state and times its lookups against the old class-default scan
+static void LogSkillStateCost(UWorld* World)
+{
+    APawn* Pawn = UGameplayStatics::GetPlayerPawn(World, 0);
+    USkillsComponent* SkillsComponent = Pawn ? Pawn->FindComponentByClass<USkillsComponent>() : nullptr;
+    if (SkillsComponent == nullptr)
+    {
+        UE_LOG(LogBenchmark, Warning, TEXT("tg.SkillStateCost needs a player pawn with a skills component"));
+        return;
+    }
+    
+    UE_LOG(LogBenchmark, Log, TEXT("Skill state: %d bytes per player (%d skills, %d bytes per skill)"),
+           (int32)(sizeof(FSkillStateArray) + SkillsComponent->SkillsArray.Num() * sizeof(FSkillState)),
+           SkillsComponent->SkillsArray.Num(),
+           (int32)sizeof(FSkillState));
+    
+    const int32 NumLookups = 100000;
+    int32 LevelSum = 0;
+    
+    FBenchmarkTimer Timer;
+    for (int32 i = 0; i < NumLookups; i++)
+    {
+        LevelSum += SkillsComponent->GetSkillLevelByType((ESkillType)(i % (int32)ESkillType::MAX));
+    }
+    const double TableSeconds = Timer.GetSeconds();
+    
+    Timer.Restart();
+    for (int32 i = 0; i < NumLookups; i++)
+    {
+        const ESkillType SkillType = (ESkillType)(i % (int32)ESkillType::MAX);
+        for (const auto& Skill : SkillsComponent->SkillsArray)
+        {
+            ASkill* SkillDefaults = Skill.Get() ? Skill.Get()->GetDefaultObject<ASkill>() : nullptr;
+            if (SkillDefaults && SkillDefaults->GetSkillType() == SkillType) { LevelSum += SkillDefaults->GetMaxLevel(); break; }
+        }
+    }
+    const double ScanSeconds = Timer.GetSeconds();
+    
+    UE_LOG(LogBenchmark, Log, TEXT("%d lookups: state table %.1f ns each, class default scan %.1f ns each (checksum %d)"),
+           NumLookups,
+           TableSeconds * 1e9 / NumLookups,
+           ScanSeconds * 1e9 / NumLookups,
+           LevelSum);
+}
+
+static FAutoConsoleCommandWithWorld SkillStateCostCommand(
+    TEXT("tg.SkillStateCost"),
+    TEXT("Logs the per-player memory of the skill state table and the cost of its lookups"),
+    FConsoleCommandWithWorldDelegate::CreateStatic(&LogSkillStateCost));
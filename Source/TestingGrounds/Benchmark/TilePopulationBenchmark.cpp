@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "BenchmarkUtils.h"
+#include "../Terrain/TerrainTile.h"
+#include "../Terrain/PoissonDiskSampler.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Engine/StaticMeshActor.h"
+
+// Populates a tile sized area with the given number of props: sampling, instancing, and one actor each for comparison
+static void BenchmarkTilePopulation(const TArray<FString>& Args, UWorld* World)
+{
+    UStaticMesh* Mesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+    if (World == nullptr || Mesh == nullptr)
+    {
+        UE_LOG(LogBenchmark, Warning, TEXT("tg.BenchTilePopulation needs a world and the engine's basic shapes"));
+        return;
+    }
+
+    TArray<int32> Counts;
+    if (Args.Num() > 0) Counts.Add(FBenchmarkArgs(Args).GetInt(0, 1000));
+    else Counts = { 1000, 10000 };
+
+    const FBox Area(FVector(0.f, -2000.f, 0.f), FVector(4000.f, 2000.f, 0.f));
+    for (int32 Count : Counts)
+    {
+        TArray<FTileMeshSpawn> MeshProps;
+        MeshProps.AddDefaulted();
+        MeshProps[0].Mesh = Mesh;
+        MeshProps[0].MinCount = Count;
+        MeshProps[0].MaxCount = Count;
+        MeshProps[0].Radius = FPoissonDiskSampler::GetRadiusForCount(FBox2D(FVector2D(Area.Min), FVector2D(Area.Max)), Count);
+
+        FBenchmarkTimer Timer;
+        const FTileLayout Layout = ATerrainTile::ComputeLayout(Count, Area, TArray<FTilePropSpawn>(), MeshProps);
+        const double SamplingMs = Timer.GetMs();
+        const TArray<FTransform>& Transforms = Layout.MeshTransforms[0];
+
+        // Instanced, as the tiles do it
+        AActor* Host = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity);
+        if (Host == nullptr) return;
+        UHierarchicalInstancedStaticMeshComponent* Instances = NewObject<UHierarchicalInstancedStaticMeshComponent>(Host);
+        Instances->SetMobility(EComponentMobility::Movable);
+        Host->SetRootComponent(Instances);
+        Instances->RegisterComponent();
+        Instances->SetStaticMesh(Mesh);
+
+        Timer.Restart();
+        for (const FTransform& Transform : Transforms) Instances->AddInstance(Transform);
+        const double InstancingMs = Timer.GetMs();
+        Host->Destroy();
+
+        // One actor per prop, as the Tile blueprint does it
+        Timer.Restart();
+        TArray<AActor*> Actors;
+        for (const FTransform& Transform : Transforms)
+        {
+            AStaticMeshActor* Actor = World->SpawnActor<AStaticMeshActor>(AStaticMeshActor::StaticClass(), Transform);
+            if (Actor == nullptr) continue;
+            Actor->GetStaticMeshComponent()->SetMobility(EComponentMobility::Movable);
+            Actor->GetStaticMeshComponent()->SetStaticMesh(Mesh);
+            Actors.Add(Actor);
+        }
+        const double ActorMs = Timer.GetMs();
+        for (AActor* Actor : Actors) Actor->Destroy();
+
+        UE_LOG(LogBenchmark, Log, TEXT("%d props asked, %d placed: sampling %.3f ms, instancing %.3f ms, one actor each %.3f ms"),
+               Count, Transforms.Num(), SamplingMs, InstancingMs, ActorMs);
+    }
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchmarkTilePopulationCommand(
+    TEXT("tg.BenchTilePopulation"),
+    TEXT("Times populating a tile with props, instanced against one actor each. Usage: tg.BenchTilePopulation [NumProps], 1000 and 10000 by default"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchmarkTilePopulation));
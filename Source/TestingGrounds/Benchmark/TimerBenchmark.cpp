@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "BenchmarkUtils.h"
+#include "../GameplayTimerService.h"
+
+// Schedules the timers on a timing wheel and on a timer manager, cancels half of them, then lets the wheel run the rest
+static void BenchTimers(const TArray<FString>& Args)
+{
+    const int32 NumTimers = FBenchmarkArgs(Args).GetInt(0, 50000);
+    const float FrameSeconds = 1.f / 60.f;
+    const float MaxDelay = 10.f;
+
+    FRandomStream Random(NumTimers);
+    TArray<float> Delays;
+    Delays.Reserve(NumTimers);
+    for (int32 i = 0; i < NumTimers; i++) Delays.Add(Random.FRandRange(0.1f, MaxDelay));
+
+    int32 NumRun = 0;
+
+    // Timing wheel
+    FTimingWheel Wheel;
+    TArray<FGameplayTimerHandle> WheelHandles;
+    WheelHandles.Reserve(NumTimers);
+
+    FBenchmarkTimer Timer;
+    for (float Delay : Delays)
+    {
+        WheelHandles.Add(Wheel.Add(Delay, nullptr, [&NumRun]() { NumRun++; }));
+    }
+    const double WheelAddMs = Timer.GetMs();
+
+    Timer.Restart();
+    for (int32 i = 0; i < NumTimers; i += 2) Wheel.Remove(WheelHandles[i]);
+    const double WheelRemoveMs = Timer.GetMs();
+
+    // A second past the longest delay, the worst frame shows what a batch of expiries costs
+    double WheelAdvanceMs = 0.0;
+    double WheelWorstFrameMs = 0.0;
+    const int32 NumFrames = FMath::CeilToInt((MaxDelay + 1.f) / FrameSeconds);
+    for (int32 Frame = 0; Frame < NumFrames; Frame++)
+    {
+        Timer.Restart();
+        Wheel.Advance(FrameSeconds);
+        const double FrameMs = Timer.GetMs();
+        WheelAdvanceMs += FrameMs;
+        WheelWorstFrameMs = FMath::Max(WheelWorstFrameMs, FrameMs);
+    }
+
+    // Timer manager. Its tick only runs once per engine frame, so only scheduling and clearing get compared
+    FTimerManager TimerManager;
+    TArray<FTimerHandle> ManagerHandles;
+    ManagerHandles.AddDefaulted(NumTimers);
+
+    Timer.Restart();
+    for (int32 i = 0; i < NumTimers; i++)
+    {
+        TimerManager.SetTimer(ManagerHandles[i], FTimerDelegate::CreateLambda([&NumRun]() { NumRun++; }), Delays[i], false);
+    }
+    const double ManagerAddMs = Timer.GetMs();
+
+    Timer.Restart();
+    for (int32 i = 0; i < NumTimers; i += 2) TimerManager.ClearTimer(ManagerHandles[i]);
+    const double ManagerRemoveMs = Timer.GetMs();
+
+    UE_LOG(LogBenchmark, Log, TEXT("%d timers, half of them cancelled:"), NumTimers);
+    UE_LOG(LogBenchmark, Log, TEXT("  Timing wheel:  add %.2f ms, cancel %.2f ms, %d frames of expiry %.2f ms (worst frame %.3f ms), %d run, %d left"),
+           WheelAddMs, WheelRemoveMs, NumFrames, WheelAdvanceMs, WheelWorstFrameMs, NumRun, Wheel.GetNumPending());
+    UE_LOG(LogBenchmark, Log, TEXT("  Timer manager: add %.2f ms, cancel %.2f ms"),
+           ManagerAddMs, ManagerRemoveMs);
+}
+
+static FAutoConsoleCommand BenchTimersCommand(
+    TEXT("tg.BenchTimers"),
+    TEXT("Compares the gameplay timing wheel with the timer manager on many pending timers. Usage: tg.BenchTimers [NumTimers=50000]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&BenchTimers));
@@ -0,0 +1,219 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "GameplayTimerService.h"
+#include "WorldManager.h"
+#include "TestingGroundsStats.h"
+
+
+FTimingWheel::FTimingWheel(float InTickSeconds)
+    : TickSeconds(FMath::Max(InTickSeconds, KINDA_SMALL_NUMBER))
+{
+    for (int32& SlotHead : SlotHeads) SlotHead = INDEX_NONE;
+}
+
+FGameplayTimerHandle FTimingWheel::Add(float Delay, UObject* Owner, TFunction<void()>&& Callback)
+{
+    int32 NodeIndex = FreeHead;
+    if (NodeIndex != INDEX_NONE)
+    {
+        FreeHead = Nodes[NodeIndex].Next;
+    }
+    else
+    {
+        NodeIndex = Nodes.AddDefaulted();
+    }
+
+    // The earliest tick at which Delay has passed, measured from now rather than from the current tick
+    static const uint64 MaxTicks = (1ull << (BitsPerLevel * NumLevels)) - 1;
+    const float Ticks = FMath::CeilToFloat((Accumulator + FMath::Max(Delay, 0.f)) / TickSeconds);
+    const uint64 DelayTicks = FMath::Clamp<uint64>((uint64)FMath::Min(Ticks, (float)MaxTicks), 1, MaxTicks);
+
+    FTimerNode& Node = Nodes[NodeIndex];
+    Node.Callback = MoveTemp(Callback);
+    Node.Owner = Owner;
+    Node.bHasOwner = (Owner != nullptr);
+    Node.ExpireTick = CurrentTick + DelayTicks;
+    Node.Serial = NextSerial++;
+    if (NextSerial == 0) NextSerial = 1;
+
+    Link(NodeIndex);
+    NumPending++;
+
+    FGameplayTimerHandle Handle;
+    Handle.Index = NodeIndex;
+    Handle.Serial = Node.Serial;
+    return Handle;
+}
+
+bool FTimingWheel::Remove(FGameplayTimerHandle& Handle)
+{
+    const bool bPending = IsPending(Handle);
+    if (bPending)
+    {
+        // Expired timers stay in the batch, the serial check skips them
+        if (Nodes[Handle.Index].Slot >= 0) Unlink(Handle.Index);
+        FreeNode(Handle.Index);
+    }
+    Handle.Invalidate();
+    return bPending;
+}
+
+bool FTimingWheel::IsPending(const FGameplayTimerHandle& Handle) const
+{
+    return Nodes.IsValidIndex(Handle.Index) && Handle.Serial != 0 && Nodes[Handle.Index].Serial == Handle.Serial;
+}
+
+int32 FTimingWheel::Advance(float DeltaSeconds)
+{
+    Accumulator += FMath::Max(DeltaSeconds, 0.f);
+    while (Accumulator >= TickSeconds)
+    {
+        Accumulator -= TickSeconds;
+        Step();
+    }
+
+    // New timers are at least a tick away, so callbacks never add to the batch they run in
+    int32 NumRun = 0;
+    for (const FGameplayTimerHandle& Handle : Expired)
+    {
+        FTimerNode& Node = Nodes[Handle.Index];
+        if (Node.Serial != Handle.Serial) continue;
+
+        // The node is free before the callback runs, which may add timers that reuse it
+        TFunction<void()> Callback = MoveTemp(Node.Callback);
+        const bool bOwnerAlive = !Node.bHasOwner || Node.Owner.IsValid();
+        FreeNode(Handle.Index);
+
+        if (bOwnerAlive && Callback)
+        {
+            Callback();
+            NumRun++;
+        }
+    }
+    Expired.Reset();
+
+    return NumRun;
+}
+
+void FTimingWheel::Link(int32 NodeIndex)
+{
+    FTimerNode& Node = Nodes[NodeIndex];
+
+    // The level is picked by how far away the timer is, the slot by its expire tick
+    const uint64 Delta = (Node.ExpireTick > CurrentTick) ? Node.ExpireTick - CurrentTick : 0;
+    int32 Level = 0;
+    while (Level < NumLevels - 1 && Delta >= (1ull << (BitsPerLevel * (Level + 1))))
+    {
+        Level++;
+    }
+    const int32 Slot = Level * SlotsPerLevel + (int32)((Node.ExpireTick >> (BitsPerLevel * Level)) & (SlotsPerLevel - 1));
+
+    Node.Slot = Slot;
+    Node.Prev = INDEX_NONE;
+    Node.Next = SlotHeads[Slot];
+    if (Node.Next != INDEX_NONE) Nodes[Node.Next].Prev = NodeIndex;
+    SlotHeads[Slot] = NodeIndex;
+}
+
+void FTimingWheel::Unlink(int32 NodeIndex)
+{
+    FTimerNode& Node = Nodes[NodeIndex];
+    if (Node.Prev != INDEX_NONE)
+    {
+        Nodes[Node.Prev].Next = Node.Next;
+    }
+    else
+    {
+        SlotHeads[Node.Slot] = Node.Next;
+    }
+    if (Node.Next != INDEX_NONE) Nodes[Node.Next].Prev = Node.Prev;
+
+    Node.Prev = INDEX_NONE;
+    Node.Next = INDEX_NONE;
+    Node.Slot = INDEX_NONE;
+}
+
+void FTimingWheel::FreeNode(int32 NodeIndex)
+{
+    FTimerNode& Node = Nodes[NodeIndex];
+    Node.Callback = nullptr;
+    Node.Owner = nullptr;
+    Node.bHasOwner = false;
+    Node.Serial = 0;
+    Node.Slot = INDEX_NONE;
+    Node.Prev = INDEX_NONE;
+    Node.Next = FreeHead;
+    FreeHead = NodeIndex;
+
+    NumPending--;
+}
+
+void FTimingWheel::Step()
+{
+    CurrentTick++;
+
+    // Every level whose lower bits wrapped hands its current slot down
+    for (int32 Level = 1; Level < NumLevels; Level++)
+    {
+        if ((CurrentTick & ((1ull << (BitsPerLevel * Level)) - 1)) != 0) break;
+
+        const int32 Slot = Level * SlotsPerLevel + (int32)((CurrentTick >> (BitsPerLevel * Level)) & (SlotsPerLevel - 1));
+        int32 NodeIndex = SlotHeads[Slot];
+        SlotHeads[Slot] = INDEX_NONE;
+        while (NodeIndex != INDEX_NONE)
+        {
+            const int32 NextIndex = Nodes[NodeIndex].Next;
+            Link(NodeIndex);
+            NodeIndex = NextIndex;
+        }
+    }
+
+    // Everything in the current slot of the first level expires now
+    const int32 Slot = (int32)(CurrentTick & (SlotsPerLevel - 1));
+    while (SlotHeads[Slot] != INDEX_NONE)
+    {
+        const int32 NodeIndex = SlotHeads[Slot];
+        Unlink(NodeIndex);
+        Nodes[NodeIndex].Slot = ExpiredSlot;
+
+        FGameplayTimerHandle Handle;
+        Handle.Index = NodeIndex;
+        Handle.Serial = Nodes[NodeIndex].Serial;
+        Expired.Add(Handle);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// Sets default values
+AGameplayTimerService::AGameplayTimerService()
+{
+    // Advances the wheel once per frame
+	PrimaryActorTick.bCanEverTick = true;
+}
+
+void AGameplayTimerService::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    TG_SCOPE_CYCLE_COUNTER(AdvanceTimers);
+    const int32 NumRun = Wheel.Advance(DeltaSeconds);
+    TG_INC_COUNTER_BY(TimersRun, NumRun);
+    TG_SET_DWORD(PendingTimers, Wheel.GetNumPending());
+}
+
+AGameplayTimerService* AGameplayTimerService::Get(UWorld* World)
+{
+    return GetWorldManager<AGameplayTimerService>(World);
+}
+
+FGameplayTimerHandle AGameplayTimerService::SetTimer(UObject* Owner, float Delay, TFunction<void()> Callback)
+{
+    return Wheel.Add(Delay, Owner, MoveTemp(Callback));
+}
+
+void AGameplayTimerService::ClearTimer(FGameplayTimerHandle& Handle)
+{
+    Wheel.Remove(Handle);
+}
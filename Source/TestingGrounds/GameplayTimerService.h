@@ -0,0 +1,143 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "GameplayTimerService.generated.h"
+
+// A timer of a FTimingWheel. Safe to clear after the timer ran or got cleared already
+struct FGameplayTimerHandle
+{
+    int32 Index = INDEX_NONE;
+    uint32 Serial = 0;
+
+    bool IsValid() const { return Index != INDEX_NONE; }
+    void Invalidate() { Index = INDEX_NONE; Serial = 0; }
+};
+
+/**
+ * Hierarchical timing wheel. Every level has SlotsPerLevel slots, each SlotsPerLevel times longer than a slot of the level below,
+ * and timers move down a level whenever the level below wraps around.
+ * Adding and removing a timer is O(1), advancing costs a slot per tick and a cascade every SlotsPerLevel ticks.
+ * The timers are nodes of a single array, linked into their slot by index, so nothing gets allocated once it has grown.
+ * Game thread only.
+ */
+class TESTINGGROUNDS_API FTimingWheel
+{
+public:
+    FTimingWheel(float InTickSeconds = 1.f / 60.f);
+
+    /**
+     * Runs Callback once Delay seconds have passed. A timer with an Owner doesn't run if the Owner is gone by then.
+     * Delays past the range of the wheel (about 77 hours at 60 ticks a second) get clamped.
+     */
+    FGameplayTimerHandle Add(float Delay, UObject* Owner, TFunction<void()>&& Callback);
+
+    // Cancels the timer unless it already ran, and invalidates the handle. Returns whether it was pending
+    bool Remove(FGameplayTimerHandle& Handle);
+
+    bool IsPending(const FGameplayTimerHandle& Handle) const;
+
+    // Advances the wheel and runs every timer that expired on the way, in one batch, earliest first. Returns the number that ran
+    int32 Advance(float DeltaSeconds);
+
+    int32 GetNumPending() const { return NumPending; }
+
+private:
+    static const int32 BitsPerLevel = 6;
+    static const int32 SlotsPerLevel = 1 << BitsPerLevel;
+    static const int32 NumLevels = 4;
+
+    // The slot of a timer that expired and waits for its callback
+    static const int32 ExpiredSlot = -2;
+
+    struct FTimerNode
+    {
+        TFunction<void()> Callback;
+        TWeakObjectPtr<UObject> Owner;
+        uint64 ExpireTick = 0;
+
+        // The neighbours in the slot, or the next free node
+        int32 Prev = INDEX_NONE;
+        int32 Next = INDEX_NONE;
+
+        // Index into SlotHeads, INDEX_NONE while free
+        int32 Slot = INDEX_NONE;
+
+        // Changes every time the node gets reused, 0 while free
+        uint32 Serial = 0;
+
+        bool bHasOwner = false;
+    };
+
+    // Links the node into the slot of its expire tick
+    void Link(int32 NodeIndex);
+
+    void Unlink(int32 NodeIndex);
+
+    void FreeNode(int32 NodeIndex);
+
+    // Moves the wheel by one tick, cascading the levels that wrapped and collecting the expired timers
+    void Step();
+
+    TArray<FTimerNode> Nodes;
+
+    // The first node of every slot, level after level
+    int32 SlotHeads[NumLevels * SlotsPerLevel];
+
+    int32 FreeHead = INDEX_NONE;
+
+    // The timers that expired during this advance
+    TArray<FGameplayTimerHandle> Expired;
+
+    uint64 CurrentTick = 0;
+    float TickSeconds;
+
+    // Time passed since the current tick
+    float Accumulator = 0.f;
+
+    int32 NumPending = 0;
+    uint32 NextSerial = 1;
+};
+
+/**
+ * Per-world service for the short one-shot timers of combat actors: bomb fuses, projectile lifespans and cleanup delays.
+ * Replaces a FTimerManager timer per actor with a node of a FTimingWheel, whose expired timers run in one batch per frame.
+ * Use "stat TestingGrounds" or tg.Stats.Capture for the cost, and tg.BenchTimers to compare it with the timer manager.
+ */
+UCLASS()
+class TESTINGGROUNDS_API AGameplayTimerService : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AGameplayTimerService();
+
+    // Runs the timers that expired since the last frame
+    virtual void Tick(float DeltaSeconds) override;
+
+    // Returns the timer service of the given world, spawning it if needed
+    static AGameplayTimerService* Get(UWorld* World);
+
+    // Calls Object's member function after Delay seconds, unless Object is gone by then
+    template<class T>
+    FGameplayTimerHandle SetTimer(T* Object, void (T::*Callback)(), float Delay)
+    {
+        return SetTimer(Object, Delay, [Object, Callback]() { (Object->*Callback)(); });
+    }
+
+    // Runs Callback after Delay seconds, unless Owner is gone by then
+    FGameplayTimerHandle SetTimer(UObject* Owner, float Delay, TFunction<void()> Callback);
+
+    // Cancels the timer if it's still pending and invalidates the handle
+    void ClearTimer(FGameplayTimerHandle& Handle);
+
+    bool IsTimerPending(const FGameplayTimerHandle& Handle) const { return Wheel.IsPending(Handle); }
+
+    UFUNCTION(BlueprintCallable, Category = "GameplayTimers")
+    int32 GetNumPending() const { return Wheel.GetNumPending(); }
+
+private:
+    FTimingWheel Wheel;
+};
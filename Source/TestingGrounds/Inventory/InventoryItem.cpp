@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "InventoryItem.h"
+
+// Use "stat Inventory" on the server to see what the inventory replication costs
+DECLARE_STATS_GROUP(TEXT("Inventory"), STATGROUP_Inventory, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Inventory Bytes Sent"), STAT_InventoryBytesSent, STATGROUP_Inventory);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Inventory Slot Changes Sent"), STAT_InventoryChangesSent, STATGROUP_Inventory);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Inventory Bytes Per Change"), STAT_InventoryBytesPerChange, STATGROUP_Inventory);
+
+UTexture2D* FInventoryItem::LoadIcon() const
+{
+    if (Icon.IsNull()) return nullptr;
+
+    UTexture2D* LoadedIcon = Icon.Get();
+    return LoadedIcon ? LoadedIcon : Cast<UTexture2D>(Icon.ToStringReference().TryLoad());
+}
+
+void FInventoryItem::PostReplicatedAdd(const FInventorySlots& InArraySerializer)
+{
+    InArraySerializer.InvalidateIndex();
+    InArraySerializer.OnSlotChanged.Broadcast(Slot);
+}
+
+void FInventoryItem::PostReplicatedChange(const FInventorySlots& InArraySerializer)
+{
+    InArraySerializer.OnSlotChanged.Broadcast(Slot);
+}
+
+void FInventoryItem::PreReplicatedRemove(const FInventorySlots& InArraySerializer)
+{
+    InArraySerializer.InvalidateIndex();
+}
+
+void FInventorySlots::Init(int32 Capacity)
+{
+    Capacity = FMath::Max(Capacity, 0);
+
+    Items.Reset();
+    Items.SetNum(Capacity);
+
+    // Pushed in reverse so the first pop hands out slot 0
+    FreeSlots.Reset(Capacity);
+    for (int32 Slot = Capacity - 1; Slot >= 0; Slot--)
+    {
+        Items[Slot].Slot = Slot;
+        FreeSlots.Add(Slot);
+    }
+
+    // On the server every item lives at the index of its slot
+    SlotToIndex.Reset(Capacity);
+    for (int32 Slot = 0; Slot < Capacity; Slot++)
+    {
+        SlotToIndex.Add(Slot);
+    }
+    bIndexDirty = false;
+
+    MarkArrayDirty();
+    NumUnsentChanges += Capacity;
+}
+
+int32 FInventorySlots::Add(const FInventoryItem& Item)
+{
+    if (Item.IsEmpty() || FreeSlots.Num() == 0) return INDEX_NONE;
+
+    const int32 Slot = FreeSlots.Pop(false);
+    Items[Slot].ItemID = Item.ItemID;
+    Items[Slot].Icon = Item.Icon;
+    Items[Slot].PickUpClass = Item.PickUpClass;
+    MarkSlotDirty(Slot);
+    return Slot;
+}
+
+bool FInventorySlots::RemoveAt(int32 Slot, FInventoryItem& OutItem)
+{
+    if (GetItem(Slot) == nullptr) return false;
+
+    OutItem = Items[Slot];
+    Items[Slot].ItemID = NAME_None;
+    Items[Slot].Icon.Reset();
+    Items[Slot].PickUpClass = nullptr;
+    FreeSlots.Push(Slot);
+    MarkSlotDirty(Slot);
+    return true;
+}
+
+const FInventoryItem* FInventorySlots::GetItem(int32 Slot) const
+{
+    if (bIndexDirty) RebuildIndex();
+
+    if (!SlotToIndex.IsValidIndex(Slot)) return nullptr;
+
+    const int32 Index = SlotToIndex[Slot];
+    return (Items.IsValidIndex(Index) && !Items[Index].IsEmpty()) ? &Items[Index] : nullptr;
+}
+
+bool FInventorySlots::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+    const int64 BitsBefore = DeltaParms.Writer ? DeltaParms.Writer->GetNumBits() : 0;
+
+    const bool bResult = FFastArraySerializer::FastArrayDeltaSerialize<FInventoryItem, FInventorySlots>(Items, DeltaParms, *this);
+
+    // Only the sending side has a writer
+    if (DeltaParms.Writer && NumUnsentChanges > 0)
+    {
+        const int32 BytesSent = (int32)((DeltaParms.Writer->GetNumBits() - BitsBefore + 7) / 8);
+        if (BytesSent > 0)
+        {
+            INC_DWORD_STAT_BY(STAT_InventoryBytesSent, BytesSent);
+            INC_DWORD_STAT_BY(STAT_InventoryChangesSent, NumUnsentChanges);
+            SET_DWORD_STAT(STAT_InventoryBytesPerChange, BytesSent / NumUnsentChanges);
+            NumUnsentChanges = 0;
+        }
+    }
+    return bResult;
+}
+
+void FInventorySlots::RebuildIndex() const
+{
+    SlotToIndex.Init(INDEX_NONE, Items.Num());
+
+    for (int32 i = 0; i < Items.Num(); i++)
+    {
+        if (SlotToIndex.IsValidIndex(Items[i].Slot)) SlotToIndex[Items[i].Slot] = i;
+    }
+    bIndexDirty = false;
+}
+
+void FInventorySlots::MarkSlotDirty(int32 Slot)
+{
+    MarkItemDirty(Items[Slot]);
+    NumUnsentChanges++;
+    OnSlotChanged.Broadcast(Slot);
+}
@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Engine/NetSerialization.h"
+#include "InventoryItem.generated.h"
+
+// Called with the slot whose item got added, removed or replaced - on the server and on the owning client
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnInventorySlotChanged, int32);
+
+// A single item carried in the inventory. Holds no actor, so it stays valid after the pickup is destroyed
+USTRUCT(BlueprintType)
+struct FInventoryItem : public FFastArraySerializerItem
+{
+    GENERATED_BODY()
+
+    // The item definition. None means the slot is empty
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+    FName ItemID;
+
+    // The icon shown in the inventory - only loaded when the inventory needs to draw it
+    UPROPERTY(VisibleAnywhere)
+    TAssetPtr<UTexture2D> Icon;
+
+    // The pickup the item came from, spawned again when the item gets dropped
+    UPROPERTY()
+    TSubclassOf<class APickUp> PickUpClass;
+
+    // The slot this item lives in. Clients may receive the slots in any order
+    UPROPERTY()
+    int32 Slot = INDEX_NONE;
+
+    bool IsEmpty() const { return ItemID.IsNone(); }
+
+    // Returns the icon, loading it if it's not in memory yet
+    UTexture2D* LoadIcon() const;
+
+    // Called on clients when the slot arrives
+    void PostReplicatedAdd(const struct FInventorySlots& InArraySerializer);
+
+    // Called on clients when the item of the slot changes
+    void PostReplicatedChange(const struct FInventorySlots& InArraySerializer);
+
+    // Called on clients before the slot gets removed
+    void PreReplicatedRemove(const struct FInventorySlots& InArraySerializer);
+};
+
+/**
+ * A fixed number of inventory slots.
+ * Empty slots are kept in a free list, so adding and removing an item are O(1).
+ * Replicated with fast array delta serialization, so a slot change only sends that slot.
+ */
+USTRUCT()
+struct FInventorySlots : public FFastArraySerializer
+{
+    GENERATED_BODY()
+
+    // Empties the inventory and resizes it to the given number of slots
+    void Init(int32 Capacity);
+
+    // Puts the item in a free slot. Returns the slot, INDEX_NONE if the inventory is full
+    int32 Add(const FInventoryItem& Item);
+
+    // Empties the given slot. Returns false if there was nothing in it
+    bool RemoveAt(int32 Slot, FInventoryItem& OutItem);
+
+    // Returns the item of the given slot, nullptr if the slot is empty or out of range
+    const FInventoryItem* GetItem(int32 Slot) const;
+
+    int32 GetCapacity() const { return Items.Num(); }
+
+    bool IsFull() const { return FreeSlots.Num() == 0; }
+
+    // Rebuilds the slot lookup on the next GetItem - the item order isn't guaranteed on clients
+    void InvalidateIndex() const { bIndexDirty = true; }
+
+    // Broadcasts whenever the item of a slot changes
+    FOnInventorySlotChanged OnSlotChanged;
+
+    bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+
+private:
+    void RebuildIndex() const;
+
+    // Marks the slot for replication and tells the listeners about it
+    void MarkSlotDirty(int32 Slot);
+
+    UPROPERTY(VisibleAnywhere)
+    TArray<FInventoryItem> Items;
+
+    // The empty slots, used as a stack. Only maintained on the server
+    TArray<int32> FreeSlots;
+
+    // The index in Items of every slot
+    mutable TArray<int32> SlotToIndex;
+
+    mutable bool bIndexDirty = true;
+
+    // Slot changes that haven't been sent yet, to report the bytes per change
+    int32 NumUnsentChanges = 0;
+};
+
+template<>
+struct TStructOpsTypeTraits<FInventorySlots> : public TStructOpsTypeTraitsBase
+{
+    enum
+    {
+        WithNetDeltaSerializer = true,
+    };
+};
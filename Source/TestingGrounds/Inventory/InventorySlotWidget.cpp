@@ -11,15 +11,21 @@ void UInventorySlotWidget::SetEquippedItem()
     
     if (Char)
     {
-        Char->SetEquippedItem(ItemTexture);
+        Char->SetEquippedItem(SlotIndex != INDEX_NONE ? SlotIndex : Char->FindItemSlot(ItemID));
     }
 }
 
+void UInventorySlotWidget::SetItem(const FInventoryItem& Item, int32 Slot)
+{
+    // Empty slots get no texture and no index, so the widget won't broadcast wrong info to player
+    ItemTexture = Item.IsEmpty() ? nullptr : Item.LoadIcon();
+    SlotIndex = Item.IsEmpty() ? INDEX_NONE : Slot;
+    ItemID = Item.ItemID;
+}
+
 void UInventorySlotWidget::SetItemTexture(APickUp* Item)
 {
-    // If the item is valid update the widget's texture.
-    // If not, assign a nullptr to it so the widget won't broadcast wrong info to player
-    (Item) ? ItemTexture = Item->GetPickupTexture() : ItemTexture = nullptr;
+    SetItem(Item ? Item->GetInventoryItem() : FInventoryItem(), INDEX_NONE);
 }
 
 
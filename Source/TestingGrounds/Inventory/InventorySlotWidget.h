@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Blueprint/UserWidget.h"
+#include "InventoryItem.h"
 #include "InventorySlotWidget.generated.h"
 
 /**
@@ -20,12 +21,24 @@ protected:
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
     UTexture2D* ItemTexture;
     
+    // The inventory slot this widget represents
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+    int32 SlotIndex = INDEX_NONE;
+    
+    // The item definition this widget represents, to find its slot when none was given
+    FName ItemID;
+    
     // Tells the player the equip of the represented item from this widget
     UFUNCTION(BlueprintCallable, Category = "UI")
     void SetEquippedItem();
     
 public:
-    // Sets the item texture
+    // Sets the item texture and the slot it lives in
+    UFUNCTION(BlueprintCallable, Category = "UI")
+    void SetItem(const FInventoryItem& Item, int32 Slot);
+    
+    // Sets the item texture from an entry of the inventory widget's ItemsArray.
+    // Equipping picks the first slot holding that item
     UFUNCTION(BlueprintCallable, Category = "UI")
     void SetItemTexture(class APickUp* Item);
 	
@@ -2,7 +2,38 @@
 
 #include "TestingGrounds.h"
 #include "InventoryWidget.h"
+#include "InventorySlotWidget.h"
+#include "PickUp.h"
 
+void UInventoryWidget::SetInventory(const FInventorySlots& Inventory)
+{
+    Items.Reset(Inventory.GetCapacity());
+    Items.SetNum(Inventory.GetCapacity());
+    ItemsArray.Reset(Inventory.GetCapacity());
+    ItemsArray.SetNumZeroed(Inventory.GetCapacity());
+    
+    for (int32 Slot = 0; Slot < Inventory.GetCapacity(); Slot++)
+    {
+        RefreshSlot(Slot, Inventory.GetItem(Slot));
+    }
+    bHasInventory = true;
+}
 
-
-
+void UInventoryWidget::RefreshSlot(int32 Slot, const FInventoryItem* Item)
+{
+    // A slot we don't know yet - copy the whole inventory the next time we show it
+    if (!Items.IsValidIndex(Slot))
+    {
+        bHasInventory = false;
+        return;
+    }
+    
+    Items[Slot] = Item ? *Item : FInventoryItem();
+    ItemsArray[Slot] = Items[Slot].PickUpClass ? Items[Slot].PickUpClass->GetDefaultObject<APickUp>() : nullptr;
+    
+    // Only the affected slot widget gets rebuilt
+    if (SlotWidgets.IsValidIndex(Slot) && SlotWidgets[Slot])
+    {
+        SlotWidgets[Slot]->SetItem(Items[Slot], Slot);
+    }
+}
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Blueprint/UserWidget.h"
+#include "InventoryItem.h"
 #include "InventoryWidget.generated.h"
 
 /**
@@ -23,9 +24,30 @@ public:
     UFUNCTION(BlueprintImplementableEvent, Category = Animations)
     void Hide();
     
-    // Stores a reference in order to bind information on inventory slots
+    // Stores the pickup of every inventory slot in order to bind information on inventory slots.
+    // These are the pickup class defaults, nullptr for empty slots
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
     TArray<class APickUp*> ItemsArray;
+    
+    // Stores a copy of the inventory slots. The index of an item is the slot to pass to UInventorySlotWidget::SetItem
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+    TArray<FInventoryItem> Items;
+    
+    // The slot widgets, indexed by inventory slot. Filled by the blueprint when it creates them
+    UPROPERTY(BlueprintReadWrite)
+    TArray<class UInventorySlotWidget*> SlotWidgets;
+    
+    // Copies every slot of the inventory. Only needed once - after that the slots arrive one by one
+    void SetInventory(const FInventorySlots& Inventory);
+    
+    // Updates the copy of a single slot and rebuilds its slot widget
+    void RefreshSlot(int32 Slot, const FInventoryItem* Item);
+    
+    // True once the widget holds a copy of the whole inventory
+    bool HasInventory() const { return bHasInventory; }
+    
+private:
+    bool bHasInventory = false;
 	
 	
 };
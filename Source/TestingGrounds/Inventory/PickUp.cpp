@@ -2,17 +2,28 @@
 
 #include "TestingGrounds.h"
 #include "PickUp.h"
+#include "PickUpRegistry.h"
+#include "../AssetPreloader.h"
+#include "../VisualState.h"
 
 
 // Sets default values
 APickUp::APickUp()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+    // Nothing to update per frame. Periodic updates go through the ATickAggregator
+	PrimaryActorTick.bCanEverTick = false;
 
     PickupSM = CreateDefaultSubobject<UStaticMeshComponent>(FName("PickupSM"));
     
-    PickupTexture = CreateDefaultSubobject<UTexture2D>(FName("ItemTexture"));
+    // Make sure the interaction trace of the player can find us
+    PickupSM->SetCollisionProfileName(FName("Interactable"));
+    
+    // The server picks us up and drops us, clients have to see both
+    bReplicates = true;
+    bReplicateMovement = true;
+    
+    // We rest where we were placed or dropped
+    NetUpdateFrequency = 2.f;
 }
 
 // Called when the game starts or when spawned
@@ -20,17 +31,36 @@ void APickUp::BeginPlay()
 {
 	Super::BeginPlay();
 	
+    // Let the player find us without a physics trace
+    APickUpRegistry* Registry = APickUpRegistry::Get(GetWorld());
+    if (Registry) Registry->Register(this);
     
+    // The icon shows up in the inventory UI as soon as the item is picked up
+    AAssetPreloader* Preloader = AAssetPreloader::Get(GetWorld());
+    if (Preloader && !PickupTexture.IsNull())
+    {
+        Preloader->RequestAssets(EAssetBundle::UI, { PickupTexture.ToStringReference() });
+    }
 }
 
-// Called every frame
-void APickUp::Tick( float DeltaTime )
+void APickUp::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick( DeltaTime );
+    APickUpRegistry* Registry = APickUpRegistry::Get(GetWorld());
+    if (Registry) Registry->Unregister(this);
+    
+    Super::EndPlay(EndPlayReason);
+}
 
+FInventoryItem APickUp::GetInventoryItem() const
+{
+    FInventoryItem Item;
+    Item.ItemID = ItemID.IsNone() ? GetClass()->GetFName() : ItemID;
+    Item.Icon = PickupTexture;
+    Item.PickUpClass = GetClass();
+    return Item;
 }
 
 void APickUp::SetGlowEffect(bool Status)
 {
-    PickupSM->SetRenderCustomDepth(Status);
+    AVisualStateCache::SetCustomDepth(PickupSM, Status);
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "GameFramework/Actor.h"
+#include "InventoryItem.h"
 #include "PickUp.generated.h"
 
 UCLASS()
@@ -17,15 +18,15 @@ public:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 	
-	// Called every frame
-	virtual void Tick( float DeltaSeconds ) override;
-
+	// Called when the pickup gets picked up, destroyed or streamed out
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	
 public:
-    // Enables/Disables the glow effect on the pickup
+    // Enables/Disables the glow effect on the pickup. Does nothing if it already is
     void SetGlowEffect(bool Status);
     
-    // Returns the Texture of our Pickup
-    FORCEINLINE UTexture2D* GetPickupTexture() { return PickupTexture; }
+    // Returns the record the inventory keeps once we get picked up
+    FInventoryItem GetInventoryItem() const;
     
 protected:
     // The Static Mesh of the pickup
@@ -34,7 +35,11 @@ protected:
     
     // The Texture of the item in case we want to add it in the secrets or inventory
     UPROPERTY(EditAnywhere, Category = "PickupProperties")
-    UTexture2D* PickupTexture;
+    TAssetPtr<UTexture2D> PickupTexture;
+    
+    // The item definition this pickup represents. Defaults to the class name when left empty
+    UPROPERTY(EditAnywhere, Category = "PickupProperties")
+    FName ItemID;
     
     // The name of the item
     UPROPERTY(EditAnywhere, Category = "PickupProperties")
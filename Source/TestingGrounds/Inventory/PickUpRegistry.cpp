@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "PickUpRegistry.h"
+#include "PickUp.h"
+#include "../WorldManager.h"
+
+
+// Sets default values
+APickUpRegistry::APickUpRegistry()
+{
+    // The registry only reacts to register/query calls
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+APickUpRegistry* APickUpRegistry::Get(UWorld* World)
+{
+    return GetWorldManager<APickUpRegistry>(World);
+}
+
+void APickUpRegistry::Register(APickUp* PickUp)
+{
+    if (PickUp == nullptr || PickUpCells.Contains(PickUp)) return;
+
+    const FIntVector Cell = GetCell(PickUp->GetActorLocation());
+    Cells.FindOrAdd(Cell).Add(PickUp);
+    PickUpCells.Add(PickUp, Cell);
+}
+
+void APickUpRegistry::Unregister(APickUp* PickUp)
+{
+    FIntVector Cell;
+    if (!PickUpCells.RemoveAndCopyValue(PickUp, Cell)) return;
+
+    TArray<APickUp*>* CellPickUps = Cells.Find(Cell);
+    if (CellPickUps)
+    {
+        CellPickUps->RemoveSingleSwap(PickUp);
+        if (CellPickUps->Num() == 0) Cells.Remove(Cell);
+    }
+}
+
+APickUp* APickUpRegistry::FindClosestInViewCone(const FVector& ViewLocation, const FVector& ViewDirection, float Range, float ConeHalfAngle, const FCollisionQueryParams& OcclusionParams) const
+{
+    const float RangeSquared = Range * Range;
+    const float CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(ConeHalfAngle));
+
+    // Visit every cell touched by the bounding box of the range
+    const FIntVector MinCell = GetCell(ViewLocation - FVector(Range));
+    const FIntVector MaxCell = GetCell(ViewLocation + FVector(Range));
+
+    APickUp* ClosestPickUp = nullptr;
+    float ClosestDistanceSquared = RangeSquared;
+
+    for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+    {
+        for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+        {
+            for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+            {
+                const TArray<APickUp*>* CellPickUps = Cells.Find(FIntVector(X, Y, Z));
+                if (CellPickUps == nullptr) continue;
+
+                for (APickUp* PickUp : *CellPickUps)
+                {
+                    const FVector ToPickUp = PickUp->GetActorLocation() - ViewLocation;
+                    const float DistanceSquared = ToPickUp.SizeSquared();
+                    if (DistanceSquared > ClosestDistanceSquared) continue;
+
+                    // Inside the cone: cos(angle) * |ToPickUp| <= dot(ToPickUp, ViewDirection)
+                    const float Dot = FVector::DotProduct(ToPickUp, ViewDirection);
+                    if (Dot < 0.f || Dot * Dot < CosHalfAngle * CosHalfAngle * DistanceSquared) continue;
+
+                    ClosestPickUp = PickUp;
+                    ClosestDistanceSquared = DistanceSquared;
+                }
+            }
+        }
+    }
+
+    if (ClosestPickUp == nullptr) return nullptr;
+
+    // Make sure nothing stands between the camera and the winner
+    FHitResult OcclusionHit;
+    GetWorld()->LineTraceSingleByChannel(OcclusionHit,
+                                         ViewLocation,
+                                         ClosestPickUp->GetActorLocation(),
+                                         ECC_Interactable,
+                                         OcclusionParams);
+
+    if (OcclusionHit.bBlockingHit && OcclusionHit.GetActor() != ClosestPickUp) return nullptr;
+    return ClosestPickUp;
+}
+
+FIntVector APickUpRegistry::GetCell(const FVector& Location) const
+{
+    return FIntVector(FMath::FloorToInt(Location.X / CellSize),
+                      FMath::FloorToInt(Location.Y / CellSize),
+                      FMath::FloorToInt(Location.Z / CellSize));
+}
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "PickUpRegistry.generated.h"
+
+class APickUp;
+
+/**
+ * Per-world uniform spatial hash of every APickUp in play.
+ * Answers "closest pickup in front of the camera" without touching the physics scene,
+ * falling back to a single occlusion trace for the winning candidate only.
+ */
+UCLASS()
+class TESTINGGROUNDS_API APickUpRegistry : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	APickUpRegistry();
+
+    // Returns the registry of the given world, spawning it if needed
+    static APickUpRegistry* Get(UWorld* World);
+
+    // Adds the pickup to the cell of its current location
+    void Register(APickUp* PickUp);
+
+    // Removes the pickup from the cell it was registered in
+    void Unregister(APickUp* PickUp);
+
+    /**
+     * Returns the closest pickup within Range whose direction lies inside the view cone,
+     * or nullptr if there's none or the closest one is occluded.
+     * @param ConeHalfAngle	Half angle of the view cone, in degrees
+     */
+    APickUp* FindClosestInViewCone(const FVector& ViewLocation, const FVector& ViewDirection, float Range, float ConeHalfAngle, const FCollisionQueryParams& OcclusionParams) const;
+
+    // Returns the number of registered pickups
+    int32 GetNumRegistered() const { return PickUpCells.Num(); }
+
+protected:
+    // The edge length of a hash cell. Should be in the order of the interaction range
+    UPROPERTY(EditAnywhere, Category = "PickUpRegistry")
+    float CellSize = 500.f;
+
+private:
+    // Returns the cell the given location falls into
+    FIntVector GetCell(const FVector& Location) const;
+
+    // The pickups of every non-empty cell
+    TMap<FIntVector, TArray<APickUp*>> Cells;
+
+    // The cell each pickup was registered in, so removal doesn't depend on where it is now
+    TMap<APickUp*, FIntVector> PickUpCells;
+};
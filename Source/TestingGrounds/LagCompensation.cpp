@@ -0,0 +1,293 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "LagCompensation.h"
+#include "WorldManager.h"
+#include "TestingGroundsStats.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogLagCompensation, Log, All);
+
+
+void FCapsuleHistory::Init(int32 InNumFrames, int32 InMaxSlots)
+{
+    NumFrames = FMath::Max(InNumFrames, 2);
+    MaxSlots = FMath::Max(InMaxSlots, 1);
+    NewestFrame = INDEX_NONE;
+    NumRecorded = 0;
+
+    FrameTimes.Init(0.f, NumFrames);
+    FrameNumbers.Init(0, NumFrames);
+    Locations.Init(FVector::ZeroVector, NumFrames * MaxSlots);
+    Radii.Init(0.f, NumFrames * MaxSlots);
+    HalfHeights.Init(0.f, NumFrames * MaxSlots);
+    SlotFirstFrames.Init(0, MaxSlots);
+
+    // Handed out lowest first
+    FreeSlots.Reset();
+    for (int32 Slot = MaxSlots - 1; Slot >= 0; Slot--) FreeSlots.Add(Slot);
+    NumSlotsUsed = 0;
+}
+
+int32 FCapsuleHistory::AddSlot()
+{
+    if (FreeSlots.Num() == 0) return INDEX_NONE;
+
+    const int32 Slot = FreeSlots.Pop(false);
+    SlotFirstFrames[Slot] = NextFrameNumber;
+    NumSlotsUsed++;
+    return Slot;
+}
+
+void FCapsuleHistory::RemoveSlot(int32 Slot)
+{
+    if (!SlotFirstFrames.IsValidIndex(Slot) || SlotFirstFrames[Slot] == 0) return;
+
+    SlotFirstFrames[Slot] = 0;
+    FreeSlots.Add(Slot);
+    NumSlotsUsed--;
+}
+
+void FCapsuleHistory::BeginFrame(float Time)
+{
+    NewestFrame = (NewestFrame + 1) % NumFrames;
+    NumRecorded = FMath::Min(NumRecorded + 1, NumFrames);
+
+    FrameTimes[NewestFrame] = Time;
+    FrameNumbers[NewestFrame] = NextFrameNumber++;
+}
+
+float FCapsuleHistory::GetOldestTime() const
+{
+    return (NumRecorded > 0) ? FrameTimes[GetFrame(0)] : 0.f;
+}
+
+bool FCapsuleHistory::FindFrames(float Time, int32& OutOlder, int32& OutNewer, float& OutAlpha) const
+{
+    if (NumRecorded == 0 || Time < FrameTimes[GetFrame(0)]) return false;
+
+    // Hits from the current frame use the newest row as it is
+    if (Time >= FrameTimes[NewestFrame])
+    {
+        OutOlder = OutNewer = NewestFrame;
+        OutAlpha = 0.f;
+        return true;
+    }
+
+    // The first recorded frame later than Time
+    int32 Low = 1;
+    int32 High = NumRecorded - 1;
+    while (Low < High)
+    {
+        const int32 Middle = (Low + High) / 2;
+        if (FrameTimes[GetFrame(Middle)] > Time) High = Middle;
+        else Low = Middle + 1;
+    }
+
+    OutNewer = GetFrame(Low);
+    OutOlder = GetFrame(Low - 1);
+    const float FrameSeconds = FrameTimes[OutNewer] - FrameTimes[OutOlder];
+    OutAlpha = (FrameSeconds > 0.f) ? (Time - FrameTimes[OutOlder]) / FrameSeconds : 0.f;
+    return true;
+}
+
+void FCapsuleHistory::TestHits(TArray<FCapsuleHitQuery>& Queries, float Tolerance) const
+{
+    Queries.Sort([](const FCapsuleHitQuery& A, const FCapsuleHitQuery& B) { return A.Time < B.Time; });
+
+    float FramesTime = 0.f;
+    bool bHasFrames = false;
+    bool bFramesValid = false;
+    int32 Older = INDEX_NONE;
+    int32 Newer = INDEX_NONE;
+    float Alpha = 0.f;
+
+    for (FCapsuleHitQuery& Query : Queries)
+    {
+        Query.bHit = false;
+
+        if (!bHasFrames || Query.Time != FramesTime)
+        {
+            bFramesValid = FindFrames(Query.Time, Older, Newer, Alpha);
+            FramesTime = Query.Time;
+            bHasFrames = true;
+        }
+        if (!bFramesValid || !SlotFirstFrames.IsValidIndex(Query.Slot)) continue;
+
+        // The slot may have belonged to another character back then
+        const uint64 FirstFrame = SlotFirstFrames[Query.Slot];
+        if (FirstFrame == 0 || FrameNumbers[Older] < FirstFrame) continue;
+
+        const int32 OlderIndex = Older * MaxSlots + Query.Slot;
+        const int32 NewerIndex = Newer * MaxSlots + Query.Slot;
+        const FVector Center = FMath::Lerp(Locations[OlderIndex], Locations[NewerIndex], Alpha);
+        const float Radius = FMath::Lerp(Radii[OlderIndex], Radii[NewerIndex], Alpha);
+        const float HalfHeight = FMath::Lerp(HalfHeights[OlderIndex], HalfHeights[NewerIndex], Alpha);
+
+        // Distance to the capsule's segment, minus its radius
+        const FVector SegmentOffset(0.f, 0.f, FMath::Max(HalfHeight - Radius, 0.f));
+        const FVector Closest = FMath::ClosestPointOnSegment(Query.Location, Center - SegmentOffset, Center + SegmentOffset);
+        Query.bHit = FVector::DistSquared(Query.Location, Closest) <= FMath::Square(Radius + Tolerance);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// Sets default values
+ALagCompensation::ALagCompensation()
+{
+    // Records once everything has moved
+	PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+}
+
+void ALagCompensation::PostInitializeComponents()
+{
+    Super::PostInitializeComponents();
+
+    History.Init(HistoryFrames, MaxCharacters);
+}
+
+void ALagCompensation::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    ValidateQueuedHits();
+    RecordFrame();
+}
+
+ALagCompensation* ALagCompensation::Get(UWorld* World)
+{
+    return GetWorldManager<ALagCompensation>(World);
+}
+
+void ALagCompensation::RegisterIfAuthority(ACharacter* Character)
+{
+    // Only the server checks hits, don't spawn the manager anywhere else
+    if (Character == nullptr || Character->Role != ROLE_Authority) return;
+
+    ALagCompensation* LagCompensation = Get(Character->GetWorld());
+    if (LagCompensation)
+    {
+        LagCompensation->RegisterCharacter(Character);
+    }
+}
+
+void ALagCompensation::UnregisterIfAuthority(ACharacter* Character)
+{
+    if (Character == nullptr || Character->Role != ROLE_Authority) return;
+
+    ALagCompensation* LagCompensation = Get(Character->GetWorld());
+    if (LagCompensation)
+    {
+        LagCompensation->UnregisterCharacter(Character);
+    }
+}
+
+void ALagCompensation::RegisterCharacter(ACharacter* Character)
+{
+    if (Character == nullptr || CharacterSlots.Contains(Character)) return;
+
+    const int32 Slot = History.AddSlot();
+    if (Slot == INDEX_NONE)
+    {
+        UE_LOG(LogLagCompensation, Warning, TEXT("More than %d characters, %s won't be lag compensated"), MaxCharacters, *Character->GetName());
+        return;
+    }
+    CharacterSlots.Add(Character, Slot);
+}
+
+void ALagCompensation::UnregisterCharacter(ACharacter* Character)
+{
+    int32 Slot = INDEX_NONE;
+    if (CharacterSlots.RemoveAndCopyValue(Character, Slot))
+    {
+        History.RemoveSlot(Slot);
+    }
+}
+
+float ALagCompensation::ClampViewTime(APawn* Shooter, float ReportedViewTime) const
+{
+    const float Now = GetWorld()->GetTimeSeconds();
+
+    // A client sees the others a round trip late, at most
+    float RewindSeconds = MaxRewindSeconds;
+    UNetConnection* Connection = Shooter ? Shooter->GetNetConnection() : nullptr;
+    if (Connection)
+    {
+        RewindSeconds = FMath::Min(RewindSeconds, Connection->AvgLag + ViewTimeSlack);
+    }
+
+    return FMath::Clamp(ReportedViewTime, Now - RewindSeconds, Now);
+}
+
+void ALagCompensation::QueueHit(const FCompensatedHit& Hit)
+{
+    QueuedHits.Add(Hit);
+}
+
+void ALagCompensation::RecordFrame()
+{
+    TG_SCOPE_CYCLE_COUNTER(RecordHistory);
+    TG_SET_DWORD(CompensatedCharacters, History.GetNumSlots());
+
+    if (CharacterSlots.Num() == 0) return;
+
+    History.BeginFrame(GetWorld()->GetTimeSeconds());
+    for (auto It = CharacterSlots.CreateIterator(); It; ++It)
+    {
+        ACharacter* Character = It.Key().Get();
+        if (Character == nullptr)
+        {
+            // Gone without unregistering
+            History.RemoveSlot(It.Value());
+            It.RemoveCurrent();
+            continue;
+        }
+
+        const UCapsuleComponent* Capsule = Character->GetCapsuleComponent();
+        History.Record(It.Value(), Capsule->GetComponentLocation(), Capsule->GetScaledCapsuleRadius(), Capsule->GetScaledCapsuleHalfHeight());
+    }
+}
+
+void ALagCompensation::ValidateQueuedHits()
+{
+    if (QueuedHits.Num() == 0) return;
+    TG_SCOPE_CYCLE_COUNTER(ValidateHits);
+
+    Queries.Reset();
+    for (int32 i = 0; i < QueuedHits.Num(); i++)
+    {
+        const FCompensatedHit& Hit = QueuedHits[i];
+        const int32* Slot = CharacterSlots.Find(Cast<ACharacter>(Hit.Victim.Get()));
+        if (Slot == nullptr)
+        {
+            TG_INC_COUNTER(HitsRejected);
+            continue;
+        }
+
+        FCapsuleHitQuery& Query = Queries[Queries.AddDefaulted()];
+        Query.Slot = *Slot;
+        Query.Time = Hit.ViewTime;
+        Query.Location = Hit.HitLocation;
+        Query.UserIndex = i;
+    }
+
+    History.TestHits(Queries, HitTolerance);
+
+    // Victims may die of earlier hits of the batch, so the hits stay in the queue until every test is done
+    for (const FCapsuleHitQuery& Query : Queries)
+    {
+        const FCompensatedHit& Hit = QueuedHits[Query.UserIndex];
+        AActor* Victim = Hit.Victim.Get();
+        if (!Query.bHit || Victim == nullptr)
+        {
+            TG_INC_COUNTER(HitsRejected);
+            continue;
+        }
+
+        TG_INC_COUNTER(HitsAccepted);
+        FHitResult HitResult(Victim, nullptr, Hit.HitLocation, -Hit.ShotDirection);
+        UGameplayStatics::ApplyPointDamage(Victim, Hit.Damage, Hit.ShotDirection, HitResult, Hit.InstigatedBy.Get(), Hit.DamageCauser.Get(), UDamageType::StaticClass());
+    }
+    QueuedHits.Reset();
+}
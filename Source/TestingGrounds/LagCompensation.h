@@ -0,0 +1,179 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "LagCompensation.generated.h"
+
+// A point to test against the capsule a history slot had at a given time
+struct FCapsuleHitQuery
+{
+    int32 Slot = INDEX_NONE;
+    float Time = 0.f;
+    FVector Location = FVector::ZeroVector;
+
+    // Lets the caller find its query again, the batch gets sorted
+    int32 UserIndex = INDEX_NONE;
+
+    // Set by the test
+    bool bHit = false;
+};
+
+/**
+ * Ring buffer of the upright capsules of up to MaxSlots characters, one row per recorded frame.
+ * Stored as structure of arrays, row after row, so a rewind only reads the two rows around its time.
+ * Game thread only.
+ */
+class TESTINGGROUNDS_API FCapsuleHistory
+{
+public:
+    void Init(int32 InNumFrames, int32 InMaxSlots);
+
+    // Returns a free slot, or INDEX_NONE if every slot is taken. The slot has no history before the next frame
+    int32 AddSlot();
+
+    void RemoveSlot(int32 Slot);
+
+    // Starts a new row at Time, overwriting the oldest one. Times must increase
+    void BeginFrame(float Time);
+
+    // Writes the capsule of the slot into the current row
+    void Record(int32 Slot, const FVector& Location, float Radius, float HalfHeight)
+    {
+        const int32 Index = NewestFrame * MaxSlots + Slot;
+        Locations[Index] = Location;
+        Radii[Index] = Radius;
+        HalfHeights[Index] = HalfHeight;
+    }
+
+    // Sets bHit of every query. The batch gets sorted by time, so queries of the same time share the row lookup
+    void TestHits(TArray<FCapsuleHitQuery>& Queries, float Tolerance) const;
+
+    // Returns the oldest time the history covers
+    float GetOldestTime() const;
+
+    int32 GetNumSlots() const { return NumSlotsUsed; }
+
+private:
+    // Finds the rows around Time and how far Time is from the older one. False if the history doesn't cover Time
+    bool FindFrames(float Time, int32& OutOlder, int32& OutNewer, float& OutAlpha) const;
+
+    // Returns the physical row of the Index-th oldest recorded frame
+    int32 GetFrame(int32 Index) const { return (NewestFrame - NumRecorded + 1 + Index + NumFrames) % NumFrames; }
+
+    int32 NumFrames = 0;
+    int32 MaxSlots = 0;
+
+    int32 NewestFrame = INDEX_NONE;
+    int32 NumRecorded = 0;
+
+    // Every row's time and frame number
+    TArray<float> FrameTimes;
+    TArray<uint64> FrameNumbers;
+    uint64 NextFrameNumber = 1;
+
+    // The capsules, indexed by Frame * MaxSlots + Slot
+    TArray<FVector> Locations;
+    TArray<float> Radii;
+    TArray<float> HalfHeights;
+
+    // The first frame number of every slot's current owner, 0 while free. Older rows belong to the previous owner
+    TArray<uint64> SlotFirstFrames;
+
+    TArray<int32> FreeSlots;
+    int32 NumSlotsUsed = 0;
+};
+
+// A hit a client reported, applied if the hit location was on the victim's capsule when the client saw it
+struct FCompensatedHit
+{
+    TWeakObjectPtr<AActor> Victim;
+    FVector HitLocation = FVector::ZeroVector;
+    FVector ShotDirection = FVector::ZeroVector;
+
+    // The server time of the world the client saw
+    float ViewTime = 0.f;
+
+    float Damage = 0.f;
+    TWeakObjectPtr<AController> InstigatedBy;
+    TWeakObjectPtr<AActor> DamageCauser;
+};
+
+/**
+ * Per-world lag compensation. Server only.
+ * Records the capsules of the registered characters at the end of every frame, and applies the hits clients
+ * report only if they land on the victim as it was at the client's view time. Hits get checked in one batch per frame.
+ * Use "stat TestingGrounds" or tg.Stats.Capture on the server for the cost and how many hits hold up, and tg.BenchLagCompensation for the cost with many characters.
+ */
+UCLASS()
+class TESTINGGROUNDS_API ALagCompensation : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ALagCompensation();
+
+    virtual void PostInitializeComponents() override;
+
+    // Checks the hits reported this frame, then records where everybody is
+    virtual void Tick(float DeltaSeconds) override;
+
+    // Returns the lag compensation of the given world, spawning it if needed
+    static ALagCompensation* Get(UWorld* World);
+
+    // Registers the character with the lag compensation of its world, if it's the server's copy
+    static void RegisterIfAuthority(ACharacter* Character);
+
+    // Undoes RegisterIfAuthority, for EndPlay
+    static void UnregisterIfAuthority(ACharacter* Character);
+
+    void RegisterCharacter(ACharacter* Character);
+
+    void UnregisterCharacter(ACharacter* Character);
+
+    // Limits the view time a client reported to what the round trip of its connection allows
+    float ClampViewTime(APawn* Shooter, float ReportedViewTime) const;
+
+    // Queues the hit for the next batch
+    void QueueHit(const FCompensatedHit& Hit);
+
+    UFUNCTION(BlueprintCallable, Category = "LagCompensation")
+    int32 GetNumCharacters() const { return History.GetNumSlots(); }
+
+protected:
+    // How many frames of history are kept. Has to cover MaxRewindSeconds at the server's frame rate
+    UPROPERTY(EditDefaultsOnly, Category = "LagCompensation")
+    int32 HistoryFrames = 128;
+
+    // Characters past this many aren't compensated, their hits get rejected
+    UPROPERTY(EditDefaultsOnly, Category = "LagCompensation")
+    int32 MaxCharacters = 64;
+
+    // The furthest back a hit gets rewound, whatever the client's lag
+    UPROPERTY(EditAnywhere, Category = "LagCompensation")
+    float MaxRewindSeconds = 0.5f;
+
+    // How much further back than its round trip a client may claim to have seen the world
+    UPROPERTY(EditAnywhere, Category = "LagCompensation")
+    float ViewTimeSlack = 0.1f;
+
+    // How far off the rewound capsule a hit may be, for quantization and interpolation errors
+    UPROPERTY(EditAnywhere, Category = "LagCompensation")
+    float HitTolerance = 30.f;
+
+private:
+    void RecordFrame();
+
+    void ValidateQueuedHits();
+
+    FCapsuleHistory History;
+
+    // The history slot of every registered character
+    TMap<TWeakObjectPtr<ACharacter>, int32> CharacterSlots;
+
+    TArray<FCompensatedHit> QueuedHits;
+
+    // Reused by every batch
+    TArray<FCapsuleHitQuery> Queries;
+};
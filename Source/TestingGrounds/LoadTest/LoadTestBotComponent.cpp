@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "LoadTestBotComponent.h"
+#include "../Player/CharacterV2.h"
+#include "../TickAggregator.h"
+
+
+// Sets default values for this component's properties
+ULoadTestBotComponent::ULoadTestBotComponent()
+{
+	// The bot runs in the ATickAggregator, it doesn't need its own tick
+	bWantsBeginPlay = true;
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void ULoadTestBotComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+    SpawnLocation = GetOwner()->GetActorLocation();
+
+    // Every bot of a run behaves differently, but the same bot is reproducible
+    Random.Initialize(GetTypeHash(GetOwner()->GetName()));
+    TimeUntilBomb = Random.FRandRange(0.f, BombInterval);
+
+    ATickAggregator* TickAggregator = ATickAggregator::Get(GetWorld());
+    if (TickAggregator)
+    {
+        TickAggregator->Register(ETickCategory::Character, this, &ULoadTestBotComponent::UpdateBot);
+    }
+}
+
+void ULoadTestBotComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    ATickAggregator* TickAggregator = ATickAggregator::Get(GetWorld());
+    if (TickAggregator)
+    {
+        TickAggregator->Unregister(ETickCategory::Character, this);
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+bool ULoadTestBotComponent::IsLoadTestBot()
+{
+    static const bool bIsLoadTestBot = FParse::Param(FCommandLine::Get(), TEXT("LoadTestBot"));
+    return bIsLoadTestBot;
+}
+
+void ULoadTestBotComponent::UpdateBot(float DeltaSeconds)
+{
+    ACharacterV2* Character = Cast<ACharacterV2>(GetOwner());
+
+    // The pawn may not be possessed yet
+    if (Character == nullptr || !Character->IsLocallyControlled()) return;
+
+    TimeUntilWander -= DeltaSeconds;
+    if (TimeUntilWander <= 0.f)
+    {
+        TimeUntilWander = WanderInterval;
+
+        const FVector ToSpawn = SpawnLocation - Character->GetActorLocation();
+        if (ToSpawn.SizeSquared2D() > FMath::Square(WanderRadius))
+        {
+            WanderDirection = ToSpawn.GetSafeNormal2D();
+        }
+        else
+        {
+            WanderDirection = FRotator(0.f, Random.FRandRange(0.f, 360.f), 0.f).Vector();
+        }
+
+        if (Random.FRand() < 0.25f) Character->Jump();
+    }
+    // The character turns towards where it walks, so the bombs fly that way too
+    Character->AddMovementInput(WanderDirection, 1.f);
+
+    TimeUntilBomb -= DeltaSeconds;
+    if (TimeUntilBomb <= 0.f)
+    {
+        TimeUntilBomb = BombInterval;
+        Character->AttempToSpawnBomb();
+    }
+}
@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "LoadTestBotComponent.generated.h"
+
+/**
+ * Drives a locally controlled ACharacterV2 like a player would, for headless load test clients.
+ * Wanders around its spawn point, jumps now and then and throws a bomb whenever it's due.
+ * ACharacterV2 adds it on clients started with -LoadTestBot.
+ */
+UCLASS(ClassGroup=(Custom))
+class TESTINGGROUNDS_API ULoadTestBotComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	ULoadTestBotComponent();
+
+	virtual void BeginPlay() override;
+
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    // Returns true if this process was started as a load test bot
+    static bool IsLoadTestBot();
+
+protected:
+    // Seconds between two bomb throws
+    UPROPERTY(EditAnywhere, Category = "LoadTest")
+    float BombInterval = 3.f;
+
+    // Seconds the bot keeps walking in the same direction
+    UPROPERTY(EditAnywhere, Category = "LoadTest")
+    float WanderInterval = 2.f;
+
+    // The bot turns back towards its spawn point once it's further away than this
+    UPROPERTY(EditAnywhere, Category = "LoadTest")
+    float WanderRadius = 800.f;
+
+private:
+    // Runs in the Character category of the ATickAggregator
+    void UpdateBot(float DeltaSeconds);
+
+    FVector SpawnLocation;
+
+    FVector WanderDirection = FVector::ForwardVector;
+
+    float TimeUntilBomb = 0.f;
+
+    float TimeUntilWander = 0.f;
+
+    FRandomStream Random;
+};
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "LoadTestNetDriver.h"
+#include "../TestingGroundsStats.h"
+
+int32 ULoadTestNetDriver::ServerReplicateActors(float DeltaSeconds)
+{
+    const double StartTime = FPlatformTime::Seconds();
+
+    const int32 NumReplicated = Super::ServerReplicateActors(DeltaSeconds);
+
+    ReplicationTimeMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+    NumReplicationFrames++;
+    return NumReplicated;
+}
+
+void ULoadTestNetDriver::ProcessRemoteFunction(AActor* Actor, UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack, UObject* SubObject)
+{
+    TG_INC_COUNTER(RPCsSent);
+    if (Function) SentRPCs.FindOrAdd(Function->GetFName())++;
+
+    Super::ProcessRemoteFunction(Actor, Function, Parameters, OutParms, Stack, SubObject);
+}
+
+void ULoadTestNetDriver::CountReceivedRPC(AActor* Actor, FName FunctionName)
+{
+    TG_INC_COUNTER(RPCsReceived);
+    
+    ULoadTestNetDriver* NetDriver = Actor ? Cast<ULoadTestNetDriver>(Actor->GetNetDriver()) : nullptr;
+    if (NetDriver) NetDriver->ReceivedRPCs.FindOrAdd(FunctionName)++;
+}
+
+void ULoadTestNetDriver::ResetCounters()
+{
+    ReplicationTimeMs = 0.0;
+    NumReplicationFrames = 0;
+    SentRPCs.Reset();
+    ReceivedRPCs.Reset();
+}
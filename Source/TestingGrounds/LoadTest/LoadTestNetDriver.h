@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "IpNetDriver.h"
+#include "LoadTestNetDriver.generated.h"
+
+/**
+ * The game's IP net driver, instrumented for load tests.
+ * Times every ServerReplicateActors call and counts RPCs by function name.
+ * Sessions use the engine's default driver; Scripts/RunLoadTest.sh makes this the game net driver of its server
+ * through an engine ini override on the command line.
+ */
+UCLASS(transient, config=Engine)
+class TESTINGGROUNDS_API ULoadTestNetDriver : public UIpNetDriver
+{
+	GENERATED_BODY()
+
+public:
+    virtual int32 ServerReplicateActors(float DeltaSeconds) override;
+
+    virtual void ProcessRemoteFunction(AActor* Actor, UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack, UObject* SubObject = nullptr) override;
+
+    // Counts an RPC this machine received. Call it from the _Implementation of the RPCs you want to measure
+    static void CountReceivedRPC(AActor* Actor, FName FunctionName);
+
+    // Milliseconds spent replicating actors since the last ResetCounters
+    double GetReplicationTimeMs() const { return ReplicationTimeMs; }
+
+    // The number of ServerReplicateActors calls since the last ResetCounters
+    int32 GetNumReplicationFrames() const { return NumReplicationFrames; }
+
+    // RPCs sent and received since the last ResetCounters, by function name
+    const TMap<FName, int32>& GetSentRPCs() const { return SentRPCs; }
+    const TMap<FName, int32>& GetReceivedRPCs() const { return ReceivedRPCs; }
+
+    void ResetCounters();
+
+private:
+    double ReplicationTimeMs = 0.0;
+
+    int32 NumReplicationFrames = 0;
+
+    TMap<FName, int32> SentRPCs;
+
+    TMap<FName, int32> ReceivedRPCs;
+};
@@ -0,0 +1,243 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "LoadTestRecorder.h"
+#include "LoadTestNetDriver.h"
+#include "../Player/CharacterV2.h"
+#include "../WorldManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogLoadTest, Log, All);
+
+// Sets default values
+ALoadTestRecorder::ALoadTestRecorder()
+{
+    // Samples every frame while recording, after everything else has ticked
+	PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.bStartWithTickEnabled = false;
+    PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+}
+
+void ALoadTestRecorder::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    // Don't lose a run that ends with the map
+    if (bIsRecording) StopRecording();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+ALoadTestRecorder* ALoadTestRecorder::Get(UWorld* World)
+{
+    return GetWorldManager<ALoadTestRecorder>(World);
+}
+
+void ALoadTestRecorder::StartRecording(float Duration, const FString& InCsvBasePath, bool bInExitWhenDone)
+{
+    if (bIsRecording) StopRecording();
+
+    bIsRecording = true;
+    bExitWhenDone = bInExitWhenDone;
+    CsvBasePath = InCsvBasePath;
+    TimeLeft = Duration;
+    RunTime = 0.f;
+    TimeSinceSample = 0.f;
+    TimeSinceBombRefill = 0.f;
+    FrameWorkStartTime = 0.0;
+
+    FrameTimesMs.Reset();
+    FrameWorkTimesMs.Reset();
+    RunFrameTimesMs.Reset();
+    RunFrameWorkTimesMs.Reset();
+
+    FramesCsv = TEXT("Time,Clients,FrameMsP50,FrameMsP90,FrameMsP99,FrameMsMax,WorkMsP50,WorkMsP90,WorkMsP99,WorkMsMax,ReplicationMsPerFrame,InBytesPerSec,OutBytesPerSec\n");
+    ConnectionsCsv = TEXT("Time,Connection,InBytesPerSec,OutBytesPerSec,PingMs\n");
+    RpcsCsv = TEXT("Time,Direction,Function,Count\n");
+
+    ULoadTestNetDriver* NetDriver = Cast<ULoadTestNetDriver>(GetWorld()->GetNetDriver());
+    if (NetDriver)
+    {
+        NetDriver->ResetCounters();
+    }
+    else
+    {
+        UE_LOG(LogLoadTest, Warning, TEXT("The game net driver isn't a LoadTestNetDriver - no RPC counts or replication time will be recorded"));
+    }
+
+    WorldTickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &ALoadTestRecorder::OnWorldTickStart);
+    EndFrameHandle = FCoreDelegates::OnEndFrame.AddUObject(this, &ALoadTestRecorder::OnEndFrame);
+
+    SetActorTickEnabled(true);
+
+    UE_LOG(LogLoadTest, Log, TEXT("Recording a %.0f second load test into %s_*.csv"), Duration, *CsvBasePath);
+}
+
+void ALoadTestRecorder::StopRecording()
+{
+    if (!bIsRecording) return;
+
+    bIsRecording = false;
+    SetActorTickEnabled(false);
+    FWorldDelegates::OnWorldTickStart.Remove(WorldTickStartHandle);
+    FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+
+    // The summary of the whole run goes last
+    FramesCsv += FString::Printf(TEXT("Total,,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,,,\n"),
+                                 GetPercentile(RunFrameTimesMs, 0.5f), GetPercentile(RunFrameTimesMs, 0.9f),
+                                 GetPercentile(RunFrameTimesMs, 0.99f), GetPercentile(RunFrameTimesMs, 1.f),
+                                 GetPercentile(RunFrameWorkTimesMs, 0.5f), GetPercentile(RunFrameWorkTimesMs, 0.9f),
+                                 GetPercentile(RunFrameWorkTimesMs, 0.99f), GetPercentile(RunFrameWorkTimesMs, 1.f));
+
+    const bool bSaved = FFileHelper::SaveStringToFile(FramesCsv, *(CsvBasePath + TEXT("_frames.csv")))
+                        && FFileHelper::SaveStringToFile(ConnectionsCsv, *(CsvBasePath + TEXT("_connections.csv")))
+                        && FFileHelper::SaveStringToFile(RpcsCsv, *(CsvBasePath + TEXT("_rpcs.csv")));
+
+    if (bSaved)
+    {
+        UE_LOG(LogLoadTest, Log, TEXT("Load test done, results in %s_*.csv"), *CsvBasePath);
+    }
+    else
+    {
+        UE_LOG(LogLoadTest, Error, TEXT("Couldn't write the load test results to %s_*.csv"), *CsvBasePath);
+    }
+
+    if (bExitWhenDone) FPlatformMisc::RequestExit(false);
+}
+
+void ALoadTestRecorder::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    if (!bIsRecording) return;
+
+    const float FrameMs = DeltaSeconds * 1000.f;
+    FrameTimesMs.Add(FrameMs);
+    RunFrameTimesMs.Add(FrameMs);
+
+    RunTime += DeltaSeconds;
+    TimeLeft -= DeltaSeconds;
+
+    TimeSinceBombRefill += DeltaSeconds;
+    if (TimeSinceBombRefill >= BombRefillInterval)
+    {
+        TimeSinceBombRefill = 0.f;
+        RefillBombs();
+    }
+
+    TimeSinceSample += DeltaSeconds;
+    if (TimeSinceSample >= SampleInterval)
+    {
+        TimeSinceSample = 0.f;
+        WriteSample();
+    }
+
+    if (TimeLeft <= 0.f) StopRecording();
+}
+
+void ALoadTestRecorder::OnWorldTickStart(ELevelTick TickType, float DeltaSeconds)
+{
+    FrameWorkStartTime = FPlatformTime::Seconds();
+}
+
+void ALoadTestRecorder::OnEndFrame()
+{
+    if (FrameWorkStartTime <= 0.0) return;
+
+    const float WorkMs = (float)((FPlatformTime::Seconds() - FrameWorkStartTime) * 1000.0);
+    FrameWorkTimesMs.Add(WorkMs);
+    RunFrameWorkTimesMs.Add(WorkMs);
+    FrameWorkStartTime = 0.0;
+}
+
+void ALoadTestRecorder::WriteSample()
+{
+    UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+    ULoadTestNetDriver* LoadTestNetDriver = Cast<ULoadTestNetDriver>(NetDriver);
+
+    int32 NumClients = 0;
+    int32 TotalInBytesPerSecond = 0;
+    int32 TotalOutBytesPerSecond = 0;
+    if (NetDriver)
+    {
+        for (UNetConnection* Connection : NetDriver->ClientConnections)
+        {
+            if (Connection == nullptr) continue;
+
+            NumClients++;
+            TotalInBytesPerSecond += Connection->InBytesPerSecond;
+            TotalOutBytesPerSecond += Connection->OutBytesPerSecond;
+            ConnectionsCsv += FString::Printf(TEXT("%.1f,%s,%d,%d,%.1f\n"),
+                                              RunTime, *Connection->LowLevelGetRemoteAddress(true),
+                                              Connection->InBytesPerSecond, Connection->OutBytesPerSecond,
+                                              Connection->AvgLag * 1000.f);
+        }
+    }
+
+    float ReplicationMsPerFrame = 0.f;
+    if (LoadTestNetDriver)
+    {
+        ReplicationMsPerFrame = (float)(LoadTestNetDriver->GetReplicationTimeMs() / FMath::Max(LoadTestNetDriver->GetNumReplicationFrames(), 1));
+
+        for (const auto& Pair : LoadTestNetDriver->GetSentRPCs())
+        {
+            RpcsCsv += FString::Printf(TEXT("%.1f,Sent,%s,%d\n"), RunTime, *Pair.Key.ToString(), Pair.Value);
+        }
+        for (const auto& Pair : LoadTestNetDriver->GetReceivedRPCs())
+        {
+            RpcsCsv += FString::Printf(TEXT("%.1f,Received,%s,%d\n"), RunTime, *Pair.Key.ToString(), Pair.Value);
+        }
+        LoadTestNetDriver->ResetCounters();
+    }
+
+    FramesCsv += FString::Printf(TEXT("%.1f,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%d,%d\n"),
+                                 RunTime, NumClients,
+                                 GetPercentile(FrameTimesMs, 0.5f), GetPercentile(FrameTimesMs, 0.9f),
+                                 GetPercentile(FrameTimesMs, 0.99f), GetPercentile(FrameTimesMs, 1.f),
+                                 GetPercentile(FrameWorkTimesMs, 0.5f), GetPercentile(FrameWorkTimesMs, 0.9f),
+                                 GetPercentile(FrameWorkTimesMs, 0.99f), GetPercentile(FrameWorkTimesMs, 1.f),
+                                 ReplicationMsPerFrame, TotalInBytesPerSecond, TotalOutBytesPerSecond);
+
+    FrameTimesMs.Reset();
+    FrameWorkTimesMs.Reset();
+}
+
+void ALoadTestRecorder::RefillBombs()
+{
+    for (TActorIterator<ACharacterV2> It(GetWorld()); It; ++It)
+    {
+        It->RefillBombs();
+    }
+}
+
+float ALoadTestRecorder::GetPercentile(TArray<float>& Samples, float Percentile)
+{
+    if (Samples.Num() == 0) return 0.f;
+
+    Samples.Sort();
+    const int32 Index = FMath::Clamp(FMath::CeilToInt(Percentile * Samples.Num()) - 1, 0, Samples.Num() - 1);
+    return Samples[Index];
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Console command
+
+static void StartLoadTest(const TArray<FString>& Args, UWorld* World)
+{
+    if (World->GetNetMode() == NM_Client)
+    {
+        UE_LOG(LogLoadTest, Warning, TEXT("tg.LoadTest.Start only runs on the server"));
+        return;
+    }
+
+    ALoadTestRecorder* Recorder = ALoadTestRecorder::Get(World);
+    if (Recorder == nullptr) return;
+
+    const float Duration = (Args.Num() > 0) ? FMath::Max(FCString::Atof(*Args[0]), 1.f) : 60.f;
+    const FString CsvBasePath = (Args.Num() > 1) ? Args[1] : FPaths::GameSavedDir() / TEXT("LoadTest") / TEXT("LoadTest");
+    const bool bExitWhenDone = (Args.Num() > 2) && Args[2] == TEXT("exit");
+
+    Recorder->StartRecording(Duration, CsvBasePath, bExitWhenDone);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs StartLoadTestCommand(
+    TEXT("tg.LoadTest.Start"),
+    TEXT("Records server frame times, bandwidth, RPC counts and replication time as CSV. Usage: tg.LoadTest.Start [Seconds] [CsvBasePath] [exit]"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&StartLoadTest));
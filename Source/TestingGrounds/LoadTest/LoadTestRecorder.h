@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "LoadTestRecorder.generated.h"
+
+/**
+ * Per-world recorder of server cost during a load test.
+ * Samples frame times, per-connection bandwidth, RPC counts and replication CPU time
+ * once per second and writes them as CSV when the run ends.
+ * Start it on the server with "tg.LoadTest.Start [Seconds] [CsvBasePath] [exit]".
+ */
+UCLASS()
+class TESTINGGROUNDS_API ALoadTestRecorder : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ALoadTestRecorder();
+
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    // Collects the samples of the frame and writes a row every second
+    virtual void Tick(float DeltaSeconds) override;
+
+    // Returns the recorder of the given world, spawning it if needed
+    static ALoadTestRecorder* Get(UWorld* World);
+
+    /**
+     * Starts a run of the given length. Writes CsvBasePath_frames.csv, _connections.csv and _rpcs.csv.
+     * @param bExitWhenDone	Shuts the process down once the files are written, so scripts can wait on it
+     */
+    void StartRecording(float Duration, const FString& CsvBasePath, bool bExitWhenDone);
+
+    // Writes the files of the current run and stops recording
+    void StopRecording();
+
+    bool IsRecording() const { return bIsRecording; }
+
+protected:
+    // Seconds between two CSV rows
+    UPROPERTY(EditAnywhere, Category = "LoadTest")
+    float SampleInterval = 1.f;
+
+    // Seconds between two bomb refills of every character, so the bots keep throwing
+    UPROPERTY(EditAnywhere, Category = "LoadTest")
+    float BombRefillInterval = 5.f;
+
+private:
+    // Called when the world starts ticking - the end of the max tick rate wait
+    void OnWorldTickStart(ELevelTick TickType, float DeltaSeconds);
+
+    // Called once the frame, network flush included, is done
+    void OnEndFrame();
+
+    // Appends the rows of the sample interval that just ended
+    void WriteSample();
+
+    // Gives every bomb character its bombs back
+    void RefillBombs();
+
+    // Returns the given percentile (0-1) of the samples. Sorts them
+    static float GetPercentile(TArray<float>& Samples, float Percentile);
+
+    FDelegateHandle WorldTickStartHandle;
+
+    FDelegateHandle EndFrameHandle;
+
+    bool bIsRecording = false;
+
+    bool bExitWhenDone = false;
+
+    FString CsvBasePath;
+
+    float TimeLeft = 0.f;
+
+    float RunTime = 0.f;
+
+    float TimeSinceSample = 0.f;
+
+    float TimeSinceBombRefill = 0.f;
+
+    // The moment the current frame started its work, 0 if we missed the start
+    double FrameWorkStartTime = 0.0;
+
+    // Samples of the current interval
+    TArray<float> FrameTimesMs;
+    TArray<float> FrameWorkTimesMs;
+
+    // Samples of the whole run, for the summary row
+    TArray<float> RunFrameTimesMs;
+    TArray<float> RunFrameWorkTimesMs;
+
+    FString FramesCsv;
+    FString ConnectionsCsv;
+    FString RpcsCsv;
+};
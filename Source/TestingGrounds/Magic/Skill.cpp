@@ -2,13 +2,15 @@
 
 #include "TestingGrounds.h"
 #include "Skill.h"
+#include "SkillPool.h"
+#include "../Weapons/PredictedFireComponent.h"
 
 
 // Sets default values
 ASkill::ASkill()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+    // Nothing to update per frame. Periodic updates go through the ATickAggregator
+	PrimaryActorTick.bCanEverTick = false;
     
     SphereComp = CreateDefaultSubobject<USphereComponent>(FName("SphereComp"));
     
@@ -25,6 +27,10 @@ ASkill::ASkill()
     ParticleComp = CreateDefaultSubobject<UParticleSystemComponent>(FName("ParticleComp"));
     ParticleComp->SetupAttachment(SphereComp);
     
+    // Skills fly fast and straight, but only players nearby can see them
+    ReplicationPolicy.CullDistance = 8000.f;
+    ReplicationPolicy.MaxUpdateFrequency = 30.f;
+    ReplicationPolicy.MinUpdateFrequency = 10.f;
 }
 
 // Called when the game starts or when spawned
@@ -34,11 +40,10 @@ void ASkill::BeginPlay()
 	
     SphereComp->OnComponentHit.AddDynamic(this, &ASkill::OnHit);
     
-    if (ProjectileFX)
-    {
-        ParticleComp->SetTemplate(ProjectileFX);
-        ParticleComp->Activate();
-    }
+    PlayEffect(ProjectileFX, false);
+    
+    // Skills spawned outside of a pool die after SkillLifeSpan seconds
+    if (!OwningPool.IsValid()) StartReleaseTimer(SkillLifeSpan);
 }
 
 void ASkill::OnConstruction(const FTransform& Transform)
@@ -46,35 +51,125 @@ void ASkill::OnConstruction(const FTransform& Transform)
     Super::OnConstruction(Transform);
     
     // Used in order to have a visual feedback in the editor when we
-    // assign a new particle
-    if (ProjectileFX)
+    // assign a new particle. The game loads it with the skills bundle instead
+    UWorld* World = GetWorld();
+    if (World && !World->IsGameWorld() && !ProjectileFX.IsNull())
+    {
+        ProjectileFX.ToStringReference().TryLoad();
+    }
+    PlayEffect(ProjectileFX, false);
+}
+
+void ASkill::GetEffectAssets(TArray<FStringAssetReference>& OutAssets) const
+{
+    OutAssets.Add(ProjectileFX.ToStringReference());
+    OutAssets.Add(ProjectileCollisionFX.ToStringReference());
+}
+
+void ASkill::PlayEffect(const TAssetPtr<UParticleSystem>& Effect, bool bReset)
+{
+    UParticleSystem* ParticleSystem = Effect.Get();
+    if (ParticleSystem)
     {
-        ParticleComp->SetTemplate(ProjectileFX);
-        ParticleComp->Activate();
+        ParticleComp->SetTemplate(ParticleSystem);
+        ParticleComp->Activate(bReset);
     }
 }
 
+void ASkill::PostInitializeComponents()
+{
+    Super::PostInitializeComponents();
+    
+    // Remember the traveling collision so we can restore it when leaving the pool
+    ActiveCollisionEnabled = SphereComp->GetCollisionEnabled();
+    
+    ReplicationPolicy.ApplyTo(this);
+}
+
 void ASkill::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
-    if (ProjectileCollisionFX)
+    // The skill may keep getting hit while it waits to be released
+    if (bHasHit) return;
+    bHasHit = true;
+    
+    // Hits on characters count where the caster saw them
+    APawn* Caster = Instigator;
+    if (OtherActor && OtherActor != Caster && Cast<ACharacter>(OtherActor) && Caster && Caster->IsLocallyControlled())
+    {
+        UPredictedFireComponent* FireComponent = Caster->FindComponentByClass<UPredictedFireComponent>();
+        if (FireComponent) FireComponent->ReportHit(OtherActor, Hit.ImpactPoint, ShotID, SkillType, HitDamage);
+    }
+    
+    // Activate the collision FX
+    PlayEffect(ProjectileCollisionFX, true);
+    
+    // Let the collision FX play out. Skills without collision FX used to linger forever,
+    // which would leak them out of the pool
+    StartReleaseTimer(DestroyDelay);
+}
+
+void ASkill::StartReleaseTimer(float Delay)
+{
+    AGameplayTimerService* Timers = AGameplayTimerService::Get(GetWorld());
+    if (Timers == nullptr) return;
+    
+    Timers->ClearTimer(ReleaseTimerHandle);
+    ReleaseTimerHandle = Timers->SetTimer(this, &ASkill::Release, Delay);
+}
+
+void ASkill::Release()
+{
+    if (OwningPool.IsValid())
     {
-        // Activate the collision FX and start the destroy timer
-        ParticleComp->SetTemplate(ProjectileCollisionFX);
-        ParticleComp->Activate(true);
-        
-        FTimerHandle TimerHandle;
-        FTimerDelegate TimerDel;
-        
-        TimerDel.BindLambda([&]()
-                            {
-                                Destroy();
-                            });
-        
-        GetWorld()->GetTimerManager().SetTimer(TimerHandle,
-                                               TimerDel,
-                                               DestroyDelay,
-                                               false);
+        OwningPool->ReleaseSkill(this);
     }
+    else
+    {
+        Destroy();
+    }
+}
+
+void ASkill::OnAcquiredFromPool(const FTransform& SpawnTransform)
+{
+    bInPool = false;
+    bHasHit = false;
+    
+    // Parked skills don't replicate, wake up before we move
+    if (GetIsReplicated()) SetNetDormancy(DORM_Awake);
+    
+    SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::TeleportPhysics);
+    SetActorHiddenInGame(false);
+    SphereComp->SetCollisionEnabled(ActiveCollisionEnabled);
+    
+    // Switch back from the collision FX to the traveling FX
+    PlayEffect(ProjectileFX, true);
+    
+    // The movement comp drops its updated component once it stops, so re-arm it
+    ProjectileMovementComp->SetUpdatedComponent(SphereComp);
+    ProjectileMovementComp->Velocity = GetActorForwardVector() * ProjectileMovementComp->InitialSpeed;
+    ProjectileMovementComp->UpdateComponentVelocity();
+    ProjectileMovementComp->SetComponentTickEnabled(true);
+    
+    // A skill that never hits anything still has to come back
+    StartReleaseTimer(SkillLifeSpan);
+}
+
+void ASkill::OnReturnedToPool()
+{
+    bInPool = true;
+    ShotID = 0;
+    
+    AGameplayTimerService* Timers = AGameplayTimerService::Get(GetWorld());
+    if (Timers) Timers->ClearTimer(ReleaseTimerHandle);
+    
+    ProjectileMovementComp->StopMovementImmediately();
+    ProjectileMovementComp->SetComponentTickEnabled(false);
+    SphereComp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    ParticleComp->Deactivate();
+    SetActorHiddenInGame(true);
+    
+    // Nothing changes while we're parked. The hidden state gets flushed before the channel closes
+    if (GetIsReplicated()) SetNetDormancy(DORM_DormantAll);
 }
 
 
@@ -3,14 +3,19 @@
 #pragma once
 
 #include "GameFramework/Actor.h"
+#include "../ReplicationPolicy.h"
+#include "../GameplayTimerService.h"
 #include "Skill.generated.h"
 
+class ASkillPool;
+
 UENUM(BlueprintType)
 enum class ESkillType : uint8
 {
     Sword,
     Fire,
-    Death
+    Death,
+    MAX UMETA(Hidden)
 };
 
 UCLASS()
@@ -31,18 +36,33 @@ public:
 	
     virtual void OnConstruction(const FTransform& Transform) override;
     
-    // Increases the level by one - clamps on max level
-    UFUNCTION(BlueprintCallable, Category = "TLSkillsTree")
-    void AdvanceLevel()
-        { CurrentLevel = (CurrentLevel + 1 > MaxLevel) ? 1 : ++CurrentLevel; }
-
-    // Resets the level of the skill - 0 means the player will not be able to cast
-	UFUNCTION(BlueprintCallable, Category = "TLSkillsTree")
-    void ResetLevel() { CurrentLevel = 0; }
+    virtual void PostInitializeComponents() override;
+    
+    // Returns the skill to its pool, or destroys it if it isn't pooled
+    void Release();
+    
+    // Marks this skill as owned by the given pool. Must be called before FinishSpawning
+    void SetOwningPool(ASkillPool* Pool) { OwningPool = Pool; }
+    
+    // Resets the skill to its traveling state and launches it along the transform's forward vector
+    void OnAcquiredFromPool(const FTransform& SpawnTransform);
+    
+    // Stops the skill, disables its collision and hides it
+    void OnReturnedToPool();
+    
+    // Returns true if the skill is parked in its pool
+    bool IsInPool() const { return bInPool; }
     
-    // Returns the level of the current skill
+    // Sets the ID the caster's hits with this instance get reported with
+    void SetShotID(uint8 InShotID) { ShotID = InShotID; }
+    
+    // Returns the highest level a player can advance this skill to.
+    // The per-player level lives in the USkillsComponent
     UFUNCTION(BlueprintCallable, Category = "TLSkillsTree")
-    int32 GetLevel() { return CurrentLevel; }
+    int32 GetMaxLevel() const { return MaxLevel; }
+    
+    // Returns the seconds a player has to wait between two casts of this skill
+    float GetCooldown() const { return Cooldown; }
     
     // Returns the skill's texture
     UFUNCTION(BlueprintCallable, Category = "TLSkillsTree")
@@ -51,13 +71,36 @@ public:
     // Returns the skill type
     ESkillType GetSkillType() { return SkillType; }
     
-    // Returns true if the level is maxed out
-    bool IsMaxLevel() { return CurrentLevel == MaxLevel; }
+    // Returns the damage a hit on a character deals
+    float GetHitDamage() const { return HitDamage; }
+    
+    // Returns the movement component the skill flies with
+    UProjectileMovementComponent* GetProjectileMovement() const { return ProjectileMovementComp; }
+    
+    // Adds the effects of the skill, for whoever preloads it
+    void GetEffectAssets(TArray<FStringAssetReference>& OutAssets) const;
     
 private:
-    int32 CurrentLevel = 1;
+    // The pool this skill returns to. Null for skills spawned outside of a pool
+    TWeakObjectPtr<ASkillPool> OwningPool;
     
-    int32 MaxLevel = 3;
+    // True while the skill is parked in its pool
+    bool bInPool = false;
+    
+    // True once the skill has hit something and is waiting to be released
+    bool bHasHit = false;
+    
+    // The ID of this cast instance at the caster's UPredictedFireComponent, 0 if it wasn't cast through it
+    uint8 ShotID = 0;
+    
+    // The collision the skill uses while traveling
+    TEnumAsByte<ECollisionEnabled::Type> ActiveCollisionEnabled;
+    
+    // Releases the skill once its lifespan runs out, or DestroyDelay seconds after a hit
+    FGameplayTimerHandle ReleaseTimerHandle;
+    
+    // Starts the release timer over
+    void StartReleaseTimer(float Delay);
     
 protected:
     
@@ -73,25 +116,48 @@ protected:
     UPROPERTY(VisibleAnywhere)
     UParticleSystemComponent* ParticleComp;
     
-    /*The particle system for our projectile when traveling*/
+    /*The particle system for our projectile when traveling, loaded with the skills bundle*/
     UPROPERTY(EditDefaultsOnly)
-    UParticleSystem* ProjectileFX;
+    TAssetPtr<UParticleSystem> ProjectileFX;
     
-    /*The particle system for our collision*/
+    /*The particle system for our collision, loaded with the skills bundle*/
     UPROPERTY(EditDefaultsOnly)
-    UParticleSystem* ProjectileCollisionFX;
+    TAssetPtr<UParticleSystem> ProjectileCollisionFX;
+    
+    // Switches the particle comp to the given effect, if it's loaded
+    void PlayEffect(const TAssetPtr<UParticleSystem>& Effect, bool bReset);
     
     /*The skill texture*/
     UPROPERTY(EditDefaultsOnly)
     UTexture* SkillTexture;
     
-    /*The time (after a collision has happened) that our skill will get destroyed*/
+    /*The time (after a collision has happened) that our skill will get destroyed or returned to its pool*/
     UPROPERTY(EditAnywhere)
     float DestroyDelay = 1.5f;
     
+    /*The time a skill that never hits flies before it gets destroyed or returned to its pool*/
+    UPROPERTY(EditDefaultsOnly)
+    float SkillLifeSpan = 3.f;
+    
+    /*The damage a hit on a character deals*/
+    UPROPERTY(EditDefaultsOnly)
+    float HitDamage = 20.f;
+    
     /*The skill type of the skill*/
     UPROPERTY(EditDefaultsOnly)
     ESkillType SkillType;
+    
+    /*The highest level a player can advance this skill to*/
+    UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "1", ClampMax = "255"))
+    int32 MaxLevel = 3;
+    
+    /*The seconds a player has to wait between two casts*/
+    UPROPERTY(EditDefaultsOnly)
+    float Cooldown = 0.f;
+    
+    /*Relevancy and update frequency of the skill, if its blueprint replicates*/
+    UPROPERTY(EditDefaultsOnly)
+    FReplicationPolicy ReplicationPolicy;
 };
 
 
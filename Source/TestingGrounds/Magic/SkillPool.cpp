@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "SkillPool.h"
+#include "Skill.h"
+#include "../WorldManager.h"
+
+
+ASkillPool* ASkillPool::Get(UWorld* World)
+{
+    return GetWorldManager<ASkillPool>(World);
+}
+
+ASkill* ASkillPool::AcquireSkill(TSubclassOf<ASkill> SkillClass, const FTransform& SpawnTransform)
+{
+    ASkill* Skill = Cast<ASkill>(AcquireActor(SkillClass));
+    if (Skill) Skill->OnAcquiredFromPool(SpawnTransform);
+    return Skill;
+}
+
+void ASkillPool::ReleaseSkill(ASkill* Skill)
+{
+    if (Skill == nullptr || Skill->IsInPool()) return;
+
+    ReleaseActor(Skill);
+}
+
+void ASkillPool::InitPooledActor(AActor* Actor)
+{
+    CastChecked<ASkill>(Actor)->SetOwningPool(this);
+}
+
+void ASkillPool::ParkPooledActor(AActor* Actor)
+{
+    CastChecked<ASkill>(Actor)->OnReturnedToPool();
+}
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "../ActorPool.h"
+#include "SkillPool.generated.h"
+
+class ASkill;
+
+/**
+ * Per-world recycler of ASkill instances, keyed by skill class.
+ * A multi-projectile cast takes its skills from here and every skill comes back DestroyDelay
+ * seconds after it hit something, or once its lifespan runs out, so spell spam doesn't construct new actors on every cast.
+ */
+UCLASS()
+class TESTINGGROUNDS_API ASkillPool : public AActorPool
+{
+	GENERATED_BODY()
+
+public:
+    // Returns the recycler of the given world, spawning it if needed
+    static ASkillPool* Get(UWorld* World);
+
+    // Makes sure at least Count skills of the given class exist in the pool
+    void Prewarm(TSubclassOf<ASkill> SkillClass, int32 Count) { PrewarmActors(SkillClass, Count); }
+
+    /**
+     * Hands out a skill placed at the given transform and launched along its forward vector.
+     * Spawns a new one (and counts an overflow) if every pooled skill is in use.
+     */
+    ASkill* AcquireSkill(TSubclassOf<ASkill> SkillClass, const FTransform& SpawnTransform);
+
+    // Parks the skill until it gets handed out again
+    void ReleaseSkill(ASkill* Skill);
+
+protected:
+    virtual void InitPooledActor(AActor* Actor) override;
+
+    virtual void ParkPooledActor(AActor* Actor) override;
+};
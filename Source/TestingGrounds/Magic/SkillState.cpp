@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "SkillState.h"
+
+void FSkillState::PostReplicatedAdd(const FSkillStateArray& InArraySerializer)
+{
+    InArraySerializer.InvalidateIndex();
+}
+
+void FSkillState::PreReplicatedRemove(const FSkillStateArray& InArraySerializer)
+{
+    InArraySerializer.InvalidateIndex();
+}
+
+FSkillState* FSkillStateArray::Find(ESkillType SkillType)
+{
+    return const_cast<FSkillState*>(static_cast<const FSkillStateArray*>(this)->Find(SkillType));
+}
+
+const FSkillState* FSkillStateArray::Find(ESkillType SkillType) const
+{
+    if (SkillType >= ESkillType::MAX) return nullptr;
+
+    if (bIndexDirty) RebuildIndex();
+
+    const int32 Index = TypeToIndex[(int32)SkillType];
+    return Items.IsValidIndex(Index) ? &Items[Index] : nullptr;
+}
+
+FSkillState& FSkillStateArray::FindOrAdd(ESkillType SkillType)
+{
+    FSkillState* Existing = Find(SkillType);
+    if (Existing) return *Existing;
+
+    FSkillState& NewState = Items[Items.AddDefaulted()];
+    NewState.SkillType = SkillType;
+    MarkItemDirty(NewState);
+    InvalidateIndex();
+    return NewState;
+}
+
+void FSkillStateArray::RebuildIndex() const
+{
+    for (int32& Index : TypeToIndex) Index = INDEX_NONE;
+
+    for (int32 i = 0; i < Items.Num(); i++)
+    {
+        if (Items[i].SkillType < ESkillType::MAX) TypeToIndex[(int32)Items[i].SkillType] = i;
+    }
+    bIndexDirty = false;
+}
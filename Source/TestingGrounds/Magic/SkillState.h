@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Engine/NetSerialization.h"
+#include "Skill.h"
+#include "SkillState.generated.h"
+
+// The per-player state of a single skill
+USTRUCT()
+struct FSkillState : public FFastArraySerializerItem
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    ESkillType SkillType = ESkillType::Sword;
+
+    // 0 means the player will not be able to cast
+    UPROPERTY()
+    uint8 Level = 0;
+
+    UPROPERTY()
+    uint8 MaxLevel = 0;
+
+    // Server world time at which the skill can be cast again
+    UPROPERTY()
+    float CooldownEndTime = 0.f;
+
+    // Called on clients when the skill arrives
+    void PostReplicatedAdd(const struct FSkillStateArray& InArraySerializer);
+
+    // Called on clients before the skill gets removed
+    void PreReplicatedRemove(const struct FSkillStateArray& InArraySerializer);
+};
+
+/**
+ * The skill states of a player, indexed by skill type.
+ * Replicated with fast array delta serialization, so a level-up only sends the skill that changed.
+ */
+USTRUCT()
+struct FSkillStateArray : public FFastArraySerializer
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    TArray<FSkillState> Items;
+
+    // Returns the state of the given skill type, nullptr if the player doesn't have it
+    FSkillState* Find(ESkillType SkillType);
+    const FSkillState* Find(ESkillType SkillType) const;
+
+    // Adds a state for the given skill type, or returns the existing one
+    FSkillState& FindOrAdd(ESkillType SkillType);
+
+    // Rebuilds the type lookup on the next Find - the item order isn't guaranteed on clients
+    void InvalidateIndex() const { bIndexDirty = true; }
+
+    bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+    {
+        return FFastArraySerializer::FastArrayDeltaSerialize<FSkillState, FSkillStateArray>(Items, DeltaParms, *this);
+    }
+
+private:
+    void RebuildIndex() const;
+
+    // The index in Items of every skill type, INDEX_NONE if the player doesn't have it
+    mutable int32 TypeToIndex[(int32)ESkillType::MAX];
+
+    mutable bool bIndexDirty = true;
+};
+
+template<>
+struct TStructOpsTypeTraits<FSkillStateArray> : public TStructOpsTypeTraitsBase
+{
+    enum
+    {
+        WithNetDeltaSerializer = true,
+    };
+};
@@ -2,18 +2,23 @@
 
 #include "TestingGrounds.h"
 #include "SkillsComponent.h"
-
+#include "SkillPool.h"
+#include "../LoadTest/LoadTestNetDriver.h"
+#include "../TestingGroundsStats.h"
+#include "../AssetPreloader.h"
+#include "GameFramework/GameState.h"
 
 
 // Sets default values for this component's properties
 USkillsComponent::USkillsComponent()
 {
-	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
-	// off to improve performance if you don't need them.
+	// Set this component to be initialized when the game starts.
+	// It has nothing to update per frame, so it doesn't tick
 	bWantsBeginPlay = true;
-	PrimaryComponentTick.bCanEverTick = true;
-
-	// ...
+	PrimaryComponentTick.bCanEverTick = false;
+    
+    // Every player owns its skill tree, the server replicates it to the owner
+    bReplicates = true;
 }
 
 
@@ -22,63 +27,274 @@ void USkillsComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// Resetting the level of each skill
-    for (auto Skill : SkillsArray) Skill->GetDefaultObject<ASkill>()->ResetLevel();
+    SkillDefaultsByType.Init(nullptr, (int32)ESkillType::MAX);
     
-    AvailableSkillPoints = InitialAvailableSkillsPoints;
-	
+    // The skills are usable once their classes are loaded
+    TArray<FStringAssetReference> SkillAssets;
+    for (const auto& Skill : SkillsArray) SkillAssets.Add(Skill.ToStringReference());
+    
+    AAssetPreloader* Preloader = AAssetPreloader::Get(GetWorld());
+    if (Preloader)
+    {
+        Preloader->RequestAssets(EAssetBundle::Skills, SkillAssets, FSimpleDelegate::CreateUObject(this, &USkillsComponent::OnSkillsLoaded));
+    }
+}
+
+void USkillsComponent::OnSkillsLoaded()
+{
+    if (IsPendingKill()) return;
+    
+    // Direct lookup of the skill defaults by type, built on every machine
+    TArray<FStringAssetReference> EffectAssets;
+    for (const auto& Skill : SkillsArray)
+    {
+        ASkill* SkillDefaults = Skill.Get() ? Skill.Get()->GetDefaultObject<ASkill>() : nullptr;
+        if (SkillDefaults) SkillDefaults->GetEffectAssets(EffectAssets);
+        if (SkillDefaults && SkillDefaults->GetSkillType() < ESkillType::MAX)
+        {
+            SkillDefaultsByType[(int32)SkillDefaults->GetSkillType()] = SkillDefaults;
+        }
+    }
+    
+    // The server owns the state, clients receive it through replication
+    if (GetOwnerRole() == ROLE_Authority)
+    {
+        ResetSkillPointsLocal();
+    }
+    
+    // Pre-spawn our skills so casting doesn't construct new actors
+    ASkillPool* SkillPool = ASkillPool::Get(GetWorld());
+    if (SkillPool)
+    {
+        for (const auto& Skill : SkillsArray) SkillPool->Prewarm(Skill.Get(), SkillPoolSize);
+    }
+    
+    // The effects only matter by the time someone casts
+    AAssetPreloader* Preloader = AAssetPreloader::Get(GetWorld());
+    if (Preloader)
+    {
+        Preloader->RequestAssets(EAssetBundle::Skills, EffectAssets);
+    }
+}
+
+void USkillsComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+    
+    // Nobody but the owner needs to know our skill tree
+    DOREPLIFETIME_CONDITION(USkillsComponent, AvailableSkillPoints, COND_OwnerOnly);
+    DOREPLIFETIME_CONDITION(USkillsComponent, SkillStates, COND_OwnerOnly);
 }
 
 
 UTexture* USkillsComponent::GetSkillTexture(int32 SkillNum)
 {
-    if (SkillsArray.IsValidIndex(SkillNum))
+    if (SkillsArray.IsValidIndex(SkillNum) && SkillsArray[SkillNum].Get())
     {
-        return SkillsArray[SkillNum]->GetDefaultObject<ASkill>()->GetSkillTexture();
+        return SkillsArray[SkillNum].Get()->GetDefaultObject<ASkill>()->GetSkillTexture();
     }
     return nullptr;
 }
 
 int32 USkillsComponent::GetSkillLevel(int32 SkillNum)
 {
-    if (SkillsArray.IsValidIndex(SkillNum))
+    if (SkillsArray.IsValidIndex(SkillNum) && SkillsArray[SkillNum].Get())
     {
-        return SkillsArray[SkillNum]->GetDefaultObject<ASkill>()->GetLevel();
+        return GetSkillLevelByType(SkillsArray[SkillNum].Get()->GetDefaultObject<ASkill>()->GetSkillType());
     }
     return 0;
 }
 
 ASkill* USkillsComponent::GetSkillByType(ESkillType SkillType)
 {
-    for (auto It : SkillsArray)
+    return SkillDefaultsByType.IsValidIndex((int32)SkillType) ? SkillDefaultsByType[(int32)SkillType] : nullptr;
+}
+
+int32 USkillsComponent::GetSkillLevelByType(ESkillType SkillType) const
+{
+    const FSkillLevelPrediction* Prediction = FindSkillLevelPrediction(SkillType);
+    if (Prediction) return Prediction->Level;
+    
+    const FSkillState* State = SkillStates.Find(SkillType);
+    return State ? State->Level : 0;
+}
+
+bool USkillsComponent::IsSkillReady(ESkillType SkillType) const
+{
+    TG_SCOPE_CYCLE_COUNTER(Skills);
+    
+    const FSkillState* State = SkillStates.Find(SkillType);
+    return State && GetSkillLevelByType(SkillType) > 0 && GetServerWorldTime() >= State->CooldownEndTime;
+}
+
+void USkillsComponent::CommitSkillCooldown(ESkillType SkillType)
+{
+    TG_SCOPE_CYCLE_COUNTER(Skills);
+    
+    FSkillState* State = SkillStates.Find(SkillType);
+    ASkill* SkillDefaults = GetSkillByType(SkillType);
+    if (State && SkillDefaults && SkillDefaults->GetCooldown() > 0.f)
     {
-        ASkill* Skill = It->GetDefaultObject<ASkill>();
-        if (Skill->GetSkillType() == SkillType) return Skill;
+        State->CooldownEndTime = GetServerWorldTime() + SkillDefaults->GetCooldown();
+        SkillStates.MarkItemDirty(*State);
     }
-    return nullptr;
+}
+
+float USkillsComponent::GetServerWorldTime() const
+{
+    UWorld* World = GetWorld();
+    if (World == nullptr) return 0.f;
+    
+    return World->GameState ? World->GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
 }
 
 int32 USkillsComponent::AdvanceSkillLevel(ASkill* SkillToLevelUp)
 {
-    if (SkillToLevelUp && AvailableSkillPoints > 0 && !SkillToLevelUp->IsMaxLevel())
+    if (SkillToLevelUp == nullptr) return 0;
+    
+    const ESkillType SkillType = SkillToLevelUp->GetSkillType();
+    
+    // Clients predict the level-up apart from the replicated state, the server's answer replaces the prediction
+    if (GetOwnerRole() < ROLE_Authority)
     {
-        AvailableSkillPoints--;
-        SkillToLevelUp->AdvanceLevel();
-        return SkillToLevelUp->GetLevel();
+        if (PredictSkillLevel(SkillType)) ServerAdvanceSkillLevel(SkillType);
     }
-    else if (SkillToLevelUp) return SkillToLevelUp->GetLevel();
-    else return 0;
+    else
+    {
+        AdvanceSkillLevelLocal(SkillType);
+    }
+    
+    return GetSkillLevelByType(SkillType);
 }
 
 void USkillsComponent::ResetSkillPoints()
 {
+    // Clients wait for the server's state, which replaces every prediction
+    if (GetOwnerRole() < ROLE_Authority)
+    {
+        SkillLevelPredictions.Empty();
+        ServerResetSkillPoints();
+        return;
+    }
+    ResetSkillPointsLocal();
+}
+
+void USkillsComponent::AdvanceSkillLevelLocal(ESkillType SkillType)
+{
+    TG_SCOPE_CYCLE_COUNTER(Skills);
+    
+    FSkillState* State = SkillStates.Find(SkillType);
+    if (State && AvailableSkillPoints > 0 && State->Level < State->MaxLevel)
+    {
+        AvailableSkillPoints--;
+        State->Level++;
+        SkillStates.MarkItemDirty(*State);
+    }
+}
+
+bool USkillsComponent::PredictSkillLevel(ESkillType SkillType)
+{
+    const FSkillState* State = SkillStates.Find(SkillType);
+    if (State == nullptr) return false;
+    
+    // The points of the level-ups still on their way are spent already
+    int32 PredictedSkillPoints = AvailableSkillPoints;
+    for (const FSkillLevelPrediction& Prediction : SkillLevelPredictions) PredictedSkillPoints -= Prediction.PendingRequests;
+    
+    const int32 Level = GetSkillLevelByType(SkillType);
+    if (PredictedSkillPoints <= 0 || Level >= State->MaxLevel) return false;
+    
+    FSkillLevelPrediction* Prediction = SkillLevelPredictions.FindByPredicate([SkillType](const FSkillLevelPrediction& Other) { return Other.SkillType == SkillType; });
+    if (Prediction == nullptr)
+    {
+        Prediction = &SkillLevelPredictions[SkillLevelPredictions.AddZeroed()];
+        Prediction->SkillType = SkillType;
+    }
+    Prediction->Level = (uint8)(Level + 1);
+    Prediction->PendingRequests++;
+    return true;
+}
+
+const FSkillLevelPrediction* USkillsComponent::FindSkillLevelPrediction(ESkillType SkillType) const
+{
+    return SkillLevelPredictions.FindByPredicate([SkillType](const FSkillLevelPrediction& Prediction) { return Prediction.SkillType == SkillType; });
+}
+
+void USkillsComponent::OnRep_SkillStates()
+{
+    // Anything the server answered is in the state that arrived after the answer
+    SkillLevelPredictions.RemoveAll([](const FSkillLevelPrediction& Prediction) { return Prediction.PendingRequests <= 0; });
+}
+
+void USkillsComponent::ResetSkillPointsLocal()
+{
+    TG_SCOPE_CYCLE_COUNTER(Skills);
+    
     AvailableSkillPoints = InitialAvailableSkillsPoints;
-    for (auto It : SkillsArray)
+    
+    // Unlearn every skill - level 0 means the player will not be able to cast
+    for (ASkill* SkillDefaults : SkillDefaultsByType)
     {
-        It->GetDefaultObject<ASkill>()->ResetLevel();
+        if (SkillDefaults == nullptr) continue;
+        
+        FSkillState& State = SkillStates.FindOrAdd(SkillDefaults->GetSkillType());
+        State.Level = 0;
+        State.MaxLevel = (uint8)FMath::Clamp(SkillDefaults->GetMaxLevel(), 1, 255);
+        State.CooldownEndTime = 0.f;
+        SkillStates.MarkItemDirty(State);
     }
 }
 
+void USkillsComponent::ServerAdvanceSkillLevel_Implementation(ESkillType SkillType)
+{
+    ULoadTestNetDriver::CountReceivedRPC(GetOwner(), FName("ServerAdvanceSkillLevel"));
+    
+    AdvanceSkillLevelLocal(SkillType);
+    
+    // Accepted or not, the client learns the level it should show
+    ClientAckSkillLevel(SkillType, (uint8)GetSkillLevelByType(SkillType));
+}
+
+bool USkillsComponent::ServerAdvanceSkillLevel_Validate(ESkillType SkillType)
+{
+    return SkillType < ESkillType::MAX;
+}
 
+void USkillsComponent::ClientAckSkillLevel_Implementation(ESkillType SkillType, uint8 Level)
+{
+    FSkillLevelPrediction* Prediction = SkillLevelPredictions.FindByPredicate([SkillType](const FSkillLevelPrediction& Other) { return Other.SkillType == SkillType; });
+    if (Prediction == nullptr) return;
+    
+    // Later level-ups of the same skill are still on their way
+    Prediction->PendingRequests--;
+    if (Prediction->PendingRequests > 0) return;
+    
+    // Show the server's level until its state arrives, unless it's here already
+    const FSkillState* State = SkillStates.Find(SkillType);
+    if (State && State->Level == Level)
+    {
+        SkillLevelPredictions.RemoveAll([SkillType](const FSkillLevelPrediction& Other) { return Other.SkillType == SkillType; });
+    }
+    else
+    {
+        Prediction->Level = Level;
+    }
+}
 
+void USkillsComponent::ServerResetSkillPoints_Implementation()
+{
+    ULoadTestNetDriver::CountReceivedRPC(GetOwner(), FName("ServerResetSkillPoints"));
+    
+    // Every reset resends the whole skill tree, a client can't ask for them back to back
+    const float Now = GetServerWorldTime();
+    if (Now - LastResetRequestTime < MinResetInterval) return;
+    LastResetRequestTime = Now;
+    
+    ResetSkillPointsLocal();
+}
 
+bool USkillsComponent::ServerResetSkillPoints_Validate()
+{
+    // Only the skill tree of the player asking can be reset, and resets are rate limited above
+    return GetOwner() != nullptr;
+}
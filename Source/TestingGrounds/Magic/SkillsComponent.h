@@ -3,10 +3,21 @@
 #pragma once
 
 #include "Components/ActorComponent.h"
-// TODO: Remove this later and make a separate class to hold the spell type enum class
-#include "Skill.h"
+#include "SkillState.h"
 #include "SkillsComponent.generated.h"
 
+// A level-up the owning client shows before the server confirms it.
+// Kept apart from the replicated skill states, so a rejected level-up doesn't stick
+struct FSkillLevelPrediction
+{
+    ESkillType SkillType;
+    
+    // The level shown until the server's state arrives
+    uint8 Level;
+    
+    // Level-ups the server hasn't answered yet
+    int32 PendingRequests;
+};
 
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class TESTINGGROUNDS_API USkillsComponent : public UActorComponent
@@ -20,25 +31,78 @@ public:
 	// Called when the game starts
 	virtual void BeginPlay() override;
 	
-    // An array which contains all the available skills
+    // Marks the properties we wish to replicate
+    virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+    
+    // An array which contains all the available skills, loaded with the skills bundle
     UPROPERTY(EditAnywhere)
-    TArray<TSubclassOf<ASkill>> SkillsArray;
+    TArray<TAssetSubclassOf<ASkill>> SkillsArray;
     
     // Returns the texture of the given skill's index (searches SkillsArray)
     UFUNCTION(BlueprintCallable, Category = "TLSkillsTree")
     UTexture* GetSkillTexture(int32 SkillNum);
     
+    // Returns the level of the given skill's index (searches SkillsArray)
     UFUNCTION(BlueprintCallable, Category = "TLSkillsTree")
     int32 GetSkillLevel(int32 SkillNum);
     
-    // Returns the first matching skill from SkillsArray
+    // Returns the default object of the skill with the given type
     UFUNCTION(BlueprintCallable, Category = "TLSkillsTree")
     ASkill* GetSkillByType(ESkillType SkillType);
     
+    // Returns the level of the skill with the given type - 0 if the player can't cast it
+    UFUNCTION(BlueprintCallable, Category = "TLSkillsTree")
+    int32 GetSkillLevelByType(ESkillType SkillType) const;
+    
+    // Returns true if the skill has been learned and isn't cooling down
+    UFUNCTION(BlueprintCallable, Category = "TLSkillsTree")
+    bool IsSkillReady(ESkillType SkillType) const;
+    
+    // Starts the cooldown of the skill. Call this when the skill gets cast
+    void CommitSkillCooldown(ESkillType SkillType);
+    
 private:
     // The Available Skill Points which can be spent in total
+    UPROPERTY(Replicated)
     int32 AvailableSkillPoints;
     
+    // The level, max level and cooldown of every skill of this player, indexed by skill type.
+    // Only the server writes it, the owning client shows its predictions on top
+    UPROPERTY(ReplicatedUsing = OnRep_SkillStates)
+    FSkillStateArray SkillStates;
+    
+    // The level-ups the owning client predicted, dropped once the server's state comes in
+    TArray<FSkillLevelPrediction> SkillLevelPredictions;
+    
+    // Server world time of the last skill reset a client asked for
+    float LastResetRequestTime = -MAX_flt;
+    
+    // The default object of every skill in SkillsArray, indexed by skill type
+    UPROPERTY(Transient)
+    TArray<ASkill*> SkillDefaultsByType;
+    
+    // Returns the world time of the server, so cooldowns agree on every machine
+    float GetServerWorldTime() const;
+    
+    // Levels up the skill on the server
+    void AdvanceSkillLevelLocal(ESkillType SkillType);
+    
+    // Shows the level-up on the owning client until the server answers. Returns false if it can't happen
+    bool PredictSkillLevel(ESkillType SkillType);
+    
+    // Returns the prediction of the given skill, nullptr if the client shows the replicated state
+    const FSkillLevelPrediction* FindSkillLevelPrediction(ESkillType SkillType) const;
+    
+    // Drops the predictions the server has answered, the replicated state covers them now
+    UFUNCTION()
+    void OnRep_SkillStates();
+    
+    // Resets the skill points on this machine
+    void ResetSkillPointsLocal();
+    
+    // Builds the skill lookups and prewarms the pool once the skill classes are in
+    void OnSkillsLoaded();
+    
 public:
     
     // Returns the new level of the skill
@@ -49,11 +113,42 @@ public:
     UFUNCTION(BlueprintCallable, Category = "TLSkillsTree")
     void ResetSkillPoints();
     
+private:
+    /** Levels up the skill on the server. Clients predict the change locally */
+    UFUNCTION(Server, Reliable, WithValidation)
+    void ServerAdvanceSkillLevel(ESkillType SkillType);
+    
+    void ServerAdvanceSkillLevel_Implementation(ESkillType SkillType);
+    
+    bool ServerAdvanceSkillLevel_Validate(ESkillType SkillType);
+    
+    /** Tells the owning client the level of the skill after its level-up, whether the server accepted it or not */
+    UFUNCTION(Client, Reliable)
+    void ClientAckSkillLevel(ESkillType SkillType, uint8 Level);
+    
+    void ClientAckSkillLevel_Implementation(ESkillType SkillType, uint8 Level);
+    
+    /** Resets the skill points on the server. Rate limited by MinResetInterval */
+    UFUNCTION(Server, Reliable, WithValidation)
+    void ServerResetSkillPoints();
+    
+    void ServerResetSkillPoints_Implementation();
+    
+    bool ServerResetSkillPoints_Validate();
+    
 protected:
     
     // The amount of available skill points when starting the game
     UPROPERTY(EditDefaultsOnly)
     int32 InitialAvailableSkillsPoints;
+    
+    // The least time in seconds between two skill resets a client asks for, the ones in between are ignored
+    UPROPERTY(EditDefaultsOnly)
+    float MinResetInterval = 1.f;
+    
+    // The number of instances of each skill pre-spawned into the world's skill pool
+    UPROPERTY(EditDefaultsOnly)
+    int32 SkillPoolSize = 6;
 		
 	
 };
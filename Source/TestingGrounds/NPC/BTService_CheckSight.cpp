@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "BTService_CheckSight.h"
+#include "AIController.h"
+#include "SightQueryService.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/BlackboardData.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+
+
+UBTService_CheckSight::UBTService_CheckSight()
+{
+    NodeName = "Check Sight";
+
+    // Sight doesn't need to be fresher than this, the service caches results in between
+    Interval = 0.2f;
+    RandomDeviation = 0.05f;
+
+    TargetKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTService_CheckSight, TargetKey), AActor::StaticClass());
+    CanSeeTargetKey.AddBoolFilter(this, GET_MEMBER_NAME_CHECKED(UBTService_CheckSight, CanSeeTargetKey));
+    LastKnownLocationKey.AddVectorFilter(this, GET_MEMBER_NAME_CHECKED(UBTService_CheckSight, LastKnownLocationKey));
+}
+
+void UBTService_CheckSight::InitializeFromAsset(UBehaviorTree& Asset)
+{
+    Super::InitializeFromAsset(Asset);
+
+    UBlackboardData* BlackboardAsset = GetBlackboardAsset();
+    if (BlackboardAsset)
+    {
+        TargetKey.ResolveSelectedKey(*BlackboardAsset);
+        CanSeeTargetKey.ResolveSelectedKey(*BlackboardAsset);
+        LastKnownLocationKey.ResolveSelectedKey(*BlackboardAsset);
+    }
+}
+
+void UBTService_CheckSight::TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+    Super::TickNode(OwnerComp, NodeMemory, DeltaSeconds);
+
+    UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
+    APawn* Guard = OwnerComp.GetAIOwner() ? OwnerComp.GetAIOwner()->GetPawn() : nullptr;
+    ASightQueryService* SightService = ASightQueryService::Get(OwnerComp.GetWorld());
+    if (BlackboardComp == nullptr || Guard == nullptr || SightService == nullptr) return;
+
+    AActor* Target = Cast<AActor>(BlackboardComp->GetValue<UBlackboardKeyType_Object>(TargetKey.GetSelectedKeyID()));
+    if (Target == nullptr) return;
+
+    FSightListener Listener;
+    Listener.Blackboard = BlackboardComp;
+    Listener.VisibleKey = CanSeeTargetKey.GetSelectedKeyID();
+    Listener.LocationKey = LastKnownLocationKey.IsSet() ? LastKnownLocationKey.GetSelectedKeyID() : FBlackboard::InvalidKey;
+
+    SightService->RequestSight(Guard, Target, Listener, MaxResultAge);
+}
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "BehaviorTree/BTService.h"
+#include "BTService_CheckSight.generated.h"
+
+/**
+ * Keeps the guard's sight of its target up to date for the Suspicion and Chase branches.
+ * The check goes through the world's ASightQueryService, so it never traces on the spot.
+ */
+UCLASS()
+class TESTINGGROUNDS_API UBTService_CheckSight : public UBTService
+{
+	GENERATED_BODY()
+
+public:
+    UBTService_CheckSight();
+
+    // Resolves the blackboard keys once per tree asset
+    virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+
+protected:
+    virtual void TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+
+    // The actor the guard tries to see
+    UPROPERTY(EditAnywhere, Category = "Blackboard")
+    struct FBlackboardKeySelector TargetKey;
+
+    // Bool, set to whether the guard sees the target
+    UPROPERTY(EditAnywhere, Category = "Blackboard")
+    struct FBlackboardKeySelector CanSeeTargetKey;
+
+    // Optional vector, set to the target's location while the guard sees it
+    UPROPERTY(EditAnywhere, Category = "Blackboard")
+    struct FBlackboardKeySelector LastKnownLocationKey;
+
+    // How old, in seconds, a sight result may be before it gets traced again
+    UPROPERTY(EditAnywhere, Category = "Sight")
+    float MaxResultAge = 0.2f;
+};
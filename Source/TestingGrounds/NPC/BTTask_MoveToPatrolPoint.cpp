@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "BTTask_MoveToPatrolPoint.h"
+#include "AIController.h"
+#include "BrainComponent.h"
+#include "PatrolRoute.h"
+#include "PatrolPathCache.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/BlackboardData.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Int.h"
+
+
+UBTTask_MoveToPatrolPoint::UBTTask_MoveToPatrolPoint()
+{
+    NodeName = "Move To Patrol Point";
+
+    IndexKey.AddIntFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_MoveToPatrolPoint, IndexKey));
+}
+
+void UBTTask_MoveToPatrolPoint::InitializeFromAsset(UBehaviorTree& Asset)
+{
+    Super::InitializeFromAsset(Asset);
+
+    UBlackboardData* BlackboardAsset = GetBlackboardAsset();
+    if (BlackboardAsset)
+    {
+        IndexKey.ResolveSelectedKey(*BlackboardAsset);
+    }
+}
+
+EBTNodeResult::Type UBTTask_MoveToPatrolPoint::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+    AAIController* AIController = OwnerComp.GetAIOwner();
+    APawn* Guard = AIController ? AIController->GetPawn() : nullptr;
+    UPatrolRoute* PatrolRoute = Guard ? Guard->FindComponentByClass<UPatrolRoute>() : nullptr;
+    if (PatrolRoute == nullptr) { return EBTNodeResult::Failed; }
+
+    // The locations are filled when the route begins play, which may come after the tree starts
+    const TArray<FVector>& PatrolLocations = PatrolRoute->GetPatrolLocations();
+    const int32 NumPatrolPoints = PatrolLocations.Num();
+    if (NumPatrolPoints == 0) { return EBTNodeResult::Failed; }
+
+    // The index was cycled when the waypoint was chosen, so the leg ends one point before it
+    const int32 Index = FMath::Abs(OwnerComp.GetBlackboardComponent()->GetValue<UBlackboardKeyType_Int>(IndexKey.GetSelectedKeyID()));
+    const int32 ToIndex = (Index + NumPatrolPoints - 1) % NumPatrolPoints;
+    const int32 FromIndex = (ToIndex + NumPatrolPoints - 1) % NumPatrolPoints;
+    const FVector Destination = PatrolLocations[ToIndex];
+
+    FAIMoveRequest MoveRequest(Destination);
+    MoveRequest.SetAcceptanceRadius(AcceptanceRadius);
+
+    FAIRequestID RequestID;
+    APatrolPathCache* PathCache = APatrolPathCache::Get(Guard->GetWorld());
+    FNavPathSharedPtr Path = PathCache ? PathCache->FindLegPath(PatrolRoute, FromIndex, ToIndex, Guard->GetNavAgentLocation()) : nullptr;
+    if (Path.IsValid())
+    {
+        RequestID = AIController->RequestMove(MoveRequest, Path);
+    }
+    else
+    {
+        // Finds its own path
+        const EPathFollowingRequestResult::Type Result = AIController->MoveTo(MoveRequest);
+        if (Result == EPathFollowingRequestResult::AlreadyAtGoal) { return EBTNodeResult::Succeeded; }
+        if (Result == EPathFollowingRequestResult::RequestSuccessful) RequestID = AIController->GetCurrentMoveRequestID();
+    }
+
+    if (!RequestID.IsValid()) { return EBTNodeResult::Failed; }
+
+    // Path following tells the brain when the move ends
+    WaitForMessage(OwnerComp, UBrainComponent::AIMessage_MoveFinished, RequestID);
+    return EBTNodeResult::InProgress;
+}
+
+EBTNodeResult::Type UBTTask_MoveToPatrolPoint::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+    AAIController* AIController = OwnerComp.GetAIOwner();
+    if (AIController) AIController->StopMovement();
+
+    return Super::AbortTask(OwnerComp, NodeMemory);
+}
@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "BehaviorTree/BTTaskNode.h"
+#include "BTTask_MoveToPatrolPoint.generated.h"
+
+/**
+ * Walks the guard to the waypoint UChooseNextWaypoint picked last, along the leg cached by APatrolPathCache.
+ * Falls back to a regular move while the leg isn't cached or the guard is off its route.
+ */
+UCLASS()
+class TESTINGGROUNDS_API UBTTask_MoveToPatrolPoint : public UBTTaskNode
+{
+	GENERATED_BODY()
+
+public:
+    UBTTask_MoveToPatrolPoint();
+
+    // Resolves the blackboard key once per tree asset
+    virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+
+    virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+    virtual EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+protected:
+    // The same index key as UChooseNextWaypoint's, which already points past the waypoint to walk to
+    UPROPERTY(EditAnywhere, Category = "Blackboard")
+    struct FBlackboardKeySelector IndexKey;
+
+    UPROPERTY(EditAnywhere, Category = "Node")
+    float AcceptanceRadius = 50.f;
+};
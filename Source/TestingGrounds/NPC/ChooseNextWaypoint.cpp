@@ -4,20 +4,50 @@
 #include "ChooseNextWaypoint.h"
 #include "AIController.h"
 #include "PatrolRoute.h"
+#include "../TestingGroundsStats.h"
 #include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/BlackboardData.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Int.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Vector.h"
 
 
+void UChooseNextWaypoint::InitializeFromAsset(UBehaviorTree& Asset)
+{
+    Super::InitializeFromAsset(Asset);
+    
+    // Key IDs instead of name lookups on every run
+    UBlackboardData* BlackboardAsset = GetBlackboardAsset();
+    if (BlackboardAsset)
+    {
+        IndexKey.ResolveSelectedKey(*BlackboardAsset);
+        WaypointKey.ResolveSelectedKey(*BlackboardAsset);
+    }
+    bWaypointIsVector = (WaypointKey.SelectedKeyType == UBlackboardKeyType_Vector::StaticClass());
+}
+
 EBTNodeResult::Type UChooseNextWaypoint::ExecuteTask(UBehaviorTreeComponent& OwnerComp,
                                                      uint8* NodeMemory)
 {
-    // Get the patrol route
-    auto ControlledPawn = OwnerComp.GetAIOwner()->GetPawn();
-    auto PatrolRotue = ControlledPawn->FindComponentByClass<UPatrolRoute>();
-    if (!ensure(PatrolRotue)) { return EBTNodeResult::Failed; }
+    TG_SCOPE_CYCLE_COUNTER(ChooseNextWaypoint);
+    
+    FChooseNextWaypointMemory* Memory = reinterpret_cast<FChooseNextWaypointMemory*>(NodeMemory);
     
-    // Warn about empty patrol routes
-    auto PatrolPoints = PatrolRotue->GetPatrolPoints();
-    if (PatrolPoints.Num() == 0)
+    // Get the patrol route, once per guard
+    UPatrolRoute* PatrolRoute = Memory->PatrolRoute.Get();
+    if (PatrolRoute == nullptr)
+    {
+        auto ControlledPawn = OwnerComp.GetAIOwner()->GetPawn();
+        PatrolRoute = ControlledPawn ? ControlledPawn->FindComponentByClass<UPatrolRoute>() : nullptr;
+        if (!ensure(PatrolRoute)) { return EBTNodeResult::Failed; }
+        
+        Memory->PatrolRoute = PatrolRoute;
+    }
+    
+    // Warn about empty patrol routes. The locations only get cached once the route begins play,
+    // so count whichever array we index
+    const int32 NumPatrolPoints = bWaypointIsVector ? PatrolRoute->GetPatrolLocations().Num() : PatrolRoute->GetNumPatrolPoints();
+    if (NumPatrolPoints == 0)
     {
         UE_LOG(LogTemp, Warning, TEXT("A guard is missing patrol points"));
         return EBTNodeResult::Failed;
@@ -25,12 +55,19 @@ EBTNodeResult::Type UChooseNextWaypoint::ExecuteTask(UBehaviorTreeComponent& Own
     
     // Set next waypoint
     auto BlackboardComp = OwnerComp.GetBlackboardComponent();
-    auto Index = BlackboardComp->GetValueAsInt(IndexKey.SelectedKeyName);
-    BlackboardComp->SetValueAsObject(WaypointKey.SelectedKeyName, PatrolPoints[Index]);
+    const int32 Index = FMath::Abs(BlackboardComp->GetValue<UBlackboardKeyType_Int>(IndexKey.GetSelectedKeyID())) % NumPatrolPoints;
+    if (bWaypointIsVector)
+    {
+        BlackboardComp->SetValue<UBlackboardKeyType_Vector>(WaypointKey.GetSelectedKeyID(), PatrolRoute->GetPatrolLocations()[Index]);
+    }
+    else
+    {
+        BlackboardComp->SetValue<UBlackboardKeyType_Object>(WaypointKey.GetSelectedKeyID(), PatrolRoute->GetPatrolPoints()[Index]);
+    }
     
     // Cycle the index
-    auto NextIndex = (Index + 1) % PatrolPoints.Num();
-    BlackboardComp->SetValueAsInt(IndexKey.SelectedKeyName, NextIndex);
+    auto NextIndex = (Index + 1) % NumPatrolPoints;
+    BlackboardComp->SetValue<UBlackboardKeyType_Int>(IndexKey.GetSelectedKeyID(), NextIndex);
     
     return EBTNodeResult::Succeeded;
-}
\ No newline at end of file
+}
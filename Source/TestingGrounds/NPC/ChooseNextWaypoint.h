@@ -5,17 +5,32 @@
 #include "BehaviorTree/BTTaskNode.h"
 #include "ChooseNextWaypoint.generated.h"
 
+class UPatrolRoute;
+
+// Per guard state of the task, kept in the behavior tree's instance memory
+struct FChooseNextWaypointMemory
+{
+    // The route of the controlled pawn, looked up on the first run
+    TWeakObjectPtr<UPatrolRoute> PatrolRoute;
+};
+
 /**
- * 
+ * Moves the guard's waypoint key to the next point of its patrol route.
+ * The waypoint key can be an actor or a vector; a vector key never touches the waypoint actors.
  */
 UCLASS()
 class TESTINGGROUNDS_API UChooseNextWaypoint : public UBTTaskNode
 {
 	GENERATED_BODY()
 	
+    // Resolves the blackboard keys once per tree asset
+    virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+    
     virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp,
                                             uint8* NodeMemory) override;
     
+    virtual uint16 GetInstanceMemorySize() const override { return sizeof(FChooseNextWaypointMemory); }
+    
 protected:
     UPROPERTY(EditAnywhere, Category = "Blackboard")
     struct FBlackboardKeySelector IndexKey;
@@ -23,4 +38,7 @@ protected:
     UPROPERTY(EditAnywhere, Category = "Blackboard")
     struct FBlackboardKeySelector WaypointKey;
 
+private:
+    // True if the waypoint key holds a location rather than the waypoint actor
+    bool bWaypointIsVector = false;
 };
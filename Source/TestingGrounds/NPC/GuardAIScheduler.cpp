@@ -0,0 +1,336 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "GuardAIScheduler.h"
+#include "AIController.h"
+#include "BrainComponent.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "Perception/AIPerceptionComponent.h"
+#include "Perception/AIPerceptionSystem.h"
+#include "../WorldManager.h"
+#include "PatrolRoute.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGuardAI, Log, All);
+
+// Use "stat GuardAI" on the server to check the guards fit the frame budget
+DECLARE_STATS_GROUP(TEXT("GuardAI"), STATGROUP_GuardAI, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Guard AI Total"), STAT_GuardAITotal, STATGROUP_GuardAI);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Sliced Updates Ms"), STAT_GuardAISlicedMs, STATGROUP_GuardAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Near Guards"), STAT_GuardAINear, STATGROUP_GuardAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Mid Guards"), STAT_GuardAIMid, STATGROUP_GuardAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Far Guards"), STAT_GuardAIFar, STATGROUP_GuardAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Brain Updates"), STAT_GuardAIBrainUpdates, STATGROUP_GuardAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Deferred Updates"), STAT_GuardAIDeferred, STATGROUP_GuardAI);
+
+
+// Sets default values
+AGuardAIScheduler::AGuardAIScheduler()
+{
+    // Runs the behavior trees in the group they would tick in themselves
+	PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+    NearTier.BrainInterval = 0.f;
+    NearTier.MovementInterval = 0.f;
+    NearTier.bPerception = true;
+
+    MidTier.BrainInterval = 0.2f;
+    MidTier.MovementInterval = 0.05f;
+    MidTier.bPerception = true;
+
+    FarTier.BrainInterval = 1.f;
+    FarTier.MovementInterval = 0.2f;
+    FarTier.bPerception = false;
+}
+
+void AGuardAIScheduler::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    for (FScheduledGuard& Guard : Guards) ReleaseControl(Guard);
+    Guards.Reset();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void AGuardAIScheduler::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+    SCOPE_CYCLE_COUNTER(STAT_GuardAITotal);
+
+    // Drop the dead guards and pick up the ones that got their controller
+    for (int32 i = Guards.Num() - 1; i >= 0; i--)
+    {
+        if (!Guards[i].Pawn.IsValid())
+        {
+            Guards.RemoveAtSwap(i, 1, false);
+            continue;
+        }
+        if (!Guards[i].Brain.IsValid()) TakeControl(Guards[i]);
+        Guards[i].TimeSinceUpdate += DeltaSeconds;
+    }
+
+    TimeSinceSignificance += DeltaSeconds;
+    if (TimeSinceSignificance >= SignificanceInterval)
+    {
+        TimeSinceSignificance = 0.f;
+        UpdateSignificance();
+    }
+
+    // Near guards run every frame, whatever the budget
+    for (FScheduledGuard& Guard : Guards)
+    {
+        if (Guard.Significance == EGuardSignificance::Near) UpdateBrain(Guard);
+    }
+
+    // The others take turns until the budget is spent. The ones left over go first next frame
+    const double SliceStart = FPlatformTime::Seconds();
+    const double BudgetSeconds = FrameBudgetMs / 1000.0;
+    const int32 NumGuards = Guards.Num();
+    int32 NextCursor = INDEX_NONE;
+
+    for (int32 Visited = 0; Visited < NumGuards; Visited++)
+    {
+        const int32 Index = (SliceCursor + Visited) % NumGuards;
+        FScheduledGuard& Guard = Guards[Index];
+        if (Guard.Significance == EGuardSignificance::Near) continue;
+        if (Guard.TimeSinceUpdate < GetTierSettings(Guard.Significance).BrainInterval) continue;
+
+        if (FPlatformTime::Seconds() - SliceStart > BudgetSeconds)
+        {
+            if (NextCursor == INDEX_NONE) NextCursor = Index;
+            INC_DWORD_STAT(STAT_GuardAIDeferred);
+            continue;
+        }
+
+        UpdateBrain(Guard);
+    }
+
+    SliceCursor = (NextCursor != INDEX_NONE) ? NextCursor : 0;
+    SET_FLOAT_STAT(STAT_GuardAISlicedMs, (FPlatformTime::Seconds() - SliceStart) * 1000.0);
+}
+
+AGuardAIScheduler* AGuardAIScheduler::Get(UWorld* World)
+{
+    return GetWorldManager<AGuardAIScheduler>(World);
+}
+
+void AGuardAIScheduler::RegisterGuard(APawn* Guard)
+{
+    if (Guard == nullptr) return;
+    if (Guards.ContainsByPredicate([Guard](const FScheduledGuard& Scheduled) { return Scheduled.Pawn == Guard; })) return;
+
+    FScheduledGuard& Scheduled = Guards[Guards.AddDefaulted()];
+    Scheduled.Pawn = Guard;
+    TakeControl(Scheduled);
+}
+
+void AGuardAIScheduler::UnregisterGuard(APawn* Guard)
+{
+    const int32 Index = Guards.IndexOfByPredicate([Guard](const FScheduledGuard& Scheduled) { return Scheduled.Pawn == Guard; });
+    if (Index == INDEX_NONE) return;
+
+    ReleaseControl(Guards[Index]);
+    Guards.RemoveAtSwap(Index, 1, false);
+}
+
+int32 AGuardAIScheduler::GetNumGuards(EGuardSignificance Significance) const
+{
+    int32 NumGuards = 0;
+    for (const FScheduledGuard& Guard : Guards)
+    {
+        if (Guard.Significance == Significance) NumGuards++;
+    }
+    return NumGuards;
+}
+
+const FGuardTierSettings& AGuardAIScheduler::GetTierSettings(EGuardSignificance Significance) const
+{
+    switch (Significance)
+    {
+        case EGuardSignificance::Near: return NearTier;
+        case EGuardSignificance::Mid: return MidTier;
+        default: return FarTier;
+    }
+}
+
+bool AGuardAIScheduler::TakeControl(FScheduledGuard& Guard)
+{
+    // The controller only creates its brain when it starts its behavior tree
+    AAIController* Controller = Cast<AAIController>(Guard.Pawn->GetController());
+    UBrainComponent* Brain = Controller ? Controller->BrainComponent : nullptr;
+    if (Brain == nullptr) return false;
+
+    Guard.Controller = Controller;
+    Guard.Brain = Brain;
+    // Added by the controller blueprint, so not necessarily the controller's PerceptionComponent
+    Guard.Perception = Controller->FindComponentByClass<UAIPerceptionComponent>();
+    Guard.bPerceptionEnabled = true;
+    Guard.TimeSinceUpdate = 0.f;
+
+    // From now on the behavior tree only runs when we say so
+    Brain->SetComponentTickEnabled(false);
+    ApplyTier(Guard);
+    return true;
+}
+
+void AGuardAIScheduler::ReleaseControl(FScheduledGuard& Guard)
+{
+    Guard.Significance = EGuardSignificance::Near;
+    if (Guard.Pawn.IsValid()) ApplyTier(Guard);
+
+    if (Guard.Brain.IsValid()) Guard.Brain->SetComponentTickEnabled(true);
+    Guard.Brain.Reset();
+}
+
+void AGuardAIScheduler::UpdateSignificance()
+{
+    // Where every player looks from, remote players included
+    TArray<FVector> ViewLocations;
+    TArray<FVector> ViewDirections;
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        APlayerController* PlayerController = *It;
+        if (PlayerController == nullptr) continue;
+
+        FVector ViewLocation;
+        FRotator ViewRotation;
+        PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+        ViewLocations.Add(ViewLocation);
+        ViewDirections.Add(ViewRotation.Vector());
+    }
+
+    const float CosViewHalfAngle = FMath::Cos(FMath::DegreesToRadians(ViewHalfAngle));
+    uint32 NumPerTier[(int32)EGuardSignificance::MAX] = { 0 };
+
+    for (FScheduledGuard& Guard : Guards)
+    {
+        const FVector GuardLocation = Guard.Pawn->GetActorLocation();
+
+        float ClosestDistSquared = MAX_FLT;
+        bool bInView = false;
+        for (int32 i = 0; i < ViewLocations.Num(); i++)
+        {
+            const FVector ToGuard = GuardLocation - ViewLocations[i];
+            const float DistSquared = ToGuard.SizeSquared();
+            ClosestDistSquared = FMath::Min(ClosestDistSquared, DistSquared);
+
+            if ((ToGuard.GetSafeNormal() | ViewDirections[i]) >= CosViewHalfAngle) bInView = true;
+        }
+
+        EGuardSignificance Significance = EGuardSignificance::Far;
+        if (ClosestDistSquared < FMath::Square(NearDistance)) Significance = EGuardSignificance::Near;
+        else if (ClosestDistSquared < FMath::Square(MidDistance)) Significance = bInView ? EGuardSignificance::Near : EGuardSignificance::Mid;
+        else if (bInView) Significance = EGuardSignificance::Mid;
+
+        NumPerTier[(int32)Significance]++;
+
+        if (Significance != Guard.Significance)
+        {
+            Guard.Significance = Significance;
+            if (Guard.Brain.IsValid()) ApplyTier(Guard);
+        }
+    }
+
+    SET_DWORD_STAT(STAT_GuardAINear, NumPerTier[(int32)EGuardSignificance::Near]);
+    SET_DWORD_STAT(STAT_GuardAIMid, NumPerTier[(int32)EGuardSignificance::Mid]);
+    SET_DWORD_STAT(STAT_GuardAIFar, NumPerTier[(int32)EGuardSignificance::Far]);
+}
+
+void AGuardAIScheduler::ApplyTier(FScheduledGuard& Guard)
+{
+    const FGuardTierSettings& Settings = GetTierSettings(Guard.Significance);
+
+    UPawnMovementComponent* Movement = Guard.Pawn->GetMovementComponent();
+    if (Movement) Movement->SetComponentTickInterval(Settings.MovementInterval);
+
+    UPathFollowingComponent* PathFollowing = Guard.Controller.IsValid() ? Guard.Controller->GetPathFollowingComponent() : nullptr;
+    if (PathFollowing) PathFollowing->SetComponentTickInterval(Settings.MovementInterval);
+
+    // A listener out of the perception system costs the senses nothing
+    UAIPerceptionComponent* Perception = Guard.Perception.Get();
+    if (Perception && Settings.bPerception != Guard.bPerceptionEnabled)
+    {
+        UAIPerceptionSystem* PerceptionSystem = UAIPerceptionSystem::GetCurrent(GetWorld());
+        if (PerceptionSystem)
+        {
+            if (Settings.bPerception) Perception->RequestStimuliListenerUpdate();
+            else PerceptionSystem->UnregisterListener(*Perception);
+            Guard.bPerceptionEnabled = Settings.bPerception;
+        }
+    }
+}
+
+void AGuardAIScheduler::UpdateBrain(FScheduledGuard& Guard)
+{
+    UBrainComponent* Brain = Guard.Brain.Get();
+    if (Brain == nullptr) return;
+
+    // The time since the last run, so timers and waits in the tree keep their pace
+    Brain->TickComponent(Guard.TimeSinceUpdate, LEVELTICK_All, &Brain->PrimaryComponentTick);
+    Guard.TimeSinceUpdate = 0.f;
+    INC_DWORD_STAT(STAT_GuardAIBrainUpdates);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Load test
+
+// Spawns copies of the first guard around it, so "stat GuardAI" can be checked with hundreds of them
+static void SpawnGuards(const TArray<FString>& Args, UWorld* World)
+{
+    const int32 NumGuards = (Args.Num() > 0) ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 500;
+    const float Spacing = 300.f;
+
+    // Preferably a guard with waypoints, so the copies have somewhere to patrol
+    APawn* Template = nullptr;
+    const UPatrolRoute* TemplateRoute = nullptr;
+    for (FConstControllerIterator It = World->GetControllerIterator(); It; ++It)
+    {
+        AAIController* Controller = Cast<AAIController>(*It);
+        if (Controller == nullptr || Controller->GetPawn() == nullptr) continue;
+
+        const UPatrolRoute* Route = Controller->GetPawn()->FindComponentByClass<UPatrolRoute>();
+        if (Template == nullptr || (TemplateRoute == nullptr && Route && Route->GetNumPatrolPoints() > 0))
+        {
+            Template = Controller->GetPawn();
+            TemplateRoute = (Route && Route->GetNumPatrolPoints() > 0) ? Route : nullptr;
+        }
+        if (TemplateRoute) break;
+    }
+
+    if (Template == nullptr)
+    {
+        UE_LOG(LogGuardAI, Warning, TEXT("tg.AI.SpawnGuards needs a guard in the level to copy"));
+        return;
+    }
+
+    AGuardAIScheduler* Scheduler = AGuardAIScheduler::Get(World);
+
+    const int32 GridSize = FMath::CeilToInt(FMath::Sqrt((float)NumGuards));
+    int32 NumSpawned = 0;
+    for (int32 i = 0; i < NumGuards; i++)
+    {
+        const FVector Offset((i % GridSize + 1) * Spacing, (i / GridSize + 1) * Spacing, 0.f);
+        const FTransform Transform(Template->GetActorRotation(), Template->GetActorLocation() + Offset);
+        APawn* Guard = World->SpawnActorDeferred<APawn>(Template->GetClass(), Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding);
+        if (Guard == nullptr) continue;
+
+        // The route caches its waypoints on BeginPlay, and the copies share the template's legs in the path cache
+        UPatrolRoute* Route = Guard->FindComponentByClass<UPatrolRoute>();
+        if (Route && TemplateRoute) Route->SetPatrolPoints(TemplateRoute->GetPatrolPoints());
+        UGameplayStatics::FinishSpawningActor(Guard, Transform);
+
+        if (Guard->GetController() == nullptr) Guard->SpawnDefaultController();
+        if (Scheduler) Scheduler->RegisterGuard(Guard);
+        NumSpawned++;
+    }
+
+    UE_LOG(LogGuardAI, Log, TEXT("Spawned %d guards of %s"), NumSpawned, *Template->GetClass()->GetName());
+    if (TemplateRoute == nullptr)
+    {
+        UE_LOG(LogGuardAI, Warning, TEXT("No guard in the level has patrol points, the spawned guards stand still"));
+    }
+}
+
+static FAutoConsoleCommandWithWorldAndArgs SpawnGuardsCommand(
+    TEXT("tg.AI.SpawnGuards"),
+    TEXT("Spawns copies of the first guard of the level that has patrol points, walking the same route. Usage: tg.AI.SpawnGuards [NumGuards]"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&SpawnGuards));
@@ -0,0 +1,147 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "GuardAIScheduler.generated.h"
+
+class AAIController;
+class UBrainComponent;
+class UAIPerceptionComponent;
+
+// How much a guard matters to the players right now
+UENUM(BlueprintType)
+enum class EGuardSignificance : uint8
+{
+    // Close to a player, or in view and not too far. Updated every frame
+    Near,
+    // Updated a few times per second, within the frame budget
+    Mid,
+    // Far from every player. Rare updates and no perception
+    Far,
+    MAX UMETA(Hidden)
+};
+
+// How often the guards of a significance tier update
+USTRUCT()
+struct FGuardTierSettings
+{
+    GENERATED_BODY()
+
+    // Seconds between two behavior tree updates. 0 means every frame
+    UPROPERTY(EditAnywhere)
+    float BrainInterval = 0.f;
+
+    // Seconds between two movement and path following updates. Keep it under the movement's max simulation time
+    UPROPERTY(EditAnywhere)
+    float MovementInterval = 0.f;
+
+    // Whether the guard keeps perceiving the world
+    UPROPERTY(EditAnywhere)
+    bool bPerception = true;
+};
+
+/**
+ * Per-world scheduler of the guard AI. Server only.
+ * Every guard gets a significance tier from its distance and visibility to the nearest player.
+ * Near guards update every frame; the others are time-sliced round robin within FrameBudgetMs,
+ * and their movement and perception slow down with them.
+ * Use "stat GuardAI" to check the budget holds.
+ */
+UCLASS()
+class TESTINGGROUNDS_API AGuardAIScheduler : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AGuardAIScheduler();
+
+    // Hands the guards their own ticks back
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    // Updates the tiers and runs the behavior trees that are due
+    virtual void Tick(float DeltaSeconds) override;
+
+    // Returns the scheduler of the given world, spawning it if needed
+    static AGuardAIScheduler* Get(UWorld* World);
+
+    // Schedules the AI of the given guard. Its controller may possess it later
+    void RegisterGuard(APawn* Guard);
+
+    void UnregisterGuard(APawn* Guard);
+
+    // Returns the number of guards in the given tier
+    UFUNCTION(BlueprintCallable, Category = "GuardAI")
+    int32 GetNumGuards(EGuardSignificance Significance) const;
+
+protected:
+    // Guards closer than this to a player are Near
+    UPROPERTY(EditAnywhere, Category = "GuardAI")
+    float NearDistance = 2500.f;
+
+    // Guards closer than this are Mid, the others Far. Guards in a player's view move one tier up
+    UPROPERTY(EditAnywhere, Category = "GuardAI")
+    float MidDistance = 8000.f;
+
+    // Guards within this angle of a player's view direction are in view
+    UPROPERTY(EditAnywhere, Category = "GuardAI")
+    float ViewHalfAngle = 60.f;
+
+    // Seconds between two tier updates
+    UPROPERTY(EditAnywhere, Category = "GuardAI")
+    float SignificanceInterval = 0.25f;
+
+    // Milliseconds per frame the Mid and Far guards may spend. Near guards don't count against it
+    UPROPERTY(EditAnywhere, Category = "GuardAI")
+    float FrameBudgetMs = 1.f;
+
+    UPROPERTY(EditAnywhere, Category = "GuardAI")
+    FGuardTierSettings NearTier;
+
+    UPROPERTY(EditAnywhere, Category = "GuardAI")
+    FGuardTierSettings MidTier;
+
+    UPROPERTY(EditAnywhere, Category = "GuardAI")
+    FGuardTierSettings FarTier;
+
+private:
+    struct FScheduledGuard
+    {
+        TWeakObjectPtr<APawn> Pawn;
+        TWeakObjectPtr<AAIController> Controller;
+        TWeakObjectPtr<UBrainComponent> Brain;
+        TWeakObjectPtr<UAIPerceptionComponent> Perception;
+
+        EGuardSignificance Significance = EGuardSignificance::Near;
+
+        // Time since the behavior tree last ran
+        float TimeSinceUpdate = 0.f;
+
+        bool bPerceptionEnabled = true;
+    };
+
+    const FGuardTierSettings& GetTierSettings(EGuardSignificance Significance) const;
+
+    // Takes over the ticks of the guard's controller once it has one. Returns false if it isn't possessed yet
+    bool TakeControl(FScheduledGuard& Guard);
+
+    // Gives the guard its own ticks back
+    void ReleaseControl(FScheduledGuard& Guard);
+
+    // Recomputes the tier of every guard
+    void UpdateSignificance();
+
+    // Applies the movement and perception rates of the guard's tier
+    void ApplyTier(FScheduledGuard& Guard);
+
+    // Runs the behavior tree of the guard with the time it missed
+    void UpdateBrain(FScheduledGuard& Guard);
+
+    TArray<FScheduledGuard> Guards;
+
+    // Where the round robin over the sliced guards resumes next frame
+    int32 SliceCursor = 0;
+
+    float TimeSinceSignificance = 0.f;
+};
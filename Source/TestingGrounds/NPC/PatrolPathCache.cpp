@@ -0,0 +1,196 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "PatrolPathCache.h"
+#include "PatrolRoute.h"
+#include "AI/Navigation/NavigationSystem.h"
+#include "AI/Navigation/NavigationData.h"
+#include "../WorldManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPatrolPaths, Log, All);
+
+// Use "stat PatrolPaths" on the server to see how often the guards skip pathfinding
+DECLARE_STATS_GROUP(TEXT("PatrolPaths"), STATGROUP_PatrolPaths, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Leg Hits"), STAT_PatrolPathHits, STATGROUP_PatrolPaths);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Leg Misses"), STAT_PatrolPathMisses, STATGROUP_PatrolPaths);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Leg Queries"), STAT_PatrolPathQueries, STATGROUP_PatrolPaths);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Leg Invalidations"), STAT_PatrolPathInvalidations, STATGROUP_PatrolPaths);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Cached Legs"), STAT_PatrolPathLegs, STATGROUP_PatrolPaths);
+
+
+// Sets default values
+APatrolPathCache::APatrolPathCache()
+{
+    // Only reacts to routes, guards and the navigation system
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+void APatrolPathCache::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    UNavigationSystem* NavSys = UNavigationSystem::GetCurrent<UNavigationSystem>(GetWorld());
+    if (NavSys)
+    {
+        for (const auto& Query : PendingQueries) NavSys->AbortAsyncFindPathRequest(Query.Key);
+    }
+    PendingQueries.Empty();
+    Flush();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+APatrolPathCache* APatrolPathCache::Get(UWorld* World)
+{
+    return GetWorldManager<APatrolPathCache>(World);
+}
+
+void APatrolPathCache::PrecomputeRoute(const UPatrolRoute* Route, const FNavAgentProperties& InAgentProperties)
+{
+    UNavigationSystem* NavSys = UNavigationSystem::GetCurrent<UNavigationSystem>(GetWorld());
+    if (Route == nullptr || NavSys == nullptr) return;
+
+    // Every guard is the same kind of agent, the first route decides which navmesh the legs are found on
+    if (!NavData.IsValid())
+    {
+        AgentProperties = InAgentProperties;
+        NavData = NavSys->GetNavDataForProps(AgentProperties);
+        if (!NavData.IsValid()) return;
+    }
+
+    const TArray<AActor*>& PatrolPoints = Route->GetPatrolPoints();
+    const TArray<FVector>& PatrolLocations = Route->GetPatrolLocations();
+    const int32 NumPatrolPoints = PatrolLocations.Num();
+    if (NumPatrolPoints < 2) return;
+
+    for (int32 FromIndex = 0; FromIndex < NumPatrolPoints; FromIndex++)
+    {
+        const int32 ToIndex = (FromIndex + 1) % NumPatrolPoints;
+        if (PatrolPoints[FromIndex] == nullptr || PatrolPoints[ToIndex] == nullptr) continue;
+
+        const uint64 LegKey = GetLegKey(PatrolPoints[FromIndex], PatrolPoints[ToIndex]);
+        if (Legs.Contains(LegKey)) continue;
+
+        FPatrolLeg& Leg = Legs.Add(LegKey);
+        Leg.Start = PatrolLocations[FromIndex];
+        Leg.End = PatrolLocations[ToIndex];
+        RequestLeg(LegKey, Leg);
+    }
+    SET_DWORD_STAT(STAT_PatrolPathLegs, Legs.Num());
+}
+
+FNavPathSharedPtr APatrolPathCache::FindLegPath(const UPatrolRoute* Route, int32 FromIndex, int32 ToIndex, const FVector& StartLocation)
+{
+    if (Route == nullptr) return nullptr;
+
+    // The locations are empty until the route begins play
+    const TArray<AActor*>& PatrolPoints = Route->GetPatrolPoints();
+    const TArray<FVector>& PatrolLocations = Route->GetPatrolLocations();
+    if (!PatrolLocations.IsValidIndex(FromIndex) || !PatrolLocations.IsValidIndex(ToIndex)) return nullptr;
+    if (!PatrolPoints.IsValidIndex(FromIndex) || !PatrolPoints.IsValidIndex(ToIndex)) return nullptr;
+    if (PatrolPoints[FromIndex] == nullptr || PatrolPoints[ToIndex] == nullptr) return nullptr;
+
+    const uint64 LegKey = GetLegKey(PatrolPoints[FromIndex], PatrolPoints[ToIndex]);
+    FPatrolLeg* Leg = Legs.Find(LegKey);
+    if (Leg == nullptr || Leg->Points.Num() < 2)
+    {
+        INC_DWORD_STAT(STAT_PatrolPathMisses);
+        if (Leg == nullptr)
+        {
+            Leg = &Legs.Add(LegKey);
+            Leg->Start = PatrolLocations[FromIndex];
+            Leg->End = PatrolLocations[ToIndex];
+            SET_DWORD_STAT(STAT_PatrolPathLegs, Legs.Num());
+        }
+        RequestLeg(LegKey, *Leg);
+        return nullptr;
+    }
+
+    // A guard knocked off its route finds its own way back
+    if (FVector::DistSquared(StartLocation, Leg->Points[0]) > FMath::Square(StartTolerance))
+    {
+        INC_DWORD_STAT(STAT_PatrolPathMisses);
+        return nullptr;
+    }
+    INC_DWORD_STAT(STAT_PatrolPathHits);
+
+    // Path following keeps state in the path, so every guard walks a copy. The points are
+    // in world space, a base actor would make them move along with it
+    TArray<FVector> Points = Leg->Points;
+    Points[0] = StartLocation;
+    FNavPathSharedPtr Path = MakeShareable(new FNavigationPath(Points, nullptr));
+    Path->SetNavigationDataUsed(NavData.Get());
+    return Path;
+}
+
+void APatrolPathCache::Flush()
+{
+    for (auto& Leg : Legs)
+    {
+        if (Leg.Value.SourcePath.IsValid()) Leg.Value.SourcePath->RemoveObserver(Leg.Value.ObserverHandle);
+    }
+    Legs.Empty();
+    SET_DWORD_STAT(STAT_PatrolPathLegs, 0);
+}
+
+uint64 APatrolPathCache::GetLegKey(const AActor* From, const AActor* To)
+{
+    return ((uint64)From->GetUniqueID() << 32) | (uint64)To->GetUniqueID();
+}
+
+void APatrolPathCache::RequestLeg(uint64 LegKey, FPatrolLeg& Leg)
+{
+    UNavigationSystem* NavSys = UNavigationSystem::GetCurrent<UNavigationSystem>(GetWorld());
+    if (Leg.bPending || NavSys == nullptr || !NavData.IsValid()) return;
+
+    // Runs on the navigation system's worker thread, the result comes back on the game thread
+    FPathFindingQuery Query(this, *NavData, Leg.Start, Leg.End, UNavigationQueryFilter::GetQueryFilter(*NavData, nullptr));
+    const uint32 QueryID = NavSys->FindPathAsync(AgentProperties, Query, FNavPathQueryDelegate::CreateUObject(this, &APatrolPathCache::OnLegPathFound));
+    if (QueryID == INVALID_NAVQUERYID) return;
+
+    Leg.bPending = true;
+    PendingQueries.Add(QueryID, LegKey);
+    INC_DWORD_STAT(STAT_PatrolPathQueries);
+}
+
+void APatrolPathCache::OnLegPathFound(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path)
+{
+    uint64 LegKey = 0;
+    if (!PendingQueries.RemoveAndCopyValue(QueryID, LegKey)) return;
+
+    FPatrolLeg* Leg = Legs.Find(LegKey);
+    if (Leg == nullptr) return;
+    Leg->bPending = false;
+
+    if (Leg->SourcePath.IsValid())
+    {
+        Leg->SourcePath->RemoveObserver(Leg->ObserverHandle);
+        Leg->SourcePath.Reset();
+    }
+    Leg->Points.Reset();
+
+    // A failed leg is tried again the next time a guard walks it
+    if (Result != ENavigationQueryResult::Success || !Path.IsValid() || Path->GetPathPoints().Num() < 2)
+    {
+        UE_LOG(LogPatrolPaths, Warning, TEXT("No path between patrol points %s and %s"), *Leg->Start.ToString(), *Leg->End.ToString());
+        return;
+    }
+
+    for (const FNavPathPoint& PathPoint : Path->GetPathPoints()) Leg->Points.Add(PathPoint.Location);
+
+    // The navmesh tells its active paths when tiles under them get rebuilt. Only then is the leg dropped
+    Path->EnableRecalculationOnInvalidation(false);
+    Leg->ObserverHandle = Path->AddObserver(FNavigationPath::FPathObserverDelegate::FDelegate::CreateUObject(this, &APatrolPathCache::OnLegPathEvent, LegKey));
+    Leg->SourcePath = Path;
+    if (NavData.IsValid()) NavData->RegisterActivePath(Path);
+}
+
+void APatrolPathCache::OnLegPathEvent(FNavigationPath* Path, ENavPathEvent::Type Event, uint64 LegKey)
+{
+    if (Event != ENavPathEvent::Invalidated) return;
+
+    // The path is broadcasting, so it's only released when the leg is found again
+    FPatrolLeg* Leg = Legs.Find(LegKey);
+    if (Leg == nullptr || Leg->SourcePath.Get() != Path) return;
+
+    Leg->Points.Reset();
+    INC_DWORD_STAT(STAT_PatrolPathInvalidations);
+}
@@ -2,9 +2,50 @@
 
 #include "TestingGrounds.h"
 #include "PatrolRoute.h"
+#include "GuardAIScheduler.h"
+#include "PatrolPathCache.h"
 
 
-TArray<AActor*> UPatrolRoute::GetPatrolPoints() const
+UPatrolRoute::UPatrolRoute()
 {
-    return PatrolPoints;
-}
\ No newline at end of file
+    bWantsBeginPlay = true;
+    PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UPatrolRoute::BeginPlay()
+{
+    Super::BeginPlay();
+    
+    // A missing waypoint keeps its slot, so the locations line up with the patrol points
+    PatrolLocations.Reset(PatrolPoints.Num());
+    for (AActor* PatrolPoint : PatrolPoints)
+    {
+        PatrolLocations.Add(PatrolPoint ? PatrolPoint->GetActorLocation() : GetOwner()->GetActorLocation());
+    }
+    
+    // Every guard carries a route card, the AI only runs on the server
+    AGuardAIScheduler* Scheduler = (GetOwnerRole() == ROLE_Authority) ? AGuardAIScheduler::Get(GetWorld()) : nullptr;
+    if (Scheduler)
+    {
+        Scheduler->RegisterGuard(Cast<APawn>(GetOwner()));
+    }
+    
+    // The legs between the waypoints are found once and shared by every guard walking them
+    APawn* Guard = Cast<APawn>(GetOwner());
+    APatrolPathCache* PathCache = (Guard && GetOwnerRole() == ROLE_Authority) ? APatrolPathCache::Get(GetWorld()) : nullptr;
+    if (PathCache)
+    {
+        PathCache->PrecomputeRoute(this, Guard->GetNavAgentPropertiesRef());
+    }
+}
+
+void UPatrolRoute::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    AGuardAIScheduler* Scheduler = (GetOwnerRole() == ROLE_Authority) ? AGuardAIScheduler::Get(GetWorld()) : nullptr;
+    if (Scheduler)
+    {
+        Scheduler->UnregisterGuard(Cast<APawn>(GetOwner()));
+    }
+    
+    Super::EndPlay(EndPlayReason);
+}
@@ -14,10 +14,26 @@ class TESTINGGROUNDS_API UPatrolRoute : public UActorComponent
     GENERATED_BODY()
 
 public:	
-    TArray<AActor*> GetPatrolPoints() const;
+    UPatrolRoute();
+    
+    // Caches the waypoint locations and paths, and hands the guard's AI to the scheduler
+    virtual void BeginPlay() override;
+    
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    
+    const TArray<AActor*>& GetPatrolPoints() const { return PatrolPoints; }
+    
+    // Gives a spawned guard its waypoints. Only takes effect before BeginPlay
+    void SetPatrolPoints(const TArray<AActor*>& InPatrolPoints) { PatrolPoints = InPatrolPoints; }
+    
+    // The location of every patrol point, in route order. Waypoints don't move, so it's cached once
+    const TArray<FVector>& GetPatrolLocations() const { return PatrolLocations; }
+    
+    int32 GetNumPatrolPoints() const { return PatrolPoints.Num(); }
     
 private:
     UPROPERTY(EditInstanceOnly, Category = "Patrol Route")
     TArray<AActor*> PatrolPoints;
-	
+    
+    TArray<FVector> PatrolLocations;
 };
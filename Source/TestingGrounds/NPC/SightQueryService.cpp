@@ -0,0 +1,193 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "SightQueryService.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Bool.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Vector.h"
+#include "../WorldManager.h"
+
+// Use "stat SightQuery" on the server to see how many sight checks actually get traced
+DECLARE_STATS_GROUP(TEXT("SightQuery"), STATGROUP_SightQuery, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sight Requests"), STAT_SightRequests, STATGROUP_SightQuery);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sight Requests From Cache"), STAT_SightCached, STATGROUP_SightQuery);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sight Traces"), STAT_SightTraces, STATGROUP_SightQuery);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Sight Pairs"), STAT_SightPairs, STATGROUP_SightQuery);
+
+
+// Sets default values
+ASightQueryService::ASightQueryService()
+{
+    // Late in the frame, so every request of the frame makes it into the batch
+	PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+}
+
+void ASightQueryService::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    CollectResults();
+    DispatchQueued();
+
+    // Forget the pairs nobody looks at anymore
+    const float Now = GetWorld()->GetTimeSeconds();
+    for (auto It = Pairs.CreateIterator(); It; ++It)
+    {
+        const FSightPair& Pair = It.Value();
+        if (!Pair.bQueued && !Pair.TraceHandle.IsValid() && Now - Pair.LastRequestTime > ForgetTime)
+        {
+            It.RemoveCurrent();
+        }
+    }
+    SET_DWORD_STAT(STAT_SightPairs, Pairs.Num());
+}
+
+ASightQueryService* ASightQueryService::Get(UWorld* World)
+{
+    return GetWorldManager<ASightQueryService>(World);
+}
+
+void ASightQueryService::RequestSight(AActor* Observer, AActor* Target, const FSightListener& Listener, float MaxResultAge)
+{
+    if (Observer == nullptr || Target == nullptr || !Listener.Blackboard.IsValid()) return;
+    INC_DWORD_STAT(STAT_SightRequests);
+
+    const float Now = GetWorld()->GetTimeSeconds();
+    FSightPair& Pair = Pairs.FindOrAdd(GetPairKey(Observer, Target));
+    Pair.Observer = Observer;
+    Pair.Target = Target;
+    Pair.LastRequestTime = Now;
+
+    if (Pair.bHasResult && Now - Pair.ResultTime <= MaxResultAge)
+    {
+        INC_DWORD_STAT(STAT_SightCached);
+        Deliver(Pair, Listener);
+        return;
+    }
+
+    // Several requests of the same pair share the trace
+    const bool bAlreadyListening = Pair.Listeners.ContainsByPredicate([&Listener](const FSightListener& Other)
+    {
+        return Other.Blackboard == Listener.Blackboard && Other.VisibleKey == Listener.VisibleKey && Other.LocationKey == Listener.LocationKey;
+    });
+    if (!bAlreadyListening) Pair.Listeners.Add(Listener);
+
+    if (!Pair.bQueued && !Pair.TraceHandle.IsValid())
+    {
+        Pair.bQueued = true;
+        QueuedPairs.Add(GetPairKey(Observer, Target));
+    }
+}
+
+void ASightQueryService::Deliver(const FSightPair& Pair, const FSightListener& Listener) const
+{
+    UBlackboardComponent* Blackboard = Listener.Blackboard.Get();
+    if (Blackboard == nullptr) return;
+
+    if (Listener.VisibleKey != FBlackboard::InvalidKey)
+    {
+        Blackboard->SetValue<UBlackboardKeyType_Bool>(Listener.VisibleKey, Pair.bVisible);
+    }
+    if (Listener.LocationKey != FBlackboard::InvalidKey && Pair.bVisible && Pair.Target.IsValid())
+    {
+        Blackboard->SetValue<UBlackboardKeyType_Vector>(Listener.LocationKey, Pair.Target->GetActorLocation());
+    }
+}
+
+void ASightQueryService::CollectResults()
+{
+    UWorld* World = GetWorld();
+    const float Now = World->GetTimeSeconds();
+
+    for (int32 i = InFlightPairs.Num() - 1; i >= 0; i--)
+    {
+        FSightPair* Pair = Pairs.Find(InFlightPairs[i]);
+        if (Pair == nullptr)
+        {
+            InFlightPairs.RemoveAtSwap(i, 1, false);
+            continue;
+        }
+
+        // Results only live for a frame. A missed one gets traced again
+        if (!World->IsTraceHandleValid(Pair->TraceHandle, false))
+        {
+            Pair->TraceHandle = FTraceHandle();
+            Pair->bQueued = true;
+            QueuedPairs.Add(InFlightPairs[i]);
+            InFlightPairs.RemoveAtSwap(i, 1, false);
+            continue;
+        }
+
+        FTraceDatum TraceDatum;
+        if (!World->QueryTraceData(Pair->TraceHandle, TraceDatum))
+        {
+            // Not done yet, try again next frame
+            continue;
+        }
+
+        // Visible if nothing blocks the way, or the first thing in the way is the target itself
+        bool bVisible = true;
+        for (const FHitResult& Hit : TraceDatum.OutHits)
+        {
+            if (Hit.bBlockingHit)
+            {
+                bVisible = (Hit.GetActor() == Pair->Target.Get());
+                break;
+            }
+        }
+
+        Pair->bVisible = bVisible;
+        Pair->bHasResult = true;
+        Pair->ResultTime = Now;
+        Pair->TraceHandle = FTraceHandle();
+
+        for (const FSightListener& Listener : Pair->Listeners) Deliver(*Pair, Listener);
+        Pair->Listeners.Reset();
+
+        InFlightPairs.RemoveAtSwap(i, 1, false);
+    }
+}
+
+void ASightQueryService::DispatchQueued()
+{
+    UWorld* World = GetWorld();
+    static const FName SightTraceTag(TEXT("GuardSight"));
+
+    NumTracesLastFrame = 0;
+    for (uint64 PairKey : QueuedPairs)
+    {
+        FSightPair* Pair = Pairs.Find(PairKey);
+        if (Pair == nullptr) continue;
+
+        Pair->bQueued = false;
+
+        AActor* Observer = Pair->Observer.Get();
+        AActor* Target = Pair->Target.Get();
+        if (Observer == nullptr || Target == nullptr)
+        {
+            Pair->Listeners.Reset();
+            continue;
+        }
+
+        FVector EyesLocation;
+        FRotator EyesRotation;
+        Observer->GetActorEyesViewPoint(EyesLocation, EyesRotation);
+
+        Pair->TraceHandle = World->AsyncLineTraceByChannel(EAsyncTraceType::Single,
+                                                           EyesLocation,
+                                                           Target->GetActorLocation(),
+                                                           SightChannel,
+                                                           FCollisionQueryParams(SightTraceTag, false, Observer));
+        InFlightPairs.Add(PairKey);
+        NumTracesLastFrame++;
+    }
+    QueuedPairs.Reset();
+
+    INC_DWORD_STAT_BY(STAT_SightTraces, NumTracesLastFrame);
+}
+
+uint64 ASightQueryService::GetPairKey(const AActor* Observer, const AActor* Target)
+{
+    return ((uint64)Observer->GetUniqueID() << 32) | (uint64)Target->GetUniqueID();
+}
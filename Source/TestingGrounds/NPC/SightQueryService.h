@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "BehaviorTree/BehaviorTreeTypes.h"
+#include "SightQueryService.generated.h"
+
+class UBlackboardComponent;
+
+// Where a sight result gets written when it arrives
+struct FSightListener
+{
+    TWeakObjectPtr<UBlackboardComponent> Blackboard;
+
+    // Bool key set to whether the target is visible
+    FBlackboard::FKey VisibleKey = FBlackboard::InvalidKey;
+
+    // Optional vector key set to the target's location while it's visible
+    FBlackboard::FKey LocationKey = FBlackboard::InvalidKey;
+};
+
+/**
+ * Per-world line of sight checks for the guards. Server only.
+ * The requests of a frame are deduplicated per observer and target, traced asynchronously at the end
+ * of the frame and written to the requesting blackboards on the next one.
+ * A result younger than the requester's tolerance is handed out again without tracing.
+ */
+UCLASS()
+class TESTINGGROUNDS_API ASightQueryService : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ASightQueryService();
+
+    // Delivers the results of last frame's traces and issues the traces of this frame
+    virtual void Tick(float DeltaSeconds) override;
+
+    // Returns the service of the given world, spawning it if needed
+    static ASightQueryService* Get(UWorld* World);
+
+    /**
+     * Asks whether Observer can see Target. The answer goes to the listener's blackboard keys:
+     * right away if a result at most MaxResultAge seconds old exists, on the next frame otherwise.
+     */
+    void RequestSight(AActor* Observer, AActor* Target, const FSightListener& Listener, float MaxResultAge);
+
+    // Returns the number of traces issued last frame
+    UFUNCTION(BlueprintCallable, Category = "SightQuery")
+    int32 GetNumTracesLastFrame() const { return NumTracesLastFrame; }
+
+protected:
+    // Trace channel that blocks sight
+    UPROPERTY(EditAnywhere, Category = "SightQuery")
+    TEnumAsByte<ECollisionChannel> SightChannel = ECC_Visibility;
+
+    // Pairs nobody asked about for this many seconds are forgotten
+    UPROPERTY(EditAnywhere, Category = "SightQuery")
+    float ForgetTime = 5.f;
+
+private:
+    // The sight state of one observer looking at one target
+    struct FSightPair
+    {
+        TWeakObjectPtr<AActor> Observer;
+        TWeakObjectPtr<AActor> Target;
+
+        bool bVisible = false;
+        bool bHasResult = false;
+        float ResultTime = 0.f;
+        float LastRequestTime = 0.f;
+
+        // Waiting for the end of the frame to be traced
+        bool bQueued = false;
+
+        // The trace in flight, valid until its result is delivered
+        FTraceHandle TraceHandle;
+
+        TArray<FSightListener> Listeners;
+    };
+
+    // Writes the pair's result to one listener
+    void Deliver(const FSightPair& Pair, const FSightListener& Listener) const;
+
+    // Reads the results of the traces in flight and hands them to the listeners
+    void CollectResults();
+
+    // Issues one async trace per queued pair
+    void DispatchQueued();
+
+    static uint64 GetPairKey(const AActor* Observer, const AActor* Target);
+
+    TMap<uint64, FSightPair> Pairs;
+
+    // The pairs waiting for their trace
+    TArray<uint64> QueuedPairs;
+
+    // The pairs whose trace is in flight
+    TArray<uint64> InFlightPairs;
+
+    int32 NumTracesLastFrame = 0;
+};
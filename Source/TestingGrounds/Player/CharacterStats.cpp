@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "CharacterStats.h"
+
+const float FCharacterStats::MaxReplicatedHealth = 1023.75f;
+
+bool FCharacterStats::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+    // 12 bits of quarter points and 4 bits of bombs - 2 bytes instead of a float and an int
+    uint32 QuantizedHealth = 0;
+    uint32 PackedBombCount = 0;
+
+    if (Ar.IsSaving())
+    {
+        QuantizedHealth = (uint32)FMath::RoundToInt(FMath::Clamp(Health, 0.f, MaxReplicatedHealth) * 4.f);
+        PackedBombCount = (uint32)FMath::Min<int32>(BombCount, MaxReplicatedBombCount);
+    }
+
+    Ar.SerializeInt(QuantizedHealth, 4096);
+    Ar.SerializeInt(PackedBombCount, MaxReplicatedBombCount + 1);
+
+    if (Ar.IsLoading())
+    {
+        Health = QuantizedHealth / 4.f;
+        BombCount = (uint8)PackedBombCount;
+    }
+
+    bOutSuccess = true;
+    return true;
+}
@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CharacterStats.generated.h"
+
+/**
+ * The replicated stats of an ACharacterV2.
+ * Sent through a single NetSerialize: health quantized to quarter points, bomb count packed in 4 bits.
+ */
+USTRUCT()
+struct FCharacterStats
+{
+    GENERATED_BODY()
+
+    // Health is sent in quarter points, up to this value
+    static const float MaxReplicatedHealth;
+
+    // Bomb counts are sent in 4 bits
+    static const int32 MaxReplicatedBombCount = 15;
+
+    UPROPERTY(VisibleAnywhere)
+    float Health = 0.f;
+
+    UPROPERTY(VisibleAnywhere)
+    uint8 BombCount = 0;
+
+    bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+    bool operator==(const FCharacterStats& Other) const
+    {
+        return Health == Other.Health && BombCount == Other.BombCount;
+    }
+};
+
+template<>
+struct TStructOpsTypeTraits<FCharacterStats> : public TStructOpsTypeTraitsBase
+{
+    enum
+    {
+        WithNetSerializer = true,
+        WithIdenticalViaEquality = true,
+    };
+};
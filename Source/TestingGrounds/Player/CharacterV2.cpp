@@ -3,14 +3,25 @@
 #include "TestingGrounds.h"
 #include "Components/TextRenderComponent.h"
 #include "../Weapons/Gun.h"
+#include "../Weapons/PredictedFireComponent.h"
+#include "../LoadTest/LoadTestBotComponent.h"
+#include "../LoadTest/LoadTestNetDriver.h"
+#include "../TickAggregator.h"
+#include "../TestingGroundsStats.h"
+#include "../AssetPreloader.h"
+#include "../LagCompensation.h"
 #include "CharacterV2.h"
 
+// Use "stat CharacterV2" to see how often the nameplates rebuild their text mesh
+DECLARE_STATS_GROUP(TEXT("CharacterV2"), STATGROUP_CharacterV2, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Nameplate Rebuilds"), STAT_NameplateRebuilds, STATGROUP_CharacterV2);
+
 
 // Sets default values
 ACharacterV2::ACharacterV2()
 {
- 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-    PrimaryActorTick.bCanEverTick = true;
+    // Nothing to update per frame. Periodic updates go through the ATickAggregator
+    PrimaryActorTick.bCanEverTick = false;
     
     // Set size for collision capsule
     GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
@@ -58,6 +69,9 @@ ACharacterV2::ACharacterV2()
     // attach it to root comp
     CharText->SetupAttachment(GetRootComponent());
     
+    // The gun fires through this component
+    FireComponent = CreateDefaultSubobject<UPredictedFireComponent>(FName("FireComponent"));
+    
 }
 
 // Called when the game starts or when spawned
@@ -68,24 +82,73 @@ void ACharacterV2::BeginPlay()
     InitHealth();
     InitBombCount();
     
-    if (GunBlueprint == nullptr)
+    // Hits on us get checked against where we were when the shooter saw us
+    ALagCompensation::RegisterIfAuthority(this);
+    
+    // Nobody looks at nameplates on a dedicated server
+    ATickAggregator* TickAggregator = ATickAggregator::Get(GetWorld());
+    if (TickAggregator && GetNetMode() != NM_DedicatedServer)
+    {
+        TickAggregator->Register(ETickCategory::Character, this, &ACharacterV2::UpdateCharText);
+    }
+    
+    // Headless load test clients play by themselves
+    if (ULoadTestBotComponent::IsLoadTestBot())
+    {
+        ULoadTestBotComponent* Bot = NewObject<ULoadTestBotComponent>(this, FName("LoadTestBot"));
+        Bot->RegisterComponent();
+    }
+    
+    if (GunBlueprint.IsNull())
     {
         UE_LOG(LogTemp, Warning, TEXT("GunBlueprint missing"));
         return;
     }
     
-    Gun = GetWorld()->SpawnActor<AGun>(GunBlueprint);
+    // The gun shows up and bombs can be thrown once their classes are loaded
+    AAssetPreloader* Preloader = AAssetPreloader::Get(GetWorld());
+    if (Preloader)
+    {
+        Preloader->RequestAssets(EAssetBundle::Combat, { GunBlueprint.ToStringReference(), BombActorBP.ToStringReference() },
+                                 FSimpleDelegate::CreateUObject(this, &ACharacterV2::OnCombatAssetsLoaded));
+    }
+}
+
+void ACharacterV2::OnCombatAssetsLoaded()
+{
+    if (Gun || GunBlueprint.Get() == nullptr || IsPendingKill()) return;
+    
+    // The explosion effect is only needed by the time the first bomb goes off
+    ABomb* BombDefaults = BombActorBP.Get() ? BombActorBP.Get()->GetDefaultObject<ABomb>() : nullptr;
+    AAssetPreloader* Preloader = AAssetPreloader::Get(GetWorld());
+    if (BombDefaults && Preloader)
+    {
+        Preloader->RequestAssets(EAssetBundle::Combat, { BombDefaults->GetExplosionFX().ToStringReference() });
+    }
+    
+    // Owned by us, so the gun finds our fire component
+    FActorSpawnParameters GunSpawnParameters;
+    GunSpawnParameters.Owner = this;
+    GunSpawnParameters.Instigator = this;
+    Gun = GetWorld()->SpawnActor<AGun>(GunBlueprint.Get(), GunSpawnParameters);
+    if (Gun == nullptr) return;
     
     // TODO: Figure out how to use the gun fire action binding without using the Mesh1p without using this mesh or find another way to do these actions.
     Gun->AttachToComponent(Mesh1P, FAttachmentTransformRules(EAttachmentRule::SnapToTarget, true), TEXT("GripPoint")); //Attach gun mesh component to Skeleton, doing it here because the skelton is not yet created in the constructor
     Gun->AnimInstance = Mesh1P->GetAnimInstance();
 }
 
-// Called every frame
-void ACharacterV2::Tick( float DeltaTime )
+void ACharacterV2::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick( DeltaTime );
-
+    ATickAggregator* TickAggregator = ATickAggregator::Get(GetWorld());
+    if (TickAggregator)
+    {
+        TickAggregator->Unregister(ETickCategory::Character, this);
+    }
+    
+    ALagCompensation::UnregisterIfAuthority(this);
+    
+    Super::EndPlay(EndPlayReason);
 }
 
 // Called to bind functionality to input
@@ -107,79 +170,106 @@ void ACharacterV2::SetupPlayerInputComponent(class UInputComponent* PlayerInputC
     PlayerInputComponent->BindAxis("LookUpRate", this, &ACharacterV2::LookUpAtRate);
     
     PlayerInputComponent->BindAction("ThrowBomb", IE_Pressed, this, &ACharacterV2::AttempToSpawnBomb);
-    PlayerInputComponent->BindAction("Fire", IE_Pressed, Gun, &AGun::OnFire);
+    PlayerInputComponent->BindAction("Fire", IE_Pressed, this, &ACharacterV2::OnFirePressed);
+}
+
+void ACharacterV2::OnFirePressed()
+{
+    if (Gun) Gun->OnFire();
 }
 
 void ACharacterV2::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
     Super::GetLifetimeReplicatedProps(OutLifetimeProps);
     
-    // Tell the engine to call the OnRep_Health and OnRep_BombCount each time
-    // - a variable changes
-    DOREPLIFETIME(ACharacterV2, Health);
-    DOREPLIFETIME(ACharacterV2, BombCount);
+    // Tell the engine to call the OnRep_Stats each time
+    // - the health or the bomb count changes
+    DOREPLIFETIME(ACharacterV2, Stats);
 }
 
-void ACharacterV2::OnRep_Health()
+void ACharacterV2::OnRep_Stats()
 {
-    UpdateCharText();
+    MarkCharTextDirty();
 }
 
-void ACharacterV2::OnRep_BombCount()
+void ACharacterV2::InitHealth()
 {
-    UpdateCharText();
+    if (MaxHealth > FCharacterStats::MaxReplicatedHealth)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("%s: MaxHealth %.2f is more than the stats can replicate, clamped to %.2f"), *GetName(), MaxHealth, FCharacterStats::MaxReplicatedHealth);
+    }
+    Stats.Health = FMath::Min(MaxHealth, FCharacterStats::MaxReplicatedHealth);
+    MarkCharTextDirty();
 }
 
-void ACharacterV2::InitHealth()
+void ACharacterV2::InitBombCount()
 {
-    Health = MaxHealth;
-    UpdateCharText();
+    Stats.BombCount = (uint8)FMath::Clamp(MaxBombCount, 0, FCharacterStats::MaxReplicatedBombCount);
+    MarkCharTextDirty();
 }
 
-void ACharacterV2::InitBombCount()
+void ACharacterV2::RefillBombs()
 {
-    BombCount = MaxBombCount;
-    UpdateCharText();
+    if (Role == ROLE_Authority && Stats.BombCount < MaxBombCount) InitBombCount();
 }
 
-void ACharacterV2::UpdateCharText()
+void ACharacterV2::UpdateCharText(float DeltaSeconds)
 {
+    if (!bCharTextDirty) return;
+    
+    // Off-screen or far away nameplates wait until someone can read them
+    if (!WasRecentlyRendered(0.2f)) return;
+    
+    APlayerCameraManager* CameraManager = UGameplayStatics::GetPlayerCameraManager(this, 0);
+    if (CameraManager && FVector::DistSquared(CameraManager->GetCameraLocation(), GetActorLocation()) > FMath::Square(NameplateMaxDistance)) return;
+    
+    bCharTextDirty = false;
+    
+    const int32 NewHealth = FMath::CeilToInt(Stats.Health);
+    const int32 NewBombCount = Stats.BombCount;
+    if (NewHealth == DisplayedHealth && NewBombCount == DisplayedBombCount) return;
+    
+    DisplayedHealth = NewHealth;
+    DisplayedBombCount = NewBombCount;
+    
     //Create a string that will display the health and bomb count values
     FString NewText =
-    FString("Health: ") + FString::SanitizeFloat(Health) + FString(" Bomb Count: ") + FString::FromInt(BombCount);
+    FString("Health: ") + FString::FromInt(DisplayedHealth) + FString(" Bomb Count: ") + FString::FromInt(DisplayedBombCount);
     
     //Set the created string to the text render comp
     CharText->SetText(FText::FromString(NewText));
+    INC_DWORD_STAT(STAT_NameplateRebuilds);
 }
 
-
 float ACharacterV2::TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
     Super::TakeDamage(Damage, DamageEvent, EventInstigator, DamageCauser);
     
     // Decrease the character's hp
     
-    Health -= Damage;
-    if (Health <= 0) InitHealth();
+    Stats.Health -= Damage;
+    if (Stats.Health <= 0) InitHealth();
     
     //Call the update text on the local client
-    //OnRep_Health will be called in every other client so the character's text
+    //OnRep_Stats will be called in every other client so the character's text
     //will contain a text with the right values
     
-    UpdateCharText();
+    MarkCharTextDirty();
     
-    return Health;
+    return Stats.Health;
 }
 
 void ACharacterV2::ServerTakeDamage_Implementation(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
+    ULoadTestNetDriver::CountReceivedRPC(this, FName("ServerTakeDamage"));
+    
     TakeDamage(Damage, DamageEvent, EventInstigator, DamageCauser);
 }
 
 bool ACharacterV2::ServerTakeDamage_Validate(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
-    //Assume that everything is ok without any further checks and return true
-    return true;
+    // Anything past what the health can even hold is a broken or cheating client
+    return FMath::IsFinite(Damage) && Damage >= 0.f && Damage <= FCharacterStats::MaxReplicatedHealth;
 }
 
 void ACharacterV2::AttempToSpawnBomb()
@@ -199,10 +289,19 @@ void ACharacterV2::AttempToSpawnBomb()
 
 void ACharacterV2::SpawnBomb()
 {
+    TG_SCOPE_CYCLE_COUNTER(SpawnBomb);
+    
+    // The server gets here straight from the RPC, so the client's check doesn't count
+    if (!HasBombs()) return;
+    
+    // Keep the bomb until its class is loaded
+    if (BombActorBP.Get() == nullptr) return;
+    TG_INC_COUNTER(Spawns);
+    
     //Decrease the bomb count and update the text in the local client
-    //OnRep_BombCount will be called in every other client
-    BombCount--;
-    UpdateCharText();
+    //OnRep_Stats will be called in every other client
+    Stats.BombCount--;
+    MarkCharTextDirty();
     
     FActorSpawnParameters SpawnParameters;
     
@@ -211,7 +310,7 @@ void ACharacterV2::SpawnBomb()
     
     // Spawn the bomb
     GetWorld()->SpawnActor<ABomb>(
-                                  BombActorBP,
+                                  BombActorBP.Get(),
                                   GetActorLocation() + GetActorForwardVector() * 200,
                                   GetActorRotation(),
                                   SpawnParameters);
@@ -219,6 +318,8 @@ void ACharacterV2::SpawnBomb()
 
 void ACharacterV2::ServerSpawnBomb_Implementation()
 {
+    ULoadTestNetDriver::CountReceivedRPC(this, FName("ServerSpawnBomb"));
+    
     SpawnBomb();
 }
 
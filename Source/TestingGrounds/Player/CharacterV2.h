@@ -4,6 +4,7 @@
 
 #include "GameFramework/Character.h"
 #include "../Weapons/Bomb.h"
+#include "CharacterStats.h"
 #include "CharacterV2.generated.h"
 
 UCLASS()
@@ -18,22 +19,21 @@ public:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 	
-	// Called every frame
-	virtual void Tick( float DeltaSeconds ) override;
-
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* InputComponent) override;
 
     // Marks the properties we wish to replicate
     virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
     
-    /** Bomb Blueprint */
+    /** Bomb Blueprint, loaded with the combat bundle */
     UPROPERTY(EditAnywhere)
-    TSubclassOf<ABomb> BombActorBP;
+    TAssetSubclassOf<ABomb> BombActorBP;
     
-    /** Projectile class to spawn */
+    /** Gun class to spawn, loaded with the combat bundle */
     UPROPERTY(EditDefaultsOnly, Category= "Setup")
-    TSubclassOf<class AGun> GunBlueprint;
+    TAssetSubclassOf<class AGun> GunBlueprint;
     
     /** Pawn mesh: 1st person view (arms; seen only by self) */
     UPROPERTY(VisibleDefaultsOnly, Category=Mesh)
@@ -41,18 +41,14 @@ public:
     
 protected:
     
-    // The health of the character
-    UPROPERTY(VisibleAnywhere, Transient, ReplicatedUsing = OnRep_Health, Category = Stats)
-    float Health;
+    // The health and bomb count of the character, replicated as one quantized struct
+    UPROPERTY(VisibleAnywhere, Transient, ReplicatedUsing = OnRep_Stats, Category = Stats)
+    FCharacterStats Stats;
     
-    // The max health of the character
-    UPROPERTY(EditAnywhere, Category = Stats)
+    // The max health of the character. Capped at FCharacterStats::MaxReplicatedHealth, the most the stats can replicate
+    UPROPERTY(EditAnywhere, Category = Stats, meta = (ClampMin = "0.0", ClampMax = "1023.75"))
     float MaxHealth = 100.f;
     
-    // Then number of bombs that the character carries
-    UPROPERTY(VisibleAnywhere, Transient, ReplicatedUsing = OnRep_BombCount, Category = Stats)
-	int32 BombCount;
-    
     // The max number of bombs that a character can have
     UPROPERTY(EditAnywhere, Category = Stats)
     int32 MaxBombCount = 3;
@@ -61,16 +57,27 @@ protected:
     UPROPERTY(VisibleAnywhere)
     class UTextRenderComponent* CharText;
     
+    // The nameplate isn't refreshed while the character is further than this from the local camera
+    UPROPERTY(EditAnywhere, Category = Stats)
+    float NameplateMaxDistance = 3000.f;
+    
 private:
+    // The gun, spawned once its class is loaded
     AGun* Gun;
     
-    // Called when the Health variable gets updated
-    UFUNCTION()
-    void OnRep_Health();
+    // Spawns the gun and requests the bomb's effects
+    void OnCombatAssetsLoaded();
+    
+    // Fires the gun, if it's there yet
+    void OnFirePressed();
+    
+    // Carries the shots of the gun to the server
+    UPROPERTY(VisibleAnywhere)
+    class UPredictedFireComponent* FireComponent;
     
-    // Called when the BombCount variable gets updated
+    // Called when the Stats variable gets updated
     UFUNCTION()
-    void OnRep_BombCount();
+    void OnRep_Stats();
     
     // Initalizes health
     void InitHealth();
@@ -78,8 +85,19 @@ private:
     // Initalizes bomb count
     void InitBombCount();
     
-    // Updates the character's text to match with the updated stats
-    void UpdateCharText();
+    // Asks for the character's text to match with the updated stats. Coalesced to one refresh per frame
+    void MarkCharTextDirty() { bCharTextDirty = true; }
+    
+    // Refreshes the character's text if the stats changed and someone can see it.
+    // Runs in the Character category of the ATickAggregator
+    void UpdateCharText(float DeltaSeconds);
+    
+    // True if the stats changed since the text was last refreshed
+    bool bCharTextDirty = false;
+    
+    // The values the text currently shows, so unchanged values don't rebuild the text mesh
+    int32 DisplayedHealth = INDEX_NONE;
+    int32 DisplayedBombCount = INDEX_NONE;
     
     
     
@@ -102,11 +120,8 @@ private:
     
     // Bomb related functions
     
-    /** Will try to spawn a bomb */
-    void AttempToSpawnBomb();
-    
     /** Returns true if we can throw a bomb */
-    bool HasBombs() { return BombCount > 0; }
+    bool HasBombs() { return Stats.BombCount > 0; }
     
     /**
      * Spawns a bomb. Call this function when you're authorized to.
@@ -137,6 +152,12 @@ private:
     class UCameraComponent* FollowCamera;
     
 public:
+    /** Will try to spawn a bomb */
+    void AttempToSpawnBomb();
+    
+    /** Gives the character all its bombs back. Server only */
+    void RefillBombs();
+    
     /** Applies damage to the character */
     virtual float TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
     
@@ -4,10 +4,18 @@
 #include "FirstPersonCharacter.h"
 #include "GameFramework/InputSettings.h"
 #include "../Weapons/Gun.h"
+#include "../Weapons/PredictedFireComponent.h"
 #include "../Inventory/PickUp.h"
+#include "../Inventory/PickUpRegistry.h"
+#include "../LoadTest/LoadTestNetDriver.h"
 #include "../Magic/SkillsComponent.h"
 #include "../Magic/Skill.h"
+#include "../Magic/SkillPool.h"
 #include "MyPlayerController.h"
+#include "../TickAggregator.h"
+#include "../TestingGroundsStats.h"
+#include "../AssetPreloader.h"
+#include "../LagCompensation.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogFPChar, Warning, All);
 
@@ -16,6 +24,9 @@ DEFINE_LOG_CATEGORY_STATIC(LogFPChar, Warning, All);
 
 AFirstPersonCharacter::AFirstPersonCharacter()
 {
+	// The interaction query runs in the ATickAggregator, we don't need our own tick
+	PrimaryActorTick.bCanEverTick = false;
+
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(55.f, 96.0f);
 
@@ -63,6 +74,9 @@ AFirstPersonCharacter::AFirstPersonCharacter()
     
     //Initializing the skills component
     SkillsComponent = CreateDefaultSubobject<USkillsComponent>(FName("SkillsComponent"));
+    
+    // The gun fires through this component
+    FireComponent = CreateDefaultSubobject<UPredictedFireComponent>(FName("FireComponent"));
 }
 
 void AFirstPersonCharacter::BeginPlay()
@@ -71,32 +85,109 @@ void AFirstPersonCharacter::BeginPlay()
 	Super::BeginPlay();
 
     // Initalize reference for Item Pickup highlight
-    LastItemSeen = nullptr;
+    LastItemSeen.Reset();
+    
+    // Hits on us get checked against where we were when the shooter saw us
+    ALagCompensation::RegisterIfAuthority(this);
     
-    // Initalizing our inventory
-    Inventory.SetNum(MAX_INVENTORY_ITEMS);
+    // Our traces should ignore the character
+    InteractionQueryParams = FCollisionQueryParams(FName("InteractionTrace"), false, this);
+    LastInteractionViewDirection = FirstPersonCameraComponent->GetForwardVector();
+    
+    ATickAggregator* TickAggregator = ATickAggregator::Get(GetWorld());
+    if (TickAggregator)
+    {
+        TickAggregator->Register(ETickCategory::Interaction, this, &AFirstPersonCharacter::UpdateInteraction);
+    }
+    
+    // Initalizing our inventory - clients receive it through replication
+    if (HasAuthority())
+    {
+        Inventory.Init(InventoryCapacity);
+    }
+    Inventory.OnSlotChanged.AddUObject(this, &AFirstPersonCharacter::OnInventorySlotChanged);
     
-    if (GunBlueprint == nullptr)
+    if (GunBlueprint.IsNull())
     {
         UE_LOG(LogTemp, Warning, TEXT("GunBlueprint missing"));
         return;
     }
-    Gun = GetWorld()->SpawnActor<AGun>(GunBlueprint);
-	Gun->AttachToComponent(Mesh1P, FAttachmentTransformRules(EAttachmentRule::SnapToTarget, true), TEXT("GripPoint")); //Attach gun mesh component to Skeleton, doing it here because the skelton is not yet created in the constructor
-    Gun->AnimInstance = Mesh1P->GetAnimInstance();
+    
+    // The gun shows up once its class is loaded
+    AAssetPreloader* Preloader = AAssetPreloader::Get(GetWorld());
+    if (Preloader)
+    {
+        Preloader->RequestAssets(EAssetBundle::Combat, { GunBlueprint.ToStringReference() },
+                                 FSimpleDelegate::CreateUObject(this, &AFirstPersonCharacter::OnCombatAssetsLoaded));
+    }
     
     //InputComponent->BindTouch(EInputEvent::IE_Pressed, this, &AFirstPersonCharacter::TouchStarted);
-    if (EnableTouchscreenMovement(InputComponent) == false)
+    if (InputComponent && EnableTouchscreenMovement(InputComponent) == false)
     {
-        InputComponent->BindAction("Fire", IE_Pressed, Gun, &AGun::OnFire);
+        InputComponent->BindAction("Fire", IE_Pressed, this, &AFirstPersonCharacter::OnFirePressed);
     }
 }
 
-void AFirstPersonCharacter::Tick(float DeltaSeconds)
+void AFirstPersonCharacter::OnCombatAssetsLoaded()
+{
+    if (Gun || GunBlueprint.Get() == nullptr || IsPendingKill()) return;
+    
+    // Owned by us, so the gun finds our fire component
+    FActorSpawnParameters GunSpawnParameters;
+    GunSpawnParameters.Owner = this;
+    GunSpawnParameters.Instigator = this;
+    Gun = GetWorld()->SpawnActor<AGun>(GunBlueprint.Get(), GunSpawnParameters);
+    if (Gun == nullptr) return;
+	Gun->AttachToComponent(Mesh1P, FAttachmentTransformRules(EAttachmentRule::SnapToTarget, true), TEXT("GripPoint")); //Attach gun mesh component to Skeleton, doing it here because the skelton is not yet created in the constructor
+    Gun->AnimInstance = Mesh1P->GetAnimInstance();
+}
+
+void AFirstPersonCharacter::OnFirePressed()
+{
+    if (Gun) Gun->OnFire();
+}
+
+void AFirstPersonCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    ATickAggregator* TickAggregator = ATickAggregator::Get(GetWorld());
+    if (TickAggregator)
+    {
+        TickAggregator->Unregister(ETickCategory::Interaction, this);
+    }
+    
+    Inventory.OnSlotChanged.RemoveAll(this);
+    
+    ALagCompensation::UnregisterIfAuthority(this);
+    
+    Super::EndPlay(EndPlayReason);
+}
+
+void AFirstPersonCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+    
+    // Nobody but the owner needs to know what we carry
+    DOREPLIFETIME_CONDITION(AFirstPersonCharacter, Inventory, COND_OwnerOnly);
+}
+
+void AFirstPersonCharacter::UpdateInteraction(float DeltaSeconds)
 {
-    Super::Tick(DeltaSeconds);
-    // Raycast every frame
-    Raycast();
+    // Only the local player highlights items
+    if (!IsLocallyControlled()) return;
+    
+    // Look for usable items
+    switch (InteractionQueryMode)
+    {
+        case EInteractionQueryMode::AsyncTrace:
+            UpdateAsyncInteractionTrace(DeltaSeconds);
+            break;
+        case EInteractionQueryMode::SpatialRegistry:
+            QueryPickUpRegistry();
+            break;
+        default:
+            Raycast();
+            break;
+    }
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -245,6 +336,9 @@ bool AFirstPersonCharacter::EnableTouchscreenMovement(class UInputComponent* Inp
 
 void AFirstPersonCharacter::Raycast()
 {
+    TG_SCOPE_CYCLE_COUNTER(Raycast);
+    TG_INC_COUNTER(Traces);
+    
     // Calculating start and end location
     FVector StartLocation = FirstPersonCameraComponent->GetComponentLocation();
     FVector EndLocation = StartLocation + (FirstPersonCameraComponent->GetForwardVector()
@@ -252,21 +346,99 @@ void AFirstPersonCharacter::Raycast()
     
     FHitResult RaycastHit;
     
-    // Raycast should ignore the character
-    FCollisionQueryParams CQP;
-    CQP.AddIgnoredActor(this);
-    
     // Raycast
     GetWorld()->LineTraceSingleByChannel(
                                          RaycastHit,
                                          StartLocation,
                                          EndLocation,
                                          ECollisionChannel::ECC_WorldDynamic,
-                                         CQP);
+                                         InteractionQueryParams);
+    
+    UpdateLastItemSeen(Cast<APickUp>(RaycastHit.GetActor()));
+}
+
+void AFirstPersonCharacter::QueryPickUpRegistry()
+{
+    APickUpRegistry* Registry = APickUpRegistry::Get(GetWorld());
+    if (Registry == nullptr) return;
+    
+    UpdateLastItemSeen(Registry->FindClosestInViewCone(FirstPersonCameraComponent->GetComponentLocation(),
+                                                       FirstPersonCameraComponent->GetForwardVector(),
+                                                       RaycastRange,
+                                                       InteractionConeHalfAngle,
+                                                       InteractionQueryParams));
+}
+
+void AFirstPersonCharacter::UpdateAsyncInteractionTrace(float DeltaSeconds)
+{
+    UWorld* World = GetWorld();
+    
+    // The results of an async trace are only available on the frame after we issued it
+    if (World->IsTraceHandleValid(PendingInteractionTrace, false))
+    {
+        FTraceDatum TraceDatum;
+        if (World->QueryTraceData(PendingInteractionTrace, TraceDatum))
+        {
+            APickUp* PickUp = nullptr;
+            for (const FHitResult& Hit : TraceDatum.OutHits)
+            {
+                if (Hit.bBlockingHit)
+                {
+                    PickUp = Cast<APickUp>(Hit.GetActor());
+                    break;
+                }
+            }
+            
+            UpdateLastItemSeen(PickUp);
+            PendingInteractionTrace = FTraceHandle();
+        }
+    }
+    else
+    {
+        PendingInteractionTrace = FTraceHandle();
+    }
+    
+    TimeSinceInteractionQuery += DeltaSeconds;
+    if (PendingInteractionTrace.IsValid() || TimeSinceInteractionQuery < GetInteractionQueryInterval(DeltaSeconds))
+    {
+        return;
+    }
+    TimeSinceInteractionQuery = 0.f;
+    
+    // Calculating start and end location
+    FVector StartLocation = FirstPersonCameraComponent->GetComponentLocation();
+    FVector EndLocation = StartLocation + (FirstPersonCameraComponent->GetForwardVector()
+                                           * RaycastRange);
     
-    APickUp* PickUp = Cast<APickUp>(RaycastHit.GetActor());
+    TG_INC_COUNTER(Traces);
+    PendingInteractionTrace = World->AsyncLineTraceByChannel(
+                                                             EAsyncTraceType::Single,
+                                                             StartLocation,
+                                                             EndLocation,
+                                                             ECC_Interactable,
+                                                             InteractionQueryParams);
+}
+
+float AFirstPersonCharacter::GetInteractionQueryInterval(float DeltaSeconds)
+{
+    const FVector ViewDirection = FirstPersonCameraComponent->GetForwardVector();
+    const float CosAngle = FMath::Clamp(FVector::DotProduct(ViewDirection, LastInteractionViewDirection), -1.f, 1.f);
+    LastInteractionViewDirection = ViewDirection;
+    
+    if (DeltaSeconds <= 0.f || InteractionQueryFullRateTurnSpeed <= 0.f) return 0.f;
+    
+    // Trace more often the faster the camera turns - that's when the item under the crosshair changes
+    const float TurnSpeed = FMath::RadiansToDegrees(FMath::Acos(CosAngle)) / DeltaSeconds;
+    const float TurnAlpha = FMath::Clamp(TurnSpeed / InteractionQueryFullRateTurnSpeed, 0.f, 1.f);
+    return FMath::Lerp(InteractionQueryMaxInterval, 0.f, TurnAlpha);
+}
+
+void AFirstPersonCharacter::UpdateLastItemSeen(APickUp* PickUp)
+{
+    // Still looking at the same item, its glow is already on
+    if (PickUp == LastItemSeen.Get()) return;
     
-    if (LastItemSeen && LastItemSeen != PickUp)
+    if (LastItemSeen.IsValid())
     {
         // If our character seens a different pickup then disable the glowing effect
         // - on the previous seen item
@@ -280,56 +452,82 @@ void AFirstPersonCharacter::Raycast()
     }// Re-Initalize
     else
     {
-        LastItemSeen = nullptr;
+        LastItemSeen.Reset();
     }
 }
 
 void AFirstPersonCharacter::PickUpItem()
 {
-    if (LastItemSeen)
+    if (LastItemSeen.IsValid())
     {
-        // Find the first available slot
-        int32 AvailableSlot = Inventory.Find(nullptr);
-        
-        if (AvailableSlot != INDEX_NONE)
+        // The server owns the inventory, the new slot replicates back to us. A client keeps the
+        // item until its destruction replicates, so a rejected pickup still loses its glow when we look away
+        if (HasAuthority())
         {
-            // Add the item to the first valid slot we found
-            Inventory[AvailableSlot] = LastItemSeen;
-            // Destroy the item from the game
-            LastItemSeen->Destroy();
+            if (PickUpItemLocal(LastItemSeen.Get())) UpdateLastItemSeen(nullptr);
         }
         else
         {
-            GLog->Log("You can't carry anymore");
+            ServerPickUpItem(LastItemSeen.Get());
         }
     }
 }
 
+bool AFirstPersonCharacter::PickUpItemLocal(APickUp* PickUp)
+{
+    if (PickUp == nullptr || PickUp->IsPendingKill()) return false;
+    
+    // Add the item to the first available slot
+    const FInventoryItem Item = PickUp->GetInventoryItem();
+    
+    if (Inventory.Add(Item) != INDEX_NONE)
+    {
+        // Destroy the item from the game
+        PickUp->Destroy();
+        return true;
+    }
+    
+    GLog->Log("You can't carry anymore");
+    return false;
+}
+
+void AFirstPersonCharacter::ServerPickUpItem_Implementation(APickUp* PickUp)
+{
+    ULoadTestNetDriver::CountReceivedRPC(this, FName("ServerPickUpItem"));
+    
+    PickUpItemLocal(PickUp);
+}
+
+bool AFirstPersonCharacter::ServerPickUpItem_Validate(APickUp* PickUp)
+{
+    // Clients only pick up what's in reach - with some slack for latency
+    return PickUp && GetDistanceTo(PickUp) <= RaycastRange * 2.f;
+}
+
+void AFirstPersonCharacter::OnInventorySlotChanged(int32 Slot)
+{
+    const FInventoryItem* Item = Inventory.GetItem(Slot);
+    
+    // The equipped item is gone
+    if (Slot == EquippedSlot && Item == nullptr) EquippedSlot = INDEX_NONE;
+    
+    AMyPlayerController* Con = Cast<AMyPlayerController>(GetController());
+    if (Con && IsLocallyControlled()) Con->RefreshInventorySlot(Slot, Item);
+}
+
 void AFirstPersonCharacter::HandleInventoryInput()
 {
     AMyPlayerController* Con = Cast<AMyPlayerController>(GetController());
     if (Con) Con->HandleInventoryInput();
 }
 
-void AFirstPersonCharacter::SetEquippedItem(UTexture2D* Texture)
+void AFirstPersonCharacter::SetEquippedItem(int32 SlotIndex)
 {
-    if (Texture)
+    const FInventoryItem* Item = Inventory.GetItem(SlotIndex);
+    if (Item)
     {
-        //For this scenario we make the assumption that
-        //every pickup has a unique texture.
-        //So, in order to set the equipped item we just check every item
-        //inside our Inventory. Once we find an item that has the same image as the
-        //Texture image we're passing as a parameter we mark that item as
-        // - CurrentlyEquipped.
-        for (auto It = Inventory.CreateIterator(); It; It++)
-        {
-            if ((*It) && (*It)->GetPickupTexture() && (*It)->GetPickupTexture()->HasSameSourceArt(Texture))
-            {
-                CurrentlyEquippedItem = *It;
-                GLog->Log("I've set a new equipped item: " + CurrentlyEquippedItem->GetName());
-                break;
-            }
-        }
+        EquippedSlot = SlotIndex;
+        GLog->Log("I've set a new equipped item: " + Item->ItemID.ToString());
     }
     else
     {
@@ -337,37 +535,67 @@ void AFirstPersonCharacter::SetEquippedItem(UTexture2D* Texture)
     }
 }
 
+int32 AFirstPersonCharacter::FindItemSlot(FName ItemID) const
+{
+    if (ItemID.IsNone()) return INDEX_NONE;
+    
+    for (int32 Slot = 0; Slot < Inventory.GetCapacity(); Slot++)
+    {
+        const FInventoryItem* Item = Inventory.GetItem(Slot);
+        if (Item && Item->ItemID == ItemID) return Slot;
+    }
+    return INDEX_NONE;
+}
+
 void AFirstPersonCharacter::DropEquippedItem()
 {
-    if (CurrentlyEquippedItem)
+    if (Inventory.GetItem(EquippedSlot) == nullptr) return;
+    
+    if (HasAuthority()) DropItemLocal(EquippedSlot);
+    else ServerDropItem(EquippedSlot);
+}
+
+void AFirstPersonCharacter::DropItemLocal(int32 SlotIndex)
+{
+    const FInventoryItem* Item = Inventory.GetItem(SlotIndex);
+    if (Item == nullptr) return;
+    
+    if (Item->PickUpClass == nullptr) return;
+    
+    // The location of the drop
+    FVector DropLocation = GetActorLocation() + (GetActorForwardVector() * 200);
+    
+    // Making a transform with default rotation and scale.
+    // Just setting up the location that was calculated above
+    FTransform Transform;
+    Transform.SetLocation(DropLocation);
+    
+    // Default actor spawn parameters
+    FActorSpawnParameters SpawnParams;
+    
+    // Spawning our pickup
+    APickUp* PickupToSpawn = GetWorld()->SpawnActor<APickUp>(Item->PickUpClass, Transform, SpawnParams);
+    
+    if (PickupToSpawn)
     {
-        int32 IndexOfItem;
-        if (Inventory.Find(CurrentlyEquippedItem, IndexOfItem))
-        {
-            // The location of the drop
-            FVector DropLocation = GetActorLocation() + (GetActorForwardVector() * 200);
-            
-            // Making a transform with default rotation and scale.
-            // Just setting up the location that was calculated above
-            FTransform Transform;
-            Transform.SetLocation(DropLocation);
-            
-            // Default actor spawn parameters
-            FActorSpawnParameters SpawnParams;
-            
-            // Spawning our pickup
-            APickUp* PickupToSpawn = GetWorld()->SpawnActor<APickUp>(CurrentlyEquippedItem->GetClass(), Transform, SpawnParams);
-            
-            if (PickupToSpawn)
-            {
-                // Unreference the item we've just placed
-                Inventory[IndexOfItem] = nullptr;
-            }
-            
-        }
+        // Free the slot of the item we've just placed
+        FInventoryItem DroppedItem;
+        Inventory.RemoveAt(SlotIndex, DroppedItem);
     }
 }
 
+void AFirstPersonCharacter::ServerDropItem_Implementation(int32 SlotIndex)
+{
+    ULoadTestNetDriver::CountReceivedRPC(this, FName("ServerDropItem"));
+    
+    DropItemLocal(SlotIndex);
+}
+
+bool AFirstPersonCharacter::ServerDropItem_Validate(int32 SlotIndex)
+{
+    return SlotIndex >= 0;
+}
+
 FTransform AFirstPersonCharacter::GetFixedSpringArmTransform(USpringArmComponent* SpringArm)
 {
     FTransform result;
@@ -384,19 +612,35 @@ FTransform AFirstPersonCharacter::GetFixedSpringArmTransform(USpringArmComponent
 void AFirstPersonCharacter::Fire(bool bShouldFireSecondary)
 {
     // This is a dummy logic - we currently only have 2 skills
-    TSubclassOf<ASkill> SkillBP = (bShouldFireSecondary && SkillsComponent->SkillsArray.IsValidIndex(1)) ? SkillsComponent->SkillsArray[1] : SkillsComponent->SkillsArray[0];
+    // Null until the skills bundle is loaded
+    if (!SkillsComponent->SkillsArray.IsValidIndex(0)) return;
+    TSubclassOf<ASkill> SkillBP = (bShouldFireSecondary && SkillsComponent->SkillsArray.IsValidIndex(1)) ? SkillsComponent->SkillsArray[1].Get() : SkillsComponent->SkillsArray[0].Get();
     
     if (SkillBP)
     {
-        FActorSpawnParameters ActorSpawnParams;
+        // Levels and cooldowns live in our skills component, not in the skill class
+        const ESkillType SkillType = SkillBP->GetDefaultObject<ASkill>()->GetSkillType();
+        if (!SkillsComponent->IsSkillReady(SkillType)) return;
         
-        TArray<FTransform> SpawnTransforms = GetSpawnTransforms(SkillBP->GetDefaultObject<ASkill>()->GetLevel());
+        SkillsComponent->CommitSkillCooldown(SkillType);
+        TArray<FTransform> SpawnTransforms = GetSpawnTransforms(SkillsComponent->GetSkillLevelByType(SkillType));
+        
+        // Recycle skill instances instead of spawning new ones on every cast
+        ASkillPool* SkillPool = ASkillPool::Get(GetWorld());
+        TArray<ASkill*> Instances;
         
         for (int32 i = 0; i < SpawnTransforms.Num(); i++)
         {
-            GetWorld()->SpawnActor<ASkill>(SkillBP, SpawnTransforms[i]);
+            TG_INC_COUNTER(Spawns);
+            ASkill* Skill = SkillPool ? SkillPool->AcquireSkill(SkillBP, SpawnTransforms[i]) : GetWorld()->SpawnActor<ASkill>(SkillBP, SpawnTransforms[i]);
+            
+            // Our hits get reported through our fire component
+            if (Skill) Skill->Instigator = this;
+            Instances.Add(Skill);
         }
         
+        // The server only takes the hits of casts it knows about
+        FireComponent->CastPredicted(SkillType, Instances);
     }
 }
 
@@ -1,13 +1,24 @@
 // Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
 #pragma once
 #include "GameFramework/Character.h"
+#include "../Inventory/InventoryItem.h"
 #include "FirstPersonCharacter.generated.h"
 
-#define MAX_INVENTORY_ITEMS 4
-
 class UInputComponent;
 class USkillsComponent;
 
+// How the character looks for pickups in front of the camera
+UENUM(BlueprintType)
+enum class EInteractionQueryMode : uint8
+{
+    // Synchronous line trace on the WorldDynamic channel every frame
+    SyncTrace,
+    // Asynchronous line trace on the Interactable channel, consumed on the next frame
+    AsyncTrace,
+    // Spatial hash lookup of the registered pickups plus one occlusion trace
+    SpatialRegistry
+};
+
 UCLASS(config=Game)
 class AFirstPersonCharacter : public ACharacter
 {
@@ -25,7 +36,10 @@ public:
 
 	virtual void BeginPlay() override;
     
-    virtual void Tick(float DeltaSeconds) override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    
+    // Marks the properties we wish to replicate
+    virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 	/** Base turn rate, in deg/sec. Other scaling may affect final turn rate. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Camera)
@@ -39,49 +53,114 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay)
 	FVector GunOffset;
     
-    /** Projectile class to spawn */
+    /** Gun class to spawn, loaded with the combat bundle */
     UPROPERTY(EditDefaultsOnly, Category= "Setup")
-    TSubclassOf<class AGun> GunBlueprint;
+    TAssetSubclassOf<class AGun> GunBlueprint;
     
     // Getter for the Inventory
-    TArray<class APickUp*> GetInventory() { return Inventory; }
+    const FInventorySlots& GetInventory() const { return Inventory; }
     
-    // Sets a new equipped item based on the given texture
-    void SetEquippedItem(UTexture2D* Texture);
+    // Sets the item of the given inventory slot as the equipped one
+    void SetEquippedItem(int32 SlotIndex);
+    
+    // Returns the first inventory slot holding the given item definition, INDEX_NONE if we don't carry it
+    int32 FindItemSlot(FName ItemID) const;
     
     /*Returns the skills component*/
     UFUNCTION(BlueprintCallable,Category="TLSkillsTree")
     USkillsComponent* GetSkillsComponent() const { return SkillsComponent; }
     
 private:
-    // The Gun
+    // The Gun, spawned once its class is loaded
     AGun* Gun;
     
+    // Spawns the gun and hands it our arms
+    void OnCombatAssetsLoaded();
+    
+    // Fires the gun, if it's there yet
+    void OnFirePressed();
+    
+    // Carries the shots of the gun to the server
+    UPROPERTY(VisibleAnywhere)
+    class UPredictedFireComponent* FireComponent;
+    
+    // Looks for usable items in front of the camera. Runs in the Interaction category of the ATickAggregator
+    void UpdateInteraction(float DeltaSeconds);
+    
     // Raycasts in front of the character to find usable items
     void Raycast();
     
-    // Reference to the last seen pickup item. Nullptr if none*/
-    class APickUp* LastItemSeen;
+    // Asks the pickup registry for the closest pickup in the view cone
+    void QueryPickUpRegistry();
+    
+    // Consumes the async interaction trace of the previous frame and issues a new one when due
+    void UpdateAsyncInteractionTrace(float DeltaSeconds);
+    
+    // Returns the seconds to wait between two async interaction traces, based on how fast the camera turns
+    float GetInteractionQueryInterval(float DeltaSeconds);
+    
+    // Moves the glow effect to the given pickup. Nullptr if we don't see any
+    void UpdateLastItemSeen(class APickUp* PickUp);
+    
+    // Reference to the last seen pickup item. Nullptr if none. Weak, since another player may pick it up
+    TWeakObjectPtr<class APickUp> LastItemSeen;
+    
+    // Query params shared by every interaction trace - built once in BeginPlay
+    FCollisionQueryParams InteractionQueryParams;
+    
+    // The async interaction trace waiting to be consumed
+    FTraceHandle PendingInteractionTrace;
+    
+    // Seconds since we issued the last async interaction trace
+    float TimeSinceInteractionQuery = 0.f;
+    
+    // The camera direction of the previous frame, used to compute its angular velocity
+    FVector LastInteractionViewDirection = FVector::ForwardVector;
     
     // Handles the pickup input
     UFUNCTION()
     void PickUpItem();
     
-    // The actual Inventory
-    UPROPERTY(VisibleAnywhere)
-    TArray<class APickUp*> Inventory;
+    // Adds the pickup to the inventory and destroys it. Returns false if it didn't fit. Server only
+    bool PickUpItemLocal(class APickUp* PickUp);
+    
+    /** Picks up the item on the server. Clients only tell it which pickup they see */
+    UFUNCTION(Server, Reliable, WithValidation)
+    void ServerPickUpItem(class APickUp* PickUp);
+    
+    void ServerPickUpItem_Implementation(class APickUp* PickUp);
+    
+    bool ServerPickUpItem_Validate(class APickUp* PickUp);
+    
+    // The actual Inventory. Only the owner receives it
+    UPROPERTY(VisibleAnywhere, Replicated)
+    FInventorySlots Inventory;
+    
+    // Forwards the change of an inventory slot to the inventory widget
+    void OnInventorySlotChanged(int32 Slot);
     
     // Handles the Inventory by sending information to the controller
     UFUNCTION()
     void HandleInventoryInput();
     
-    // Reference to the currently equipped item
-    class APickUp* CurrentlyEquippedItem;
+    // The inventory slot of the currently equipped item. INDEX_NONE if none
+    int32 EquippedSlot = INDEX_NONE;
     
     // Drops the currently equipped item
     UFUNCTION()
     void DropEquippedItem();
     
+    // Spawns the item of the given slot in front of us and empties the slot. Server only
+    void DropItemLocal(int32 SlotIndex);
+    
+    /** Drops the item of the given slot on the server */
+    UFUNCTION(Server, Reliable, WithValidation)
+    void ServerDropItem(int32 SlotIndex);
+    
+    void ServerDropItem_Implementation(int32 SlotIndex);
+    
+    bool ServerDropItem_Validate(int32 SlotIndex);
+    
     ///////////////// SKILLS ///////////////////////////////
 private:
     /*Returns a fixed transform based on the given spring arm comp*/
@@ -149,9 +228,29 @@ protected:
     UPROPERTY(EditAnywhere)
     float RaycastRange = 250.f;
     
+    // How we look for pickups in front of the camera
+    UPROPERTY(EditAnywhere, Category = "Interaction")
+    EInteractionQueryMode InteractionQueryMode = EInteractionQueryMode::AsyncTrace;
+    
+    // Seconds between async interaction traces while the camera is still
+    UPROPERTY(EditAnywhere, Category = "Interaction")
+    float InteractionQueryMaxInterval = 0.1f;
+    
+    // Camera turn rate, in deg/sec, at which we trace on every frame
+    UPROPERTY(EditAnywhere, Category = "Interaction")
+    float InteractionQueryFullRateTurnSpeed = 180.f;
+    
+    // Half angle, in degrees, of the view cone used by the pickup registry
+    UPROPERTY(EditAnywhere, Category = "Interaction")
+    float InteractionConeHalfAngle = 10.f;
+    
     UPROPERTY(EditAnywhere)
     TSubclassOf<class APickUp> PickupBPRef;
     
+    // The number of items the character can carry
+    UPROPERTY(EditDefaultsOnly, Category = "Inventory", meta = (ClampMin = "0"))
+    int32 InventoryCapacity = 4;
+    
 protected:
 	// APawn interface
 	virtual void SetupPlayerInputComponent(UInputComponent* InputComponent) override;
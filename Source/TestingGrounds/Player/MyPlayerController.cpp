@@ -9,6 +9,17 @@ void AMyPlayerController::Possess(APawn* InPawn)
 {
     Super::Possess(InPawn);
     
+    CreateInventoryWidget();
+    
+    // Initial value
+    bIsInventoryOpen = false;
+}
+
+void AMyPlayerController::CreateInventoryWidget()
+{
+    // Remote players on the server don't have a screen
+    if (InventoryWidgetRef || !IsLocalController()) return;
+    
     if (InventoryWidgetBP)
     {
         // Create the Inventory Widget based on the Blueprint reference we will
@@ -16,14 +27,15 @@ void AMyPlayerController::Possess(APawn* InPawn)
         InventoryWidgetRef = CreateWidget<class UInventoryWidget>(this,
                                                                   InventoryWidgetBP);
     }
-    
-    // Initial value
-    bIsInventoryOpen = false;
 }
 
 void AMyPlayerController::HandleInventoryInput()
 {
     AFirstPersonCharacter* Char = Cast<AFirstPersonCharacter>(GetPawn());
+    
+    // Clients never run Possess
+    CreateInventoryWidget();
+    
     if (InventoryWidgetRef)
     {
         if (bIsInventoryOpen)
@@ -45,13 +57,13 @@ void AMyPlayerController::HandleInventoryInput()
             // Unpause the game
             SetPause(false);
         }
-        else
+        else if (Char)
         {
             // Mark the inventory as open
             bIsInventoryOpen = true;
             
-            // Re-populate the ItemsArray
-            InventoryWidgetRef->ItemsArray = Char->GetInventory();
+            // Populate the ItemsArray once, slot changes keep it up to date afterwards
+            if (!InventoryWidgetRef->HasInventory()) InventoryWidgetRef->SetInventory(Char->GetInventory());
             
             // Show the inventory
             InventoryWidgetRef->Show();
@@ -69,3 +81,11 @@ void AMyPlayerController::HandleInventoryInput()
     }
     
 }
+
+void AMyPlayerController::RefreshInventorySlot(int32 Slot, const FInventoryItem* Item)
+{
+    if (InventoryWidgetRef && InventoryWidgetRef->HasInventory())
+    {
+        InventoryWidgetRef->RefreshSlot(Slot, Item);
+    }
+}
@@ -16,8 +16,12 @@ class TESTINGGROUNDS_API AMyPlayerController : public APlayerController
 	
 private:
     // InventoryWidget reference
+    UPROPERTY()
     class UInventoryWidget* InventoryWidgetRef;
     
+    // Creates the inventory widget if we're a local player and don't have it yet
+    void CreateInventoryWidget();
+    
     // True if the inventory is currently open - false otherwise
     bool bIsInventoryOpen;
     
@@ -31,5 +35,8 @@ public:
     
     // Opens or closes the inventory
     void HandleInventoryInput();
+    
+    // Rebuilds the given slot of the inventory widget. Called when the slot of our character changes
+    void RefreshInventorySlot(int32 Slot, const struct FInventoryItem* Item);
 	
 };
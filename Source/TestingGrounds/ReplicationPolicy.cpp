@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "ReplicationPolicy.h"
+
+void FReplicationPolicy::ApplyTo(AActor* Actor) const
+{
+    if (Actor == nullptr) return;
+
+    Actor->NetCullDistanceSquared = FMath::Square(CullDistance);
+    Actor->NetPriority = NetPriority;
+    Actor->NetUpdateFrequency = MaxUpdateFrequency;
+    Actor->MinNetUpdateFrequency = MinUpdateFrequency;
+}
+
+void FReplicationPolicy::UpdateFrequency(AActor* Actor) const
+{
+    if (Actor == nullptr || Actor->Role != ROLE_Authority || Actor->NetDormancy > DORM_Awake) return;
+
+    const float SpeedAlpha = (FullRateSpeed > 0.f) ? FMath::Clamp(Actor->GetVelocity().Size() / FullRateSpeed, 0.f, 1.f) : 1.f;
+    const float NewFrequency = FMath::Lerp(MinUpdateFrequency, MaxUpdateFrequency, SpeedAlpha);
+
+    // Small changes aren't worth touching the actor for
+    if (FMath::Abs(NewFrequency - Actor->NetUpdateFrequency) > 0.5f)
+    {
+        Actor->NetUpdateFrequency = NewFrequency;
+    }
+}
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ReplicationPolicy.generated.h"
+
+/**
+ * How a short-lived gameplay actor replicates: who it's relevant to and how often it's considered.
+ * Slow or resting actors drop towards MinUpdateFrequency, fast ones climb to MaxUpdateFrequency.
+ */
+USTRUCT()
+struct FReplicationPolicy
+{
+    GENERATED_BODY()
+
+    // Clients whose view is further away than this don't receive the actor
+    UPROPERTY(EditAnywhere, Category = "Replication")
+    float CullDistance = 5000.f;
+
+    // Net updates per second while the actor moves at FullRateSpeed or faster
+    UPROPERTY(EditAnywhere, Category = "Replication")
+    float MaxUpdateFrequency = 30.f;
+
+    // Net updates per second while the actor rests
+    UPROPERTY(EditAnywhere, Category = "Replication")
+    float MinUpdateFrequency = 2.f;
+
+    // The speed, in cm/sec, at which the actor gets MaxUpdateFrequency
+    UPROPERTY(EditAnywhere, Category = "Replication")
+    float FullRateSpeed = 1000.f;
+
+    // Bandwidth share against other actors. Scaled by distance to the viewer by the engine
+    UPROPERTY(EditAnywhere, Category = "Replication")
+    float NetPriority = 1.f;
+
+    // Sets the relevancy, priority and update frequency of the actor. Call it once the blueprint defaults are in
+    void ApplyTo(AActor* Actor) const;
+
+    // Scales the update frequency of the actor with its speed. Server only, call it periodically
+    void UpdateFrequency(AActor* Actor) const;
+};
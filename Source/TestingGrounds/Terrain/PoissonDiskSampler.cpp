@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "PoissonDiskSampler.h"
+
+
+FPoissonDiskSampler::FPoissonDiskSampler(const FBox2D& InArea, float InCellSize, int32 Seed)
+    : Area(InArea)
+    , CellSize(FMath::Max(InCellSize, 1.f))
+    , Random(Seed)
+{
+    const FVector2D Size = Area.GetSize();
+    GridWidth = FMath::Max(FMath::CeilToInt(Size.X / CellSize), 1);
+    GridHeight = FMath::Max(FMath::CeilToInt(Size.Y / CellSize), 1);
+    Cells.SetNum(GridWidth * GridHeight);
+}
+
+int32 FPoissonDiskSampler::AddPoints(float Radius, int32 MaxPoints, TArray<FVector2D>& OutPoints, int32 AttemptsPerPoint)
+{
+    if (MaxPoints <= 0 || Radius <= 0.f) return 0;
+
+    TArray<FVector2D> Active;
+    int32 NumAdded = 0;
+    while (NumAdded < MaxPoints)
+    {
+        // Seeds a new front wherever there's room left, earlier circles may have cut the area into islands
+        if (Active.Num() == 0)
+        {
+            bool bSeeded = false;
+            for (int32 Attempt = 0; Attempt < AttemptsPerPoint && !bSeeded; Attempt++)
+            {
+                const FVector2D Candidate(Random.FRandRange(Area.Min.X, Area.Max.X), Random.FRandRange(Area.Min.Y, Area.Max.Y));
+                if (IsFree(Candidate, Radius))
+                {
+                    Insert(Candidate, Radius);
+                    Active.Add(Candidate);
+                    OutPoints.Add(Candidate);
+                    NumAdded++;
+                    bSeeded = true;
+                }
+            }
+            if (!bSeeded) break;
+            continue;
+        }
+
+        // Tries around a random point of the front, in the ring between one and two diameters away
+        const int32 ActiveIndex = Random.RandHelper(Active.Num());
+        const FVector2D Origin = Active[ActiveIndex];
+        bool bFound = false;
+        for (int32 Attempt = 0; Attempt < AttemptsPerPoint && !bFound; Attempt++)
+        {
+            const float Angle = Random.FRandRange(0.f, 2.f * PI);
+            const float Distance = Random.FRandRange(2.f * Radius, 4.f * Radius);
+            const FVector2D Candidate = Origin + FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)) * Distance;
+            if (IsFree(Candidate, Radius))
+            {
+                Insert(Candidate, Radius);
+                Active.Add(Candidate);
+                OutPoints.Add(Candidate);
+                NumAdded++;
+                bFound = true;
+            }
+        }
+
+        // Nothing fits around it anymore
+        if (!bFound) Active.RemoveAtSwap(ActiveIndex, 1, false);
+    }
+    return NumAdded;
+}
+
+float FPoissonDiskSampler::GetRadiusForCount(const FBox2D& Area, int32 NumPoints)
+{
+    // Bridson fills roughly two thirds of a hexagonal packing
+    const FVector2D Size = Area.GetSize();
+    return FMath::Sqrt(Size.X * Size.Y * 0.66f / (FMath::Max(NumPoints, 1) * 2.f * FMath::Sqrt(3.f)));
+}
+
+bool FPoissonDiskSampler::IsFree(const FVector2D& Center, float Radius) const
+{
+    if (Center.X < Area.Min.X || Center.X >= Area.Max.X || Center.Y < Area.Min.Y || Center.Y >= Area.Max.Y) return false;
+
+    // Any circle that overlaps has its center within this many cells
+    const int32 Reach = FMath::CeilToInt((Radius + MaxRadius) / CellSize);
+    const int32 CellX = FMath::Clamp(FMath::FloorToInt((Center.X - Area.Min.X) / CellSize), 0, GridWidth - 1);
+    const int32 CellY = FMath::Clamp(FMath::FloorToInt((Center.Y - Area.Min.Y) / CellSize), 0, GridHeight - 1);
+
+    for (int32 Y = FMath::Max(CellY - Reach, 0); Y <= FMath::Min(CellY + Reach, GridHeight - 1); Y++)
+    {
+        for (int32 X = FMath::Max(CellX - Reach, 0); X <= FMath::Min(CellX + Reach, GridWidth - 1); X++)
+        {
+            for (int32 PointIndex : Cells[Y * GridWidth + X])
+            {
+                if (FVector2D::DistSquared(Points[PointIndex], Center) < FMath::Square(Radii[PointIndex] + Radius))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void FPoissonDiskSampler::Insert(const FVector2D& Center, float Radius)
+{
+    Cells[GetCell(Center)].Add(Points.Num());
+    Points.Add(Center);
+    Radii.Add(Radius);
+    MaxRadius = FMath::Max(MaxRadius, Radius);
+}
+
+int32 FPoissonDiskSampler::GetCell(const FVector2D& Location) const
+{
+    const int32 CellX = FMath::Clamp(FMath::FloorToInt((Location.X - Area.Min.X) / CellSize), 0, GridWidth - 1);
+    const int32 CellY = FMath::Clamp(FMath::FloorToInt((Location.Y - Area.Min.Y) / CellSize), 0, GridHeight - 1);
+    return CellY * GridWidth + CellX;
+}
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+/**
+ * Scatters non-overlapping circles over a rectangle with Poisson-disk sampling (Bridson's algorithm).
+ * Several radii can share one sampler: every call adds circles that keep clear of all the earlier ones,
+ * so the biggest props should go in first. Plain data, safe to run on a worker thread.
+ * The same seed and calls give the same points on every machine.
+ */
+class TESTINGGROUNDS_API FPoissonDiskSampler
+{
+public:
+    // CellSize trades lookup cost against memory, about the diameter of the smallest circle works best
+    FPoissonDiskSampler(const FBox2D& InArea, float InCellSize, int32 Seed);
+
+    // Adds up to MaxPoints circles of the given radius and appends their centers to OutPoints. Returns the number added
+    int32 AddPoints(float Radius, int32 MaxPoints, TArray<FVector2D>& OutPoints, int32 AttemptsPerPoint = 30);
+
+    int32 GetNumPoints() const { return Points.Num(); }
+
+    // The radius that lets about NumPoints circles fit in the area
+    static float GetRadiusForCount(const FBox2D& Area, int32 NumPoints);
+
+private:
+    // True if a circle fits there without overlapping another one
+    bool IsFree(const FVector2D& Center, float Radius) const;
+
+    void Insert(const FVector2D& Center, float Radius);
+
+    int32 GetCell(const FVector2D& Location) const;
+
+    FBox2D Area;
+    float CellSize;
+    int32 GridWidth;
+    int32 GridHeight;
+
+    // The circles of every cell
+    TArray<TArray<int32, TInlineAllocator<4>>> Cells;
+
+    TArray<FVector2D> Points;
+    TArray<float> Radii;
+    float MaxRadius = 0.f;
+
+    FRandomStream Random;
+};
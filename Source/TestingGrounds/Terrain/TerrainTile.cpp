@@ -0,0 +1,296 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "TerrainTile.h"
+#include "PoissonDiskSampler.h"
+#include "Async/Async.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogTerrainTile, Log, All);
+
+
+// Sets default values
+ATerrainTile::ATerrainTile()
+{
+    // Placement is driven by the tile streamer, within its frame budget
+	PrimaryActorTick.bCanEverTick = false;
+
+    RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+void ATerrainTile::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    for (FTilePropPool& Pool : PropPools)
+    {
+        for (AActor* Prop : Pool.Actors)
+        {
+            if (Prop) Prop->Destroy();
+        }
+    }
+    PropPools.Empty();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void ATerrainTile::Recycle(int32 InTileIndex, const FVector& Location)
+{
+    // The first recycle, everything after that only moves the tile
+    if (TileIndex == INDEX_NONE)
+    {
+        WarnAboutUnplacedProps();
+
+        TInlineComponentArray<UPrimitiveComponent*> Primitives;
+        GetComponents(Primitives);
+        for (UPrimitiveComponent* Primitive : Primitives)
+        {
+            if (Primitive->IsCollisionEnabled() && !MeshComponents.Contains(Primitive)) GroundComponents.Add(Primitive);
+        }
+    }
+
+    TileIndex = InTileIndex;
+    SetActorLocation(Location);
+
+    // Hidden props don't get in the way of the new layout
+    PropPools.SetNum(Props.Num());
+    for (FTilePropPool& Pool : PropPools)
+    {
+        for (AActor* Prop : Pool.Actors)
+        {
+            if (Prop == nullptr) continue;
+            Prop->SetActorHiddenInGame(true);
+            Prop->SetActorEnableCollision(false);
+        }
+        Pool.NumInUse = 0;
+    }
+
+    MeshComponents.SetNum(MeshProps.Num());
+    for (int32 i = 0; i < MeshComponents.Num(); i++)
+    {
+        if (MeshComponents[i] == nullptr)
+        {
+            MeshComponents[i] = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+            MeshComponents[i]->SetMobility(EComponentMobility::Movable);
+            MeshComponents[i]->AttachToComponent(RootComponent, FAttachmentTransformRules::KeepRelativeTransform);
+            MeshComponents[i]->RegisterComponent();
+        }
+        MeshComponents[i]->ClearInstances();
+    }
+
+    // Seeded by the slot, so a slot looks the same whenever and wherever it's built.
+    // A layout still sampling for the previous slot is dropped when it comes in
+    const FBox Area(PropAreaMin, PropAreaMax);
+    const TArray<FTilePropSpawn> PropsCopy = Props;
+    const TArray<FTileMeshSpawn> MeshPropsCopy = MeshProps;
+    const int32 Seed = TileIndex;
+    PendingLayout = Async<FTileLayout>(EAsyncExecution::ThreadPool, [Seed, Area, PropsCopy, MeshPropsCopy]()
+    {
+        return ComputeLayout(Seed, Area, PropsCopy, MeshPropsCopy);
+    });
+
+    bHasLayout = false;
+    bPlacingProps = true;
+    NextKind = 0;
+    NextItem = 0;
+}
+
+bool ATerrainTile::PlaceProps(double Deadline)
+{
+    if (!bPlacingProps) return true;
+
+    if (!bHasLayout)
+    {
+        if (!PendingLayout.IsValid() || !PendingLayout.IsReady()) return false;
+        Layout = PendingLayout.Get();
+        PendingLayout = TFuture<FTileLayout>();
+        bHasLayout = true;
+    }
+
+    // Actors first, then the instanced meshes
+    const int32 NumKinds = Props.Num() + MeshProps.Num();
+    while (NextKind < NumKinds && FPlatformTime::Seconds() < Deadline)
+    {
+        if (NextKind < Props.Num())
+        {
+            // Clients get the server's props through replication
+            if (!SpawnsActorProps())
+            {
+                NextKind = Props.Num();
+                continue;
+            }
+
+            const FTilePropSpawn& Spawn = Props[NextKind];
+            const TArray<FTransform>& Transforms = Layout.ActorTransforms[NextKind];
+
+            // Still loading, the tile waits for it
+            if (!Spawn.PropClass.IsNull() && Spawn.PropClass.Get() == nullptr) return false;
+
+            if (NextItem < Transforms.Num() && Spawn.PropClass.Get())
+            {
+                PlaceActorProp(NextKind, GetGroundedTransform(Transforms[NextItem]));
+                NextItem++;
+                continue;
+            }
+        }
+        else
+        {
+            const int32 MeshIndex = NextKind - Props.Num();
+            const FTileMeshSpawn& Spawn = MeshProps[MeshIndex];
+            const TArray<FTransform>& Transforms = Layout.MeshTransforms[MeshIndex];
+            UHierarchicalInstancedStaticMeshComponent* MeshComponent = MeshComponents[MeshIndex];
+
+            if (!Spawn.Mesh.IsNull() && Spawn.Mesh.Get() == nullptr) return false;
+
+            if (NextItem < Transforms.Num() && Spawn.Mesh.Get() && MeshComponent)
+            {
+                if (MeshComponent->StaticMesh != Spawn.Mesh.Get()) MeshComponent->SetStaticMesh(Spawn.Mesh.Get());
+
+                const int32 BatchEnd = FMath::Min(NextItem + FMath::Max(InstancesPerBatch, 1), Transforms.Num());
+                for (; NextItem < BatchEnd; NextItem++) MeshComponent->AddInstanceWorldSpace(GetGroundedTransform(Transforms[NextItem]));
+                continue;
+            }
+        }
+
+        NextKind++;
+        NextItem = 0;
+    }
+
+    bPlacingProps = (NextKind < NumKinds);
+    return !bPlacingProps;
+}
+
+void ATerrainTile::GetPropAssets(TArray<FStringAssetReference>& OutAssets) const
+{
+    for (const FTilePropSpawn& Spawn : Props)
+    {
+        if (!Spawn.PropClass.IsNull()) OutAssets.AddUnique(Spawn.PropClass.ToStringReference());
+    }
+    for (const FTileMeshSpawn& Spawn : MeshProps)
+    {
+        if (!Spawn.Mesh.IsNull()) OutAssets.AddUnique(Spawn.Mesh.ToStringReference());
+    }
+}
+
+FTileLayout ATerrainTile::ComputeLayout(int32 Seed, const FBox& Area, const TArray<FTilePropSpawn>& Props, const TArray<FTileMeshSpawn>& MeshProps)
+{
+    FRandomStream Random(Seed);
+
+    // Every kind as a radius and a count; actors are indices into Props, meshes follow them
+    struct FKind
+    {
+        int32 Index;
+        float Radius;
+        int32 Count;
+    };
+    TArray<FKind> Kinds;
+    for (int32 i = 0; i < Props.Num(); i++)
+    {
+        Kinds.Add({ i, Props[i].Radius, Random.RandRange(Props[i].MinCount, Props[i].MaxCount) });
+    }
+    for (int32 i = 0; i < MeshProps.Num(); i++)
+    {
+        Kinds.Add({ Props.Num() + i, MeshProps[i].Radius, Random.RandRange(MeshProps[i].MinCount, MeshProps[i].MaxCount) });
+    }
+
+    FTileLayout Result;
+    Result.ActorTransforms.SetNum(Props.Num());
+    Result.MeshTransforms.SetNum(MeshProps.Num());
+
+    float MinRadius = MAX_flt;
+    for (const FKind& Kind : Kinds)
+    {
+        if (Kind.Count > 0 && Kind.Radius > 0.f) MinRadius = FMath::Min(MinRadius, Kind.Radius);
+    }
+    if (MinRadius == MAX_flt) return Result;
+
+    // Big props first, the small ones fill the gaps
+    Kinds.StableSort([](const FKind& A, const FKind& B) { return A.Radius > B.Radius; });
+
+    const FBox2D Area2D(FVector2D(Area.Min), FVector2D(Area.Max));
+    FPoissonDiskSampler Sampler(Area2D, 2.f * MinRadius, Seed);
+    TArray<FVector2D> Points;
+    for (const FKind& Kind : Kinds)
+    {
+        Points.Reset();
+        Sampler.AddPoints(Kind.Radius, Kind.Count, Points);
+
+        const bool bMesh = (Kind.Index >= Props.Num());
+        const float MinScale = bMesh ? MeshProps[Kind.Index - Props.Num()].MinScale : 1.f;
+        const float MaxScale = bMesh ? MeshProps[Kind.Index - Props.Num()].MaxScale : 1.f;
+        TArray<FTransform>& Transforms = bMesh ? Result.MeshTransforms[Kind.Index - Props.Num()] : Result.ActorTransforms[Kind.Index];
+        Transforms.Reserve(Points.Num());
+        for (const FVector2D& Point : Points)
+        {
+            const FVector Location(Point.X, Point.Y, Random.FRandRange(Area.Min.Z, Area.Max.Z));
+            const FRotator Rotation(0.f, Random.FRandRange(-180.f, 180.f), 0.f);
+            Transforms.Add(FTransform(Rotation, Location, FVector(Random.FRandRange(MinScale, MaxScale))));
+        }
+    }
+    return Result;
+}
+
+FTransform ATerrainTile::GetGroundedTransform(const FTransform& LocalTransform) const
+{
+    FTransform Transform = LocalTransform * GetActorTransform();
+    if (GroundTraceHeight <= 0.f) return Transform;
+
+    // Only the tile's own collision counts, props placed before don't stack up
+    const FVector Location = Transform.GetLocation();
+    const FVector Start = Location + FVector(0.f, 0.f, GroundTraceHeight);
+    const FVector End = Location - FVector(0.f, 0.f, GroundTraceHeight);
+    static const FName GroundTraceName(TEXT("TileGroundTrace"));
+    const FCollisionQueryParams Params(GroundTraceName, false);
+
+    float GroundZ = -MAX_flt;
+    for (UPrimitiveComponent* Ground : GroundComponents)
+    {
+        FHitResult Hit;
+        if (Ground && Ground->LineTraceComponent(Hit, Start, End, Params)) GroundZ = FMath::Max(GroundZ, Hit.ImpactPoint.Z);
+    }
+    if (GroundZ > -MAX_flt) Transform.SetLocation(FVector(Location.X, Location.Y, GroundZ));
+    return Transform;
+}
+
+void ATerrainTile::WarnAboutUnplacedProps() const
+{
+    for (int32 i = 0; i < Props.Num(); i++)
+    {
+        if (Props[i].Radius <= 0.f && Props[i].MaxCount > 0)
+        {
+            UE_LOG(LogTerrainTile, Warning, TEXT("%s: Props[%d] has no radius and never gets placed"), *GetClass()->GetName(), i);
+        }
+    }
+    for (int32 i = 0; i < MeshProps.Num(); i++)
+    {
+        if (MeshProps[i].Radius <= 0.f && MeshProps[i].MaxCount > 0)
+        {
+            UE_LOG(LogTerrainTile, Warning, TEXT("%s: MeshProps[%d] has no radius and never gets placed"), *GetClass()->GetName(), i);
+        }
+    }
+}
+
+void ATerrainTile::PlaceActorProp(int32 SpawnIndex, const FTransform& Transform)
+{
+    FTilePropPool& Pool = PropPools[SpawnIndex];
+
+    if (Pool.NumInUse < Pool.Actors.Num() && Pool.Actors[Pool.NumInUse])
+    {
+        AActor* Prop = Pool.Actors[Pool.NumInUse];
+        Prop->SetActorTransform(Transform);
+        Prop->SetActorHiddenInGame(false);
+        Prop->SetActorEnableCollision(true);
+        Pool.NumInUse++;
+        return;
+    }
+
+    // Only the first visits of a tile spawn, the pool covers the rest.
+    // Every prop replicates, moving along when the tile gets recycled
+    AActor* Prop = GetWorld()->SpawnActorDeferred<AActor>(Props[SpawnIndex].PropClass.Get(), Transform, this, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+    if (Prop == nullptr) return;
+    Prop->SetReplicates(true);
+    Prop->SetReplicateMovement(true);
+    UGameplayStatics::FinishSpawningActor(Prop, Transform);
+
+    if (Pool.NumInUse < Pool.Actors.Num()) Pool.Actors[Pool.NumInUse] = Prop;
+    else Pool.Actors.Add(Prop);
+    Pool.NumInUse++;
+}
@@ -0,0 +1,175 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "Async/Future.h"
+#include "TerrainTile.generated.h"
+
+class UHierarchicalInstancedStaticMeshComponent;
+
+// One kind of actor scattered over a tile, for props with gameplay of their own. Spawned by the server and replicated
+USTRUCT()
+struct FTilePropSpawn
+{
+    GENERATED_BODY()
+
+    // Loaded asynchronously by the tile streamer, tiles wait for it before placing the prop
+    UPROPERTY(EditAnywhere)
+    TAssetSubclassOf<AActor> PropClass;
+
+    UPROPERTY(EditAnywhere)
+    int32 MinCount = 0;
+
+    UPROPERTY(EditAnywhere)
+    int32 MaxCount = 5;
+
+    // Room the prop needs around it, free of other props
+    UPROPERTY(EditAnywhere)
+    float Radius = 300.f;
+};
+
+// One kind of static mesh scattered over a tile, drawn as instances of a single component
+USTRUCT()
+struct FTileMeshSpawn
+{
+    GENERATED_BODY()
+
+    // Loaded asynchronously by the tile streamer, tiles wait for it before adding the instances
+    UPROPERTY(EditAnywhere)
+    TAssetPtr<UStaticMesh> Mesh;
+
+    UPROPERTY(EditAnywhere)
+    int32 MinCount = 0;
+
+    UPROPERTY(EditAnywhere)
+    int32 MaxCount = 100;
+
+    // Room an instance needs around it, free of other props
+    UPROPERTY(EditAnywhere)
+    float Radius = 100.f;
+
+    UPROPERTY(EditAnywhere)
+    float MinScale = 1.f;
+
+    UPROPERTY(EditAnywhere)
+    float MaxScale = 1.f;
+};
+
+// The prop actors a tile owns for one kind of prop, reused every time the tile is recycled
+USTRUCT()
+struct FTilePropPool
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    TArray<AActor*> Actors;
+
+    int32 NumInUse = 0;
+};
+
+// Where every prop of a tile goes, in tile space. One array per entry of Props and MeshProps
+struct FTileLayout
+{
+    TArray<TArray<FTransform>> ActorTransforms;
+    TArray<TArray<FTransform>> MeshTransforms;
+};
+
+/**
+ * A piece of the infinite terrain. Tiles are never destroyed while the game runs:
+ * ATileStreamer moves them ahead of the players and they place their props again.
+ * The layout is Poisson-disk sampled on a worker thread, then the props are placed a few per frame;
+ * meshes as instances, actors from a pool.
+ * The props of a tile index are the same every time. Every machine adds the mesh instances of its own tiles,
+ * the actor props are only spawned on the server and replicate to the clients.
+ */
+UCLASS()
+class TESTINGGROUNDS_API ATerrainTile : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ATerrainTile();
+
+    // Destroys the props along with the tile
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    // Moves the tile to the given slot, clears its props and starts computing the new layout
+    void Recycle(int32 InTileIndex, const FVector& Location);
+
+    // Places props of the computed layout until the platform time reaches Deadline. Returns true once every prop is placed
+    bool PlaceProps(double Deadline);
+
+    bool HasPendingProps() const { return bPlacingProps; }
+
+    // The slot the tile covers, INDEX_NONE before its first recycle
+    int32 GetTileIndex() const { return TileIndex; }
+
+    // Adds the prop classes and meshes the tile needs loaded
+    void GetPropAssets(TArray<FStringAssetReference>& OutAssets) const;
+
+    // Samples the layout of a tile. Pure function of its arguments, runs on any thread
+    static FTileLayout ComputeLayout(int32 Seed, const FBox& Area, const TArray<FTilePropSpawn>& Props, const TArray<FTileMeshSpawn>& MeshProps);
+
+protected:
+    UPROPERTY(EditDefaultsOnly, Category = "Terrain")
+    TArray<FTilePropSpawn> Props;
+
+    UPROPERTY(EditDefaultsOnly, Category = "Terrain")
+    TArray<FTileMeshSpawn> MeshProps;
+
+    // The local area props are placed in. The layout picks a height between the Z of both corners,
+    // which is where the props stay on tiles that don't trace to the ground
+    UPROPERTY(EditDefaultsOnly, Category = "Terrain")
+    FVector PropAreaMin = FVector(0.f, -2000.f, 0.f);
+
+    UPROPERTY(EditDefaultsOnly, Category = "Terrain")
+    FVector PropAreaMax = FVector(4000.f, 2000.f, 0.f);
+
+    // How far above and below its sampled height a prop looks for the tile's own collision to stand on.
+    // 0 skips the trace, for flat tiles
+    UPROPERTY(EditDefaultsOnly, Category = "Terrain")
+    float GroundTraceHeight = 2000.f;
+
+    // Instances added between two checks of the frame budget
+    UPROPERTY(EditDefaultsOnly, Category = "Terrain")
+    int32 InstancesPerBatch = 64;
+
+private:
+    // Shows the next pooled prop of the given kind, spawning it if the pool is short. Server only
+    void PlaceActorProp(int32 SpawnIndex, const FTransform& Transform);
+
+    // True where the actor props get spawned. The tile itself is local, so its role doesn't tell
+    bool SpawnsActorProps() const { return GetNetMode() != NM_Client; }
+
+    // Returns the world transform of a layout transform, moved down or up onto the ground of the tile
+    FTransform GetGroundedTransform(const FTransform& LocalTransform) const;
+
+    // Warns about the kinds of props the sampler never places
+    void WarnAboutUnplacedProps() const;
+
+    // The collision of the tile itself, which the props get traced onto. Gathered on the first recycle
+    UPROPERTY(Transient)
+    TArray<UPrimitiveComponent*> GroundComponents;
+
+    // One pool per entry of Props
+    UPROPERTY()
+    TArray<FTilePropPool> PropPools;
+
+    // One component per entry of MeshProps
+    UPROPERTY()
+    TArray<UHierarchicalInstancedStaticMeshComponent*> MeshComponents;
+
+    // The layout being sampled, then the one being placed
+    TFuture<FTileLayout> PendingLayout;
+    FTileLayout Layout;
+    bool bHasLayout = false;
+    bool bPlacingProps = false;
+
+    // Where placement resumes next frame
+    int32 NextKind = 0;
+    int32 NextItem = 0;
+
+    int32 TileIndex = INDEX_NONE;
+};
@@ -0,0 +1,158 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "TileStreamer.h"
+#include "TerrainTile.h"
+
+// Use "stat TileStreaming" to check tile transitions stay within the frame budget
+DECLARE_STATS_GROUP(TEXT("TileStreaming"), STATGROUP_TileStreaming, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Tile Streaming Total"), STAT_TileStreamingTotal, STATGROUP_TileStreaming);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Tiles Recycled"), STAT_TilesRecycled, STATGROUP_TileStreaming);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Tiles Placing Props"), STAT_TilesPlacingProps, STATGROUP_TileStreaming);
+
+
+// Sets default values
+ATileStreamer::ATileStreamer()
+{
+	PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+    // Every machine streams its own tiles and meshes, the actor props come from the server
+    bReplicates = true;
+    bAlwaysRelevant = true;
+
+    TileClass = ATerrainTile::StaticClass();
+}
+
+void ATileStreamer::BeginPlay()
+{
+    Super::BeginPlay();
+
+    if (TileClass == nullptr) return;
+
+    // Props show up on the tiles as their classes come in
+    TArray<FStringAssetReference> PropAssets;
+    TileClass->GetDefaultObject<ATerrainTile>()->GetPropAssets(PropAssets);
+    if (PropAssets.Num() > 0)
+    {
+        Streamable.RequestAsyncLoad(PropAssets, FStreamableDelegate());
+    }
+
+    // The whole ring up front, while the level loads anyway
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.Owner = this;
+    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+    for (int32 i = 0; i < NumTiles; i++)
+    {
+        ATerrainTile* Tile = GetWorld()->SpawnActor<ATerrainTile>(TileClass, GetActorLocation(), GetActorRotation(), SpawnParams);
+        if (Tile) Tiles.Add(Tile);
+    }
+
+    int32 FirstSlot = 0;
+    int32 LastSlot = NumTiles - 1;
+    GetWantedSlots(FirstSlot, LastSlot);
+    RecycleTiles(FirstSlot, LastSlot, MAX_dbl);
+}
+
+void ATileStreamer::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    for (ATerrainTile* Tile : Tiles)
+    {
+        if (Tile) Tile->Destroy();
+    }
+    Tiles.Empty();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void ATileStreamer::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+    SCOPE_CYCLE_COUNTER(STAT_TileStreamingTotal);
+
+    const double Deadline = FPlatformTime::Seconds() + FrameBudgetMs / 1000.0;
+
+    int32 FirstSlot, LastSlot;
+    if (GetWantedSlots(FirstSlot, LastSlot))
+    {
+        RecycleTiles(FirstSlot, LastSlot, Deadline);
+    }
+
+    // Lowest slots first, so the props next to the players come in before the ones far ahead
+    Tiles.Remove(nullptr);
+    Tiles.Sort([](const ATerrainTile& A, const ATerrainTile& B) { return A.GetTileIndex() < B.GetTileIndex(); });
+
+    int32 NumPlacing = 0;
+    for (ATerrainTile* Tile : Tiles)
+    {
+        if (Tile == nullptr || !Tile->HasPendingProps()) continue;
+        if (FPlatformTime::Seconds() < Deadline) Tile->PlaceProps(Deadline);
+        if (Tile->HasPendingProps()) NumPlacing++;
+    }
+    SET_DWORD_STAT(STAT_TilesPlacingProps, NumPlacing);
+}
+
+bool ATileStreamer::GetWantedSlots(int32& OutFirst, int32& OutLast) const
+{
+    int32 MinSlot = MAX_int32;
+    int32 MaxSlot = MIN_int32;
+    int32 PrefetchSlot = MIN_int32;
+    for (FConstPawnIterator It = GetWorld()->GetPawnIterator(); It; ++It)
+    {
+        const APawn* Pawn = *It;
+        if (Pawn == nullptr || !Pawn->IsPlayerControlled()) continue;
+
+        const float X = GetActorTransform().InverseTransformPosition(Pawn->GetActorLocation()).X;
+        const float VelocityX = GetActorTransform().InverseTransformVector(Pawn->GetVelocity()).X;
+        MinSlot = FMath::Min(MinSlot, GetSlot(X));
+        MaxSlot = FMath::Max(MaxSlot, GetSlot(X));
+        PrefetchSlot = FMath::Max(PrefetchSlot, GetSlot(X + FMath::Max(VelocityX, 0.f) * PrefetchSeconds));
+    }
+    if (MinSlot == MAX_int32) return false;
+
+    // Everyone's tile and the ones behind them, then as far ahead as the ring reaches
+    OutFirst = MinSlot - TilesBehind;
+    OutLast = FMath::Max(OutFirst + NumTiles - 1, FMath::Max(MaxSlot, PrefetchSlot));
+    if (OutLast - OutFirst + 1 > NumTiles)
+    {
+        // Too short for everything. The players' own tiles win over the ones behind and ahead
+        OutFirst = FMath::Min(MinSlot, OutLast - NumTiles + 1);
+        OutLast = OutFirst + NumTiles - 1;
+    }
+    return true;
+}
+
+void ATileStreamer::RecycleTiles(int32 FirstSlot, int32 LastSlot, double Deadline)
+{
+    TArray<ATerrainTile*> FreeTiles;
+    TBitArray<> SlotCovered(false, LastSlot - FirstSlot + 1);
+    for (ATerrainTile* Tile : Tiles)
+    {
+        if (Tile == nullptr) continue;
+
+        const int32 Slot = Tile->GetTileIndex();
+        if (Slot != INDEX_NONE && Slot >= FirstSlot && Slot <= LastSlot && !SlotCovered[Slot - FirstSlot])
+        {
+            SlotCovered[Slot - FirstSlot] = true;
+        }
+        else
+        {
+            FreeTiles.Add(Tile);
+        }
+    }
+
+    for (int32 Slot = FirstSlot; Slot <= LastSlot && FreeTiles.Num() > 0; Slot++)
+    {
+        if (SlotCovered[Slot - FirstSlot]) continue;
+        if (FPlatformTime::Seconds() >= Deadline) break;
+
+        const FVector Location = GetActorTransform().TransformPosition(FVector(Slot * TileLength, 0.f, 0.f));
+        FreeTiles.Pop(false)->Recycle(Slot, Location);
+        INC_DWORD_STAT(STAT_TilesRecycled);
+    }
+}
+
+int32 ATileStreamer::GetSlot(float X) const
+{
+    return FMath::FloorToInt(X / TileLength);
+}
@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "Engine/StreamableManager.h"
+#include "TileStreamer.generated.h"
+
+class ATerrainTile;
+
+/**
+ * Streams the infinite terrain with a fixed ring of tiles laid out along X from the streamer's location.
+ * Tiles behind the players are recycled to the front, far enough ahead to cover where the players
+ * will be in PrefetchSeconds. Recycling and prop placement share a budget of FrameBudgetMs per frame,
+ * and the prop classes load asynchronously.
+ * Spawned by the game mode on the server and relevant to every client, which streams its own tiles.
+ * The tiles and their mesh props don't replicate; a tile index looks the same on every machine.
+ * Actor props have gameplay of their own, so only the server spawns them and they replicate.
+ */
+UCLASS()
+class TESTINGGROUNDS_API ATileStreamer : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ATileStreamer();
+
+    // Spawns the ring and starts loading the props
+    virtual void BeginPlay() override;
+
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    // Recycles the tiles that fell behind and places props, within the frame budget
+    virtual void Tick(float DeltaSeconds) override;
+
+protected:
+    UPROPERTY(EditAnywhere, Category = "Terrain")
+    TSubclassOf<ATerrainTile> TileClass;
+
+    // Tiles in the ring. Never more are spawned
+    UPROPERTY(EditAnywhere, Category = "Terrain")
+    int32 NumTiles = 5;
+
+    // Length of a tile along X
+    UPROPERTY(EditAnywhere, Category = "Terrain")
+    float TileLength = 4000.f;
+
+    // Tiles kept behind the last player
+    UPROPERTY(EditAnywhere, Category = "Terrain")
+    int32 TilesBehind = 1;
+
+    // The ring reaches as far as the players run in this many seconds, as far as it's long enough
+    UPROPERTY(EditAnywhere, Category = "Terrain")
+    float PrefetchSeconds = 3.f;
+
+    // Milliseconds per frame recycling and prop placement may take
+    UPROPERTY(EditAnywhere, Category = "Terrain")
+    float FrameBudgetMs = 2.f;
+
+private:
+    // Finds the tile slots the ring should cover from the players' locations and velocities
+    bool GetWantedSlots(int32& OutFirst, int32& OutLast) const;
+
+    // Recycles tiles outside the wanted slots to the slots nobody covers, until Deadline
+    void RecycleTiles(int32 FirstSlot, int32 LastSlot, double Deadline);
+
+    int32 GetSlot(float X) const;
+
+    UPROPERTY()
+    TArray<ATerrainTile*> Tiles;
+
+    FStreamableManager Streamable;
+};
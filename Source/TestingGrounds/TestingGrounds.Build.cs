@@ -7,5 +7,8 @@ public class TestingGrounds : ModuleRules
 	public TestingGrounds(TargetInfo Target)
 	{
 		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "AIModule", "GameplayTasks", "UMG", "Slate", "SlateCore" });
+
+		// IpNetDriver, extended by the load test net driver
+		PrivateDependencyModuleNames.AddRange(new string[] { "OnlineSubsystemUtils" });
 	}
 }
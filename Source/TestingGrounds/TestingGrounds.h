@@ -11,4 +11,7 @@
 #include "Runtime/UMG/Public/IUMGModule.h"
 #include "Net/UnrealNetwork.h"
 
+// Trace channel used to find items the player can interact with (see DefaultEngine.ini)
+#define ECC_Interactable ECC_GameTraceChannel2
+
 #endif
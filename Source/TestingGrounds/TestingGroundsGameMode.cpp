@@ -4,14 +4,37 @@
 #include "TestingGroundsGameMode.h"
 #include "TestingGroundsHUD.h"
 #include "Player/FirstPersonCharacter.h"
+#include "Terrain/TileStreamer.h"
+#include "GameFramework/DefaultPawn.h"
 
 ATestingGroundsGameMode::ATestingGroundsGameMode()
 	: Super()
 {
-	// set default pawn class to our Blueprinted character
-	static ConstructorHelpers::FClassFinder<APawn> PlayerPawnClassFinder(TEXT("/Game/Dynamic/Player/Behavior/FirstPersonCharacter"));
-	DefaultPawnClass = PlayerPawnClassFinder.Class;
+	// set default pawn class to our Blueprinted character, loaded with the map in InitGame
+	DefaultPawnAsset = FStringAssetReference(TEXT("/Game/Dynamic/Player/Behavior/FirstPersonCharacter.FirstPersonCharacter_C"));
 
 	// use our custom HUD class
 	HUDClass = ATestingGroundsHUD::StaticClass();
 }
+
+void ATestingGroundsGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	// Subclasses that picked a pawn class of their own keep it
+	if (DefaultPawnClass == ADefaultPawn::StaticClass() && !DefaultPawnAsset.IsNull())
+	{
+		UClass* PawnClass = StaticLoadClass(APawn::StaticClass(), nullptr, *DefaultPawnAsset.ToStringReference().ToString());
+		if (PawnClass) DefaultPawnClass = PawnClass;
+	}
+
+	Super::InitGame(MapName, Options, ErrorMessage);
+}
+
+void ATestingGroundsGameMode::StartPlay()
+{
+	Super::StartPlay();
+
+	if (TileStreamerClass)
+	{
+		GetWorld()->SpawnActor<ATileStreamer>(TileStreamerClass, FTransform::Identity);
+	}
+}
@@ -3,6 +3,8 @@
 #include "GameFramework/GameMode.h"
 #include "TestingGroundsGameMode.generated.h"
 
+class ATileStreamer;
+
 UCLASS(minimalapi)
 class ATestingGroundsGameMode : public AGameMode
 {
@@ -10,6 +12,21 @@ class ATestingGroundsGameMode : public AGameMode
 
 public:
 	ATestingGroundsGameMode();
+
+	// Loads the default pawn class, now that a map actually needs it
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+
+	// Spawns the tile streamer, if the mode streams its terrain natively
+	virtual void StartPlay() override;
+
+protected:
+	// The pawn players get unless a subclass picks its own. Soft, so loading the module doesn't load the character
+	UPROPERTY(EditDefaultsOnly, Category = "Classes")
+	TAssetSubclassOf<APawn> DefaultPawnAsset;
+
+	// Streams the infinite terrain. Leave empty for modes that build their terrain themselves
+	UPROPERTY(EditDefaultsOnly, Category = "Terrain")
+	TSubclassOf<ATileStreamer> TileStreamerClass;
 };
 
 
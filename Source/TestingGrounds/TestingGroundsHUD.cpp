@@ -5,12 +5,25 @@
 #include "Engine/Canvas.h"
 #include "TextureResource.h"
 #include "CanvasItem.h"
+#include "AssetPreloader.h"
 
 ATestingGroundsHUD::ATestingGroundsHUD()
 {
-	// Set the crosshair texture
-	static ConstructorHelpers::FObjectFinder<UTexture2D> CrosshiarTexObj(TEXT("/Game/Static/Player/Textures/FirstPersonCrosshair"));
-	CrosshairTex = CrosshiarTexObj.Object;
+	// Set the crosshair texture, loaded in BeginPlay
+	CrosshairTex = FStringAssetReference(TEXT("/Game/Static/Player/Textures/FirstPersonCrosshair.FirstPersonCrosshair"));
+
+	LoadingText = NSLOCTEXT("TestingGroundsHUD", "Loading", "Loading...");
+}
+
+void ATestingGroundsHUD::BeginPlay()
+{
+	Super::BeginPlay();
+
+	AAssetPreloader* Preloader = AAssetPreloader::Get(GetWorld());
+	if (Preloader)
+	{
+		Preloader->RequestAssets(EAssetBundle::UI, { CrosshairTex.ToStringReference() });
+	}
 }
 
 
@@ -18,6 +31,16 @@ void ATestingGroundsHUD::DrawHUD()
 {
 	Super::DrawHUD();
 
+	AAssetPreloader* Preloader = AAssetPreloader::Get(GetWorld());
+	if (Preloader && Preloader->IsLoading())
+	{
+		DrawLoadingScreen();
+		return;
+	}
+
+	UTexture2D* CrosshairTexture = CrosshairTex.Get();
+	if (CrosshairTexture == nullptr) return;
+
 	// Draw very simple crosshair
 
 	// find center of the Canvas
@@ -28,8 +51,20 @@ void ATestingGroundsHUD::DrawHUD()
 										   (Center.Y));
 
 	// draw the crosshair
-	FCanvasTileItem TileItem( CrosshairDrawPosition, CrosshairTex->Resource, FLinearColor::White);
+	FCanvasTileItem TileItem( CrosshairDrawPosition, CrosshairTexture->Resource, FLinearColor::White);
 	TileItem.BlendMode = SE_BLEND_Translucent;
 	Canvas->DrawItem( TileItem );
 }
 
+void ATestingGroundsHUD::DrawLoadingScreen()
+{
+	// A black screen with the text in the middle - the font is the engine's, always resident
+	FCanvasTileItem Background(FVector2D::ZeroVector, FVector2D(Canvas->ClipX, Canvas->ClipY), FLinearColor::Black);
+	Canvas->DrawItem(Background);
+
+	FCanvasTextItem TextItem(FVector2D(Canvas->ClipX * 0.5f, Canvas->ClipY * 0.5f), LoadingText, GEngine->GetLargeFont(), FLinearColor::White);
+	TextItem.bCentreX = true;
+	TextItem.bCentreY = true;
+	Canvas->DrawItem(TextItem);
+}
+
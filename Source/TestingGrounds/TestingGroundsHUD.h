@@ -11,12 +11,24 @@ class ATestingGroundsHUD : public AHUD
 public:
 	ATestingGroundsHUD();
 
+	/** Requests the UI assets */
+	virtual void BeginPlay() override;
+
 	/** Primary draw call for the HUD */
 	virtual void DrawHUD() override;
 
+protected:
+	/** Crosshair asset, loaded with the UI bundle */
+	UPROPERTY(EditDefaultsOnly, Category = "HUD")
+	TAssetPtr<UTexture2D> CrosshairTex;
+
+	/** Drawn over the screen while the world's assets load */
+	UPROPERTY(EditDefaultsOnly, Category = "HUD")
+	FText LoadingText;
+
 private:
-	/** Crosshair asset pointer */
-	class UTexture2D* CrosshairTex;
+	/** Covers the screen while the preloader is busy */
+	void DrawLoadingScreen();
 
 };
 
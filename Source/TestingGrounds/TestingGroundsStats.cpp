@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "TestingGroundsStats.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogTGStats, Log, All);
+
+DEFINE_STAT(STAT_TGRaycast);
+DEFINE_STAT(STAT_TGGunFire);
+DEFINE_STAT(STAT_TGBombExplode);
+DEFINE_STAT(STAT_TGChooseNextWaypoint);
+DEFINE_STAT(STAT_TGSpawnBomb);
+DEFINE_STAT(STAT_TGSkills);
+DEFINE_STAT(STAT_TGAdvanceTimers);
+DEFINE_STAT(STAT_TGRecordHistory);
+DEFINE_STAT(STAT_TGValidateHits);
+DEFINE_STAT(STAT_TGSpawns);
+DEFINE_STAT(STAT_TGTraces);
+DEFINE_STAT(STAT_TGRPCsSent);
+DEFINE_STAT(STAT_TGRPCsReceived);
+DEFINE_STAT(STAT_TGRenderStateDirtied);
+DEFINE_STAT(STAT_TGRenderStateSkipped);
+DEFINE_STAT(STAT_TGTimersRun);
+DEFINE_STAT(STAT_TGHitsAccepted);
+DEFINE_STAT(STAT_TGHitsRejected);
+DEFINE_STAT(STAT_TGShotsFired);
+DEFINE_STAT(STAT_TGShotsConfirmed);
+DEFINE_STAT(STAT_TGShotsLost);
+DEFINE_STAT(STAT_TGPendingTimers);
+DEFINE_STAT(STAT_TGCompensatedCharacters);
+DEFINE_STAT(STAT_TGShotConfirmUs);
+
+bool FTGStatCapture::bCapturing = false;
+uint64 FTGStatCapture::FrameValues[(uint8)ETGStat::Num] = {};
+
+// The rows are kept in memory and written once, so the capture doesn't hitch on disk writes
+static FString CaptureCsv;
+static FString CapturePath;
+static FDelegateHandle CaptureEndFrameHandle;
+static uint64 CaptureFrame = 0;
+static double CaptureLastFrameTime = 0.0;
+
+void FTGStatCapture::Start(const FString& CsvPath)
+{
+    if (bCapturing) Stop();
+
+    bCapturing = true;
+    CapturePath = CsvPath;
+    CaptureFrame = 0;
+    CaptureLastFrameTime = FPlatformTime::Seconds();
+    FMemory::Memzero(FrameValues);
+
+    CaptureCsv = TEXT("Frame,FrameMs,RaycastMs,GunFireMs,BombExplodeMs,ChooseNextWaypointMs,SpawnBombMs,SkillsMs,AdvanceTimersMs,RecordHistoryMs,ValidateHitsMs,Spawns,Traces,RPCsSent,RPCsReceived,RenderStateDirtied,RenderStateSkipped,TimersRun,HitsAccepted,HitsRejected,ShotsFired,ShotsConfirmed,ShotsLost,PendingTimers,CompensatedCharacters,ShotConfirmUs\n");
+    CaptureEndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&FTGStatCapture::OnEndFrame);
+
+    UE_LOG(LogTGStats, Log, TEXT("Capturing TestingGrounds stats into %s"), *CapturePath);
+}
+
+void FTGStatCapture::Stop()
+{
+    if (!bCapturing) return;
+
+    bCapturing = false;
+    FCoreDelegates::OnEndFrame.Remove(CaptureEndFrameHandle);
+
+    if (FFileHelper::SaveStringToFile(CaptureCsv, *CapturePath))
+    {
+        UE_LOG(LogTGStats, Log, TEXT("Captured %llu frames into %s"), CaptureFrame, *CapturePath);
+    }
+    else
+    {
+        UE_LOG(LogTGStats, Error, TEXT("Couldn't write the captured stats to %s"), *CapturePath);
+    }
+    CaptureCsv.Empty();
+}
+
+void FTGStatCapture::OnEndFrame()
+{
+    const double Now = FPlatformTime::Seconds();
+    const double FrameMs = (Now - CaptureLastFrameTime) * 1000.0;
+    CaptureLastFrameTime = Now;
+
+    CaptureCsv += FString::Printf(TEXT("%llu,%.3f"), CaptureFrame++, FrameMs);
+    for (uint8 Stat = 0; Stat < (uint8)ETGStat::Num; Stat++)
+    {
+        // Timed stats come first and are written in milliseconds, the counters as they are
+        if (Stat < (uint8)ETGStat::Spawns)
+        {
+            CaptureCsv += FString::Printf(TEXT(",%.4f"), FPlatformTime::ToMilliseconds64(FrameValues[Stat]));
+        }
+        else
+        {
+            CaptureCsv += FString::Printf(TEXT(",%llu"), FrameValues[Stat]);
+        }
+        
+        // Set values carry over into the next frame
+        if (Stat < (uint8)ETGStat::PendingTimers) FrameValues[Stat] = 0;
+    }
+    CaptureCsv += TEXT("\n");
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Console commands
+
+static void StartStatCapture(const TArray<FString>& Args)
+{
+    const FString CsvPath = (Args.Num() > 0) ? Args[0] : FPaths::ProfilingDir() / TEXT("TestingGroundsStats.csv");
+    FTGStatCapture::Start(CsvPath);
+}
+
+static FAutoConsoleCommand StartStatCaptureCommand(
+    TEXT("tg.Stats.Capture"),
+    TEXT("Records the TestingGrounds stats of every frame as CSV until tg.Stats.StopCapture. Usage: tg.Stats.Capture [CsvPath]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&StartStatCapture));
+
+static FAutoConsoleCommand StopStatCaptureCommand(
+    TEXT("tg.Stats.StopCapture"),
+    TEXT("Writes the TestingGrounds stats recorded since tg.Stats.Capture"),
+    FConsoleCommandDelegate::CreateStatic(&FTGStatCapture::Stop));
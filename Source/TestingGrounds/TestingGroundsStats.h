@@ -0,0 +1,136 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Use "stat TestingGrounds" for the cost of the gameplay hot paths, and tg.Stats.Capture to record them per frame
+DECLARE_STATS_GROUP(TEXT("TestingGrounds"), STATGROUP_TestingGrounds, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Interaction Raycast"), STAT_TGRaycast, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Gun Fire"), STAT_TGGunFire, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Bomb Explode"), STAT_TGBombExplode, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Choose Next Waypoint"), STAT_TGChooseNextWaypoint, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spawn Bomb"), STAT_TGSpawnBomb, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Skills"), STAT_TGSkills, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Advance Timers"), STAT_TGAdvanceTimers, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Record Hit History"), STAT_TGRecordHistory, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Validate Hits"), STAT_TGValidateHits, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Spawns"), STAT_TGSpawns, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Traces"), STAT_TGTraces, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("RPCs Sent"), STAT_TGRPCsSent, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("RPCs Received"), STAT_TGRPCsReceived, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Render State Dirtied"), STAT_TGRenderStateDirtied, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Render State Changes Skipped"), STAT_TGRenderStateSkipped, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Timers Run"), STAT_TGTimersRun, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Hits Accepted"), STAT_TGHitsAccepted, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Hits Rejected"), STAT_TGHitsRejected, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Predicted Shots Fired"), STAT_TGShotsFired, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Predicted Shots Confirmed"), STAT_TGShotsConfirmed, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Predicted Shots Lost"), STAT_TGShotsLost, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending Timers"), STAT_TGPendingTimers, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Compensated Characters"), STAT_TGCompensatedCharacters, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Last Shot Confirm Us"), STAT_TGShotConfirmUs, STATGROUP_TestingGrounds, TESTINGGROUNDS_API);
+
+// The values tg.Stats.Capture records, one per stat of the group above.
+// Timed stats first, then the counters, then the values that are set rather than counted
+enum class ETGStat : uint8
+{
+    Raycast,
+    GunFire,
+    BombExplode,
+    ChooseNextWaypoint,
+    SpawnBomb,
+    Skills,
+    AdvanceTimers,
+    RecordHistory,
+    ValidateHits,
+    Spawns,
+    Traces,
+    RPCsSent,
+    RPCsReceived,
+    RenderStateDirtied,
+    RenderStateSkipped,
+    TimersRun,
+    HitsAccepted,
+    HitsRejected,
+    ShotsFired,
+    ShotsConfirmed,
+    ShotsLost,
+    PendingTimers,
+    CompensatedCharacters,
+    ShotConfirmUs,
+    Num
+};
+
+/**
+ * Per-frame CSV capture of the TestingGrounds stats.
+ * The stats system doesn't hand its values back to game code, so the macros below feed both. Game thread only.
+ */
+class TESTINGGROUNDS_API FTGStatCapture
+{
+public:
+    // Starts writing a row per frame, to CsvPath once stopped
+    static void Start(const FString& CsvPath);
+
+    static void Stop();
+
+    static bool IsCapturing() { return bCapturing; }
+
+    // Adds cycles or a count to the value of the current frame
+    static void Add(ETGStat Stat, uint64 Value)
+    {
+        if (bCapturing) FrameValues[(uint8)Stat] += Value;
+    }
+
+    // Replaces the value, which stays until it's set again
+    static void Set(ETGStat Stat, uint64 Value)
+    {
+        if (bCapturing) FrameValues[(uint8)Stat] = Value;
+    }
+
+private:
+    // Appends the row of the frame that just ended
+    static void OnEndFrame();
+
+    static bool bCapturing;
+    static uint64 FrameValues[(uint8)ETGStat::Num];
+};
+
+// Times its scope for the capture
+struct FTGScopeCycleCounter
+{
+    FTGScopeCycleCounter(ETGStat InStat)
+        : Stat(InStat)
+        , StartCycles(FTGStatCapture::IsCapturing() ? FPlatformTime::Cycles64() : 0)
+    {
+    }
+
+    ~FTGScopeCycleCounter()
+    {
+        if (StartCycles != 0) FTGStatCapture::Add(Stat, FPlatformTime::Cycles64() - StartCycles);
+    }
+
+    ETGStat Stat;
+    uint64 StartCycles;
+};
+
+// Times the enclosing scope, e.g. TG_SCOPE_CYCLE_COUNTER(GunFire)
+#define TG_SCOPE_CYCLE_COUNTER(Stat) \
+    SCOPE_CYCLE_COUNTER(STAT_TG##Stat); \
+    FTGScopeCycleCounter TGScopeCycleCounter_##Stat(ETGStat::Stat)
+
+// Counts one event, e.g. TG_INC_COUNTER(Spawns)
+#define TG_INC_COUNTER(Stat) \
+    INC_DWORD_STAT(STAT_TG##Stat); \
+    FTGStatCapture::Add(ETGStat::Stat, 1)
+
+// Counts several events at once, e.g. TG_INC_COUNTER_BY(TimersRun, NumRun)
+#define TG_INC_COUNTER_BY(Stat, Amount) \
+    INC_DWORD_STAT_BY(STAT_TG##Stat, Amount); \
+    FTGStatCapture::Add(ETGStat::Stat, Amount)
+
+// Sets a value that isn't counted per frame, e.g. TG_SET_DWORD(PendingTimers, NumPending)
+#define TG_SET_DWORD(Stat, Value) \
+    SET_DWORD_STAT(STAT_TG##Stat, Value); \
+    FTGStatCapture::Set(ETGStat::Stat, Value)
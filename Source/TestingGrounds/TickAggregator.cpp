@@ -0,0 +1,193 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "TickAggregator.h"
+#include "WorldManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogTickAggregator, Log, All);
+
+// Sets default values
+ATickAggregator::ATickAggregator()
+{
+    // This is the one tick function that replaces the per-object ones
+	PrimaryActorTick.bCanEverTick = true;
+}
+
+void ATickAggregator::BeginPlay()
+{
+    Super::BeginPlay();
+
+    for (const FTickCategorySettings& Settings : CategorySettings)
+    {
+        SetCategoryInterval(Settings.Category, Settings.Interval);
+    }
+}
+
+void ATickAggregator::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    for (FTickCategory& TickCategory : Categories)
+    {
+        TickCategory.TimeSinceUpdate += DeltaSeconds;
+        if (TickCategory.TimeSinceUpdate < TickCategory.Interval) continue;
+
+        RunCategory(TickCategory, TickCategory.TimeSinceUpdate);
+        TickCategory.TimeSinceUpdate = 0.f;
+    }
+}
+
+ATickAggregator* ATickAggregator::Get(UWorld* World)
+{
+    return GetWorldManager<ATickAggregator>(World);
+}
+
+void ATickAggregator::RegisterCallback(ETickCategory Category, UObject* Object, TFunction<void(float)> Callback)
+{
+    if (Object == nullptr || Category >= ETickCategory::MAX) return;
+
+    FTickCategory& TickCategory = Categories[(int32)Category];
+    if (TickCategory.bIsRunning)
+    {
+        // Growing the arrays now could move the callback that is currently running
+        TickCategory.PendingRemovals.Remove(Object);
+        FPendingAdd& PendingAdd = TickCategory.PendingAdds[TickCategory.PendingAdds.AddDefaulted()];
+        PendingAdd.Owner = Object;
+        PendingAdd.Callback = MoveTemp(Callback);
+        return;
+    }
+
+    AddCallback(TickCategory, Object, MoveTemp(Callback));
+}
+
+void ATickAggregator::Unregister(ETickCategory Category, UObject* Object)
+{
+    if (Object == nullptr || Category >= ETickCategory::MAX) return;
+
+    FTickCategory& TickCategory = Categories[(int32)Category];
+    TickCategory.PendingAdds.RemoveAll([Object](const FPendingAdd& PendingAdd) { return PendingAdd.Owner.Get() == Object; });
+
+    const int32* Index = TickCategory.OwnerIndices.Find(Object);
+    if (Index == nullptr) return;
+
+    if (TickCategory.bIsRunning)
+    {
+        // Stop calling it right away, compact once the loop is done
+        TickCategory.Owners[*Index] = nullptr;
+        TickCategory.PendingRemovals.AddUnique(Object);
+        return;
+    }
+
+    RemoveCallbackAt(TickCategory, *Index);
+}
+
+void ATickAggregator::SetCategoryInterval(ETickCategory Category, float Interval)
+{
+    if (Category >= ETickCategory::MAX) return;
+
+    Categories[(int32)Category].Interval = FMath::Max(Interval, 0.f);
+}
+
+float ATickAggregator::GetCategoryTimeMs(ETickCategory Category) const
+{
+    return (Category < ETickCategory::MAX) ? Categories[(int32)Category].LastTimeMs : 0.f;
+}
+
+int32 ATickAggregator::GetNumCallbacks(ETickCategory Category) const
+{
+    return (Category < ETickCategory::MAX) ? Categories[(int32)Category].Callbacks.Num() : 0;
+}
+
+void ATickAggregator::LogTimingBreakdown() const
+{
+    const UEnum* CategoryEnum = FindObject<UEnum>(ANY_PACKAGE, TEXT("ETickCategory"), true);
+
+    for (int32 i = 0; i < (int32)ETickCategory::MAX; i++)
+    {
+        const FTickCategory& TickCategory = Categories[i];
+        UE_LOG(LogTickAggregator, Log, TEXT("%-12s %5d callbacks, every %.3f s, last %.3f ms, avg %.3f ms"),
+               CategoryEnum ? *CategoryEnum->GetEnumName(i) : *FString::FromInt(i),
+               TickCategory.Callbacks.Num(),
+               TickCategory.Interval,
+               TickCategory.LastTimeMs,
+               TickCategory.AverageTimeMs);
+    }
+}
+
+void ATickAggregator::RunCategory(FTickCategory& TickCategory, float DeltaSeconds)
+{
+    const double StartTime = FPlatformTime::Seconds();
+
+    TickCategory.bIsRunning = true;
+    const int32 NumCallbacks = TickCategory.Callbacks.Num();
+    for (int32 i = 0; i < NumCallbacks; i++)
+    {
+        if (TickCategory.Owners[i].IsValid())
+        {
+            TickCategory.Callbacks[i](DeltaSeconds);
+        }
+    }
+    TickCategory.bIsRunning = false;
+
+    // Drop everything that got unregistered or destroyed while we were running
+    for (UObject* Object : TickCategory.PendingRemovals)
+    {
+        const int32* Index = TickCategory.OwnerIndices.Find(Object);
+        if (Index) RemoveCallbackAt(TickCategory, *Index);
+    }
+    TickCategory.PendingRemovals.Reset();
+
+    for (int32 i = TickCategory.Owners.Num() - 1; i >= 0; i--)
+    {
+        if (!TickCategory.Owners[i].IsValid()) RemoveCallbackAt(TickCategory, i);
+    }
+
+    for (FPendingAdd& PendingAdd : TickCategory.PendingAdds)
+    {
+        if (PendingAdd.Owner.IsValid()) AddCallback(TickCategory, PendingAdd.Owner.Get(), MoveTemp(PendingAdd.Callback));
+    }
+    TickCategory.PendingAdds.Reset();
+
+    TickCategory.LastTimeMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+    TickCategory.AverageTimeMs = FMath::Lerp(TickCategory.AverageTimeMs, TickCategory.LastTimeMs, 0.05f);
+}
+
+void ATickAggregator::AddCallback(FTickCategory& TickCategory, UObject* Object, TFunction<void(float)>&& Callback)
+{
+    const int32* ExistingIndex = TickCategory.OwnerIndices.Find(Object);
+    if (ExistingIndex)
+    {
+        TickCategory.Callbacks[*ExistingIndex] = MoveTemp(Callback);
+        return;
+    }
+
+    TickCategory.OwnerIndices.Add(Object, TickCategory.Owners.Add(Object));
+    TickCategory.Callbacks.Add(MoveTemp(Callback));
+    TickCategory.OwnerKeys.Add(Object);
+}
+
+void ATickAggregator::RemoveCallbackAt(FTickCategory& TickCategory, int32 Index)
+{
+    // Swap the last callback into the hole to keep the arrays contiguous
+    const int32 LastIndex = TickCategory.Owners.Num() - 1;
+    TickCategory.OwnerIndices.Remove(TickCategory.OwnerKeys[Index]);
+    if (Index != LastIndex)
+    {
+        TickCategory.OwnerIndices.Add(TickCategory.OwnerKeys[LastIndex], Index);
+    }
+
+    TickCategory.Owners.RemoveAtSwap(Index, 1, false);
+    TickCategory.Callbacks.RemoveAtSwap(Index, 1, false);
+    TickCategory.OwnerKeys.RemoveAtSwap(Index, 1, false);
+}
+
+static void LogTickAggregatorStats(UWorld* World)
+{
+    ATickAggregator* TickAggregator = ATickAggregator::Get(World);
+    if (TickAggregator) TickAggregator->LogTimingBreakdown();
+}
+
+static FAutoConsoleCommandWithWorld TickStatsCommand(
+    TEXT("tg.TickStats"),
+    TEXT("Logs the per-category timing breakdown of the tick aggregator"),
+    FConsoleCommandWithWorldDelegate::CreateStatic(&LogTickAggregatorStats));
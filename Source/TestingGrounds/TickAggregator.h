@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "TickAggregator.generated.h"
+
+// The groups of batched updates. Every category runs at its own frequency
+UENUM(BlueprintType)
+enum class ETickCategory : uint8
+{
+    Interaction,
+    Character,
+    PickUp,
+    Weapon,
+    Projectile,
+    Skill,
+    MAX UMETA(Hidden)
+};
+
+// The update frequency of a tick category
+USTRUCT()
+struct FTickCategorySettings
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere)
+    ETickCategory Category = ETickCategory::Interaction;
+
+    // Seconds between two updates of the category. 0 means every frame
+    UPROPERTY(EditAnywhere)
+    float Interval = 0.f;
+};
+
+/**
+ * Runs the periodic updates of gameplay objects in batches, one tight loop per category,
+ * instead of every object owning its own FTickFunction.
+ * Objects register a member function per category and unregister when they end play.
+ */
+UCLASS(config=Game)
+class TESTINGGROUNDS_API ATickAggregator : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ATickAggregator();
+
+    virtual void BeginPlay() override;
+
+    // Runs every category that is due
+    virtual void Tick(float DeltaSeconds) override;
+
+    // Returns the aggregator of the given world, spawning it if needed
+    static ATickAggregator* Get(UWorld* World);
+
+    // Registers Object's member function to be called with the time since the last update of the category
+    template<class T>
+    void Register(ETickCategory Category, T* Object, void (T::*Callback)(float))
+    {
+        RegisterCallback(Category, Object, [Object, Callback](float DeltaSeconds) { (Object->*Callback)(DeltaSeconds); });
+    }
+
+    // Registers a callback owned by Object. The callback stops running once Object is gone
+    void RegisterCallback(ETickCategory Category, UObject* Object, TFunction<void(float)> Callback);
+
+    // Removes the callback Object registered for the category
+    void Unregister(ETickCategory Category, UObject* Object);
+
+    // Sets the seconds between two updates of the category. 0 means every frame
+    void SetCategoryInterval(ETickCategory Category, float Interval);
+
+    // Returns the milliseconds the last update of the category took
+    UFUNCTION(BlueprintCallable, Category = "TickAggregator")
+    float GetCategoryTimeMs(ETickCategory Category) const;
+
+    // Returns the number of callbacks registered for the category
+    UFUNCTION(BlueprintCallable, Category = "TickAggregator")
+    int32 GetNumCallbacks(ETickCategory Category) const;
+
+    // Writes the per-category timing breakdown to the log
+    void LogTimingBreakdown() const;
+
+protected:
+    // Per-category update frequencies, see DefaultGame.ini
+    UPROPERTY(config, EditAnywhere, Category = "TickAggregator")
+    TArray<FTickCategorySettings> CategorySettings;
+
+private:
+    struct FPendingAdd
+    {
+        TWeakObjectPtr<UObject> Owner;
+        TFunction<void(float)> Callback;
+    };
+
+    struct FTickCategory
+    {
+        // Owners and callbacks are kept in parallel contiguous arrays
+        TArray<TWeakObjectPtr<UObject>> Owners;
+        TArray<TFunction<void(float)>> Callbacks;
+
+        // The raw pointer every owner registered with, so stale owners can still be found
+        TArray<UObject*> OwnerKeys;
+
+        // The index of every owner in the arrays above
+        TMap<UObject*, int32> OwnerIndices;
+
+        // Changes requested while the category was running, applied right after
+        TArray<UObject*> PendingRemovals;
+        TArray<FPendingAdd> PendingAdds;
+
+        float Interval = 0.f;
+        float TimeSinceUpdate = 0.f;
+        bool bIsRunning = false;
+
+        // Timing breakdown
+        float LastTimeMs = 0.f;
+        float AverageTimeMs = 0.f;
+    };
+
+    // Runs every callback of the category
+    void RunCategory(FTickCategory& TickCategory, float DeltaSeconds);
+
+    void AddCallback(FTickCategory& TickCategory, UObject* Object, TFunction<void(float)>&& Callback);
+
+    void RemoveCallbackAt(FTickCategory& TickCategory, int32 Index);
+
+    FTickCategory Categories[(int32)ETickCategory::MAX];
+};
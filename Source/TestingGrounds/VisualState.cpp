@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "VisualState.h"
+#include "WorldManager.h"
+#include "TestingGroundsStats.h"
+
+
+// Sets default values
+AVisualStateCache::AVisualStateCache()
+{
+    // Only reacts to state changes
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+AVisualStateCache* AVisualStateCache::Get(UWorld* World)
+{
+    return GetWorldManager<AVisualStateCache>(World);
+}
+
+bool AVisualStateCache::SetCustomDepth(UPrimitiveComponent* Component, bool bEnabled)
+{
+    if (Component == nullptr) return false;
+
+    // The setter dirties the render state even when nothing changes
+    if (Component->bRenderCustomDepth == bEnabled)
+    {
+        TG_INC_COUNTER(RenderStateSkipped);
+        return false;
+    }
+
+    Component->SetRenderCustomDepth(bEnabled);
+    TG_INC_COUNTER(RenderStateDirtied);
+    return true;
+}
+
+bool AVisualStateCache::SetVectorParameter(UMeshComponent* Mesh, int32 ElementIndex, FName ParameterName, const FLinearColor& Value)
+{
+    if (Mesh == nullptr) return false;
+
+    UMaterialInterface* CurrentMaterial = Mesh->GetMaterial(ElementIndex);
+    if (CurrentMaterial == nullptr) return false;
+
+    // A mesh already showing one of our variants goes back to its base material for the lookup
+    UMaterialInterface* BaseMaterial = CurrentMaterial;
+    UMaterialInstanceDynamic* CurrentVariant = Cast<UMaterialInstanceDynamic>(CurrentMaterial);
+    if (CurrentVariant && CurrentVariant->GetOuter() == this)
+    {
+        BaseMaterial = CurrentVariant->Parent;
+    }
+
+    UMaterialInstanceDynamic* Variant = FindOrAddVariant(BaseMaterial, ParameterName, Value);
+    if (Variant == nullptr || Variant == CurrentMaterial)
+    {
+        TG_INC_COUNTER(RenderStateSkipped);
+        return false;
+    }
+
+    Mesh->SetMaterial(ElementIndex, Variant);
+    TG_INC_COUNTER(RenderStateDirtied);
+    return true;
+}
+
+UMaterialInstanceDynamic* AVisualStateCache::FindOrAddVariant(UMaterialInterface* BaseMaterial, FName ParameterName, const FLinearColor& Value)
+{
+    if (BaseMaterial == nullptr) return nullptr;
+
+    const uint32 Hash = HashCombine(HashCombine(GetTypeHash(BaseMaterial), GetTypeHash(ParameterName)), FCrc::MemCrc32(&Value, sizeof(Value)));
+    TArray<int32>& Candidates = VariantsByHash.FindOrAdd(Hash);
+    for (int32 VariantIndex : Candidates)
+    {
+        const FSharedMaterialVariant& Variant = Variants[VariantIndex];
+        if (Variant.BaseMaterial == BaseMaterial && Variant.ParameterName == ParameterName && Variant.Value == Value)
+        {
+            return Variant.Material;
+        }
+    }
+
+    FSharedMaterialVariant Variant;
+    Variant.BaseMaterial = BaseMaterial;
+    Variant.ParameterName = ParameterName;
+    Variant.Value = Value;
+    Variant.Material = UMaterialInstanceDynamic::Create(BaseMaterial, this);
+    Variant.Material->SetVectorParameterValue(ParameterName, Value);
+
+    Candidates.Add(Variants.Add(Variant));
+    return Variant.Material;
+}
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "VisualState.generated.h"
+
+// A material with one vector parameter overridden, shared by every mesh that shows the same value
+USTRUCT()
+struct FSharedMaterialVariant
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    UMaterialInterface* BaseMaterial = nullptr;
+
+    FName ParameterName;
+
+    FLinearColor Value = FLinearColor::White;
+
+    UPROPERTY()
+    UMaterialInstanceDynamic* Material = nullptr;
+};
+
+/**
+ * Per-world layer between gameplay code and the render state of its meshes.
+ * Custom depth and material parameters are applied only when they actually change, since every change
+ * dirties the component's render state. Colored meshes share one material instance per base material,
+ * parameter and value, instead of owning a dynamic instance each.
+ * The applied and skipped changes show up in "stat TestingGrounds" and the tg.Stats.Capture CSV.
+ */
+UCLASS()
+class TESTINGGROUNDS_API AVisualStateCache : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AVisualStateCache();
+
+    // Returns the cache of the given world, spawning it if needed
+    static AVisualStateCache* Get(UWorld* World);
+
+    // Turns custom depth rendering of the component on or off, unless it already is. Returns whether it changed
+    static bool SetCustomDepth(UPrimitiveComponent* Component, bool bEnabled);
+
+    /**
+     * Shows the element of the mesh with the vector parameter set to Value, through the shared variant
+     * of the element's base material. Returns whether the mesh changed.
+     */
+    bool SetVectorParameter(UMeshComponent* Mesh, int32 ElementIndex, FName ParameterName, const FLinearColor& Value);
+
+    UFUNCTION(BlueprintCallable, Category = "VisualState")
+    int32 GetNumSharedMaterials() const { return Variants.Num(); }
+
+private:
+    // Returns the shared variant, creating it on first use
+    UMaterialInstanceDynamic* FindOrAddVariant(UMaterialInterface* BaseMaterial, FName ParameterName, const FLinearColor& Value);
+
+    UPROPERTY()
+    TArray<FSharedMaterialVariant> Variants;
+
+    // Index into Variants by base material, parameter and value
+    TMap<uint32, TArray<int32>> VariantsByHash;
+};
@@ -2,6 +2,9 @@
 
 #include "TestingGrounds.h"
 #include "BallProjectile.h"
+#include "ProjectilePool.h"
+#include "PredictedFireComponent.h"
+#include "ProjectileSimulation.h"
 #include "GameFramework/ProjectileMovementComponent.h"
 
 ABallProjectile::ABallProjectile() 
@@ -27,17 +30,224 @@ ABallProjectile::ABallProjectile()
 	ProjectileMovement->bRotationFollowsVelocity = true;
 	ProjectileMovement->bShouldBounce = true;
 
-	// Die after 3 seconds by default
-	InitialLifeSpan = 3.0f;
+	// The lifespan is driven by ProjectileLifeSpan so pooled projectiles don't get destroyed while parked
+	InitialLifeSpan = 0.f;
+
+	// The server launches the projectiles every player sees
+	bReplicates = true;
+	bReplicateMovement = true;
+
+	// Projectiles are small and fast, only players close by need them
+	ReplicationPolicy.CullDistance = 4000.f;
+	ReplicationPolicy.MaxUpdateFrequency = 30.f;
+	ReplicationPolicy.MinUpdateFrequency = 10.f;
+}
+
+void ABallProjectile::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	// Remember the in-flight collision so we can restore it when leaving the pool
+	ActiveCollisionEnabled = CollisionComp->GetCollisionEnabled();
+
+	ReplicationPolicy.ApplyTo(this);
+}
+
+void ABallProjectile::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Projectiles spawned outside of a pool die after ProjectileLifeSpan seconds
+	if (!OwningPool.IsValid())
+	{
+		StartLifeSpanTimer();
+		StartMotion(ProjectileMovement->Velocity);
+	}
+}
+
+void ABallProjectile::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopMotion();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ABallProjectile::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ABallProjectile, ShotID);
 }
 
 void ABallProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
+	// Replicated projectiles are released by the server
+	if (Role != ROLE_Authority) return;
+
+	// Hits on characters count where the shooter saw them. The server's copy of a predicted shot leaves them to the shooter
+	APawn* Shooter = Instigator;
+	if (OtherActor && OtherActor != Shooter && Cast<ACharacter>(OtherActor) && (bCosmetic || ShotID == 0) && Shooter && Shooter->IsLocallyControlled())
+	{
+		UPredictedFireComponent* FireComponent = Shooter->FindComponentByClass<UPredictedFireComponent>();
+		if (FireComponent) FireComponent->ReportHit(OtherActor, Hit.ImpactPoint, ShotID, ESkillType::MAX, HitDamage);
+	}
+
 	// Only add impulse and destroy projectile if we hit a physics
 	if ((OtherActor != NULL) && (OtherActor != this) && (OtherComp != NULL) && OtherComp->IsSimulatingPhysics())
 	{
-		OtherComp->AddImpulseAtLocation(GetVelocity() * 100.0f, GetActorLocation());
+		// Predicted shots leave the physics to the server
+		if (!bCosmetic) OtherComp->AddImpulseAtLocation(GetVelocity() * 100.0f, GetActorLocation());
+
+		Release();
+	}
+}
 
+void ABallProjectile::OnSimulatedHit(const FHitResult& Hit)
+{
+	OnHit(CollisionComp, Hit.GetActor(), Hit.GetComponent(), FVector::ZeroVector, Hit);
+}
+
+void ABallProjectile::OnSimulatedExpiry()
+{
+	// The handle may already belong to another projectile
+	SimHandle = INDEX_NONE;
+	Release();
+}
+
+void ABallProjectile::Release()
+{
+	if (OwningPool.IsValid())
+	{
+		OwningPool->ReleaseProjectile(this);
+	}
+	else
+	{
 		Destroy();
 	}
-}
\ No newline at end of file
+}
+
+void ABallProjectile::OnAcquiredFromPool(const FVector& Location, const FRotator& Rotation)
+{
+	bInPool = false;
+
+	// Parked projectiles don't replicate, wake up before we move
+	if (GetIsReplicated()) SetNetDormancy(DORM_Awake);
+
+	SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+	SetActorHiddenInGame(false);
+	CollisionComp->SetCollisionEnabled(ActiveCollisionEnabled);
+
+	StartMotion(Rotation.Vector() * ProjectileMovement->InitialSpeed);
+
+	StartLifeSpanTimer();
+}
+
+void ABallProjectile::StartLifeSpanTimer()
+{
+	AGameplayTimerService* Timers = AGameplayTimerService::Get(GetWorld());
+	if (Timers == nullptr) return;
+
+	Timers->ClearTimer(LifeSpanTimerHandle);
+	LifeSpanTimerHandle = Timers->SetTimer(this, &ABallProjectile::Release, ProjectileLifeSpan);
+}
+
+void ABallProjectile::OnReturnedToPool()
+{
+	bInPool = true;
+
+	AGameplayTimerService* Timers = AGameplayTimerService::Get(GetWorld());
+	if (Timers) Timers->ClearTimer(LifeSpanTimerHandle);
+
+	// The next launch may be somebody else's shot
+	bCosmetic = false;
+	ShotID = 0;
+	EndPrediction();
+
+	StopMotion();
+	ProjectileMovement->StopMovementImmediately();
+	ProjectileMovement->SetComponentTickEnabled(false);
+	CollisionComp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetActorHiddenInGame(true);
+
+	// Nothing changes while we're parked. The hidden state gets flushed before the channel closes
+	if (GetIsReplicated()) SetNetDormancy(DORM_DormantAll);
+}
+
+void ABallProjectile::StartMotion(const FVector& Velocity)
+{
+	// Replicated projectiles follow the server, they keep their movement component
+	AProjectileSimulation* Simulation = (Role == ROLE_Authority && AProjectileSimulation::IsEnabled()) ? AProjectileSimulation::Get(GetWorld()) : nullptr;
+	if (Simulation)
+	{
+		ProjectileMovement->SetComponentTickEnabled(false);
+		ProjectileMovement->Velocity = Velocity;
+
+		FProjectileSimParams SimParams;
+		SimParams.Radius = CollisionComp->GetScaledSphereRadius();
+		SimParams.GravityScale = ProjectileMovement->ProjectileGravityScale;
+		SimParams.MaxSpeed = ProjectileMovement->MaxSpeed;
+		SimParams.LifeSpan = ProjectileLifeSpan;
+		SimParams.bShouldBounce = ProjectileMovement->bShouldBounce;
+		SimParams.Bounciness = ProjectileMovement->Bounciness;
+		SimParams.Friction = ProjectileMovement->Friction;
+		SimParams.StopSpeed = ProjectileMovement->BounceVelocityStopSimulatingThreshold;
+		SimParams.Channel = CollisionComp->GetCollisionObjectType();
+		SimParams.ResponseParams = FCollisionResponseParams(CollisionComp->GetCollisionResponseToChannels());
+
+		SimHandle = Simulation->AddProjectile(GetActorLocation(), Velocity, SimParams, this);
+		return;
+	}
+
+	// The movement comp drops its updated component once it comes to rest, so re-arm it
+	ProjectileMovement->SetUpdatedComponent(CollisionComp);
+	ProjectileMovement->Velocity = Velocity;
+	ProjectileMovement->UpdateComponentVelocity();
+	ProjectileMovement->SetComponentTickEnabled(true);
+}
+
+void ABallProjectile::StopMotion()
+{
+	if (SimHandle == INDEX_NONE) return;
+
+	AProjectileSimulation* Simulation = AProjectileSimulation::Get(GetWorld());
+	if (Simulation) Simulation->RemoveProjectile(SimHandle);
+	SimHandle = INDEX_NONE;
+}
+
+void ABallProjectile::SetShot(APawn* Shooter, uint8 InShotID)
+{
+	Instigator = Shooter;
+	ShotID = InShotID;
+}
+
+void ABallProjectile::HideBehindCosmetic(ABallProjectile* Cosmetic)
+{
+	PredictedCosmetic = Cosmetic;
+	bHiddenByPrediction = true;
+
+	// Only our components, the replicated hidden flag stays with the server
+	CollisionComp->SetVisibility(false, true);
+}
+
+void ABallProjectile::OnRep_ShotID()
+{
+	// A new shot, or the server parked the projectile: whatever we predicted is over
+	EndPrediction();
+
+	if (ShotID == 0 || Instigator == nullptr || !Instigator->IsLocallyControlled()) return;
+
+	UPredictedFireComponent* FireComponent = Instigator->FindComponentByClass<UPredictedFireComponent>();
+	if (FireComponent) FireComponent->ConfirmShot(ShotID, this);
+}
+
+void ABallProjectile::EndPrediction()
+{
+	if (!bHiddenByPrediction) return;
+	bHiddenByPrediction = false;
+
+	// The server has the last word on where the shot ends
+	if (PredictedCosmetic.IsValid() && !PredictedCosmetic->IsInPool()) PredictedCosmetic->Release();
+	PredictedCosmetic.Reset();
+
+	CollisionComp->SetVisibility(true, true);
+}
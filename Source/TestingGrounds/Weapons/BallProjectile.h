@@ -1,8 +1,12 @@
 // Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
 #pragma once
 #include "GameFramework/Actor.h"
+#include "../ReplicationPolicy.h"
+#include "../GameplayTimerService.h"
 #include "BallProjectile.generated.h"
 
+class AProjectilePool;
+
 UCLASS(config=Game)
 class ABallProjectile : public AActor
 {
@@ -19,10 +23,111 @@ class ABallProjectile : public AActor
 public:
 	ABallProjectile();
 
+	virtual void PostInitializeComponents() override;
+
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	/** called when projectile hits something */
 	UFUNCTION()
 	void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 
+	/** Called by the projectile simulation when the projectile hits something */
+	void OnSimulatedHit(const FHitResult& Hit);
+
+	/** Called by the projectile simulation when it dropped the projectile at the end of its lifespan */
+	void OnSimulatedExpiry();
+
+	/** Returns the projectile to its pool, or destroys it if it isn't pooled */
+	void Release();
+
+	/** Marks this projectile as owned by the given pool. Must be called before FinishSpawning */
+	void SetOwningPool(AProjectilePool* Pool) { OwningPool = Pool; }
+
+	/** Places the projectile and launches it along the given rotation */
+	void OnAcquiredFromPool(const FVector& Location, const FRotator& Rotation);
+
+	/** Stops the projectile, disables its collision and hides it */
+	void OnReturnedToPool();
+
+	/** Returns true if the projectile is parked in its pool */
+	bool IsInPool() const { return bInPool; }
+
+	/** Tags the projectile with the shot that launched it, so the shooter can match it with its cosmetic one. Server, or the cosmetic projectile of the shot */
+	void SetShot(APawn* Shooter, uint8 InShotID);
+
+	/** Marks the projectile as a client-side prediction: it shows the shot but doesn't push anything */
+	void SetCosmetic(bool bInCosmetic) { bCosmetic = bInCosmetic; }
+
+	/** Hides this authoritative projectile while the cosmetic one of the same shot flies. Owning client only */
+	void HideBehindCosmetic(ABallProjectile* Cosmetic);
+
+	/** Returns the damage a hit on a character deals */
+	float GetHitDamage() const { return HitDamage; }
+
+protected:
+	/** How long the projectile flies before it gets released */
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	float ProjectileLifeSpan = 3.0f;
+
+	/** The damage a hit on a character deals */
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	float HitDamage = 10.f;
+
+	/** Relevancy and update frequency of the projectile */
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	FReplicationPolicy ReplicationPolicy;
+
+private:
+	/** Sets the projectile flying, through the projectile simulation if it's enabled */
+	void StartMotion(const FVector& Velocity);
+
+	/** Takes the projectile out of the projectile simulation */
+	void StopMotion();
+
+	/** The handle of the projectile in the projectile simulation, INDEX_NONE when the movement component moves it */
+	int32 SimHandle = INDEX_NONE;
+
+	/** Matches the projectile with the predicted one on the shooter's machine */
+	UFUNCTION()
+	void OnRep_ShotID();
+
+	/** Releases the cosmetic projectile we were hidden behind and shows this one again */
+	void EndPrediction();
+
+	/** The shot of the shooter that launched this projectile. 0 when the shot wasn't predicted */
+	UPROPERTY(ReplicatedUsing = OnRep_ShotID)
+	uint8 ShotID = 0;
+
+	/** True for the client-side projectiles of predicted shots */
+	bool bCosmetic = false;
+
+	/** The cosmetic projectile shown in place of this one */
+	TWeakObjectPtr<ABallProjectile> PredictedCosmetic;
+
+	/** True while our components are hidden behind PredictedCosmetic */
+	bool bHiddenByPrediction = false;
+
+	/** The pool this projectile returns to. Null for projectiles spawned outside of a pool */
+	TWeakObjectPtr<AProjectilePool> OwningPool;
+
+	/** True while the projectile is parked in its pool */
+	bool bInPool = false;
+
+	/** The collision the projectile uses while in flight */
+	TEnumAsByte<ECollisionEnabled::Type> ActiveCollisionEnabled;
+
+	/** Releases the projectile once its lifespan expires */
+	FGameplayTimerHandle LifeSpanTimerHandle;
+
+	/** Starts the lifespan timer over */
+	void StartLifeSpanTimer();
+
+public:
+
 	/** Returns CollisionComp subobject **/
 	FORCEINLINE class USphereComponent* GetCollisionComp() const { return CollisionComp; }
 	/** Returns ProjectileMovement subobject **/
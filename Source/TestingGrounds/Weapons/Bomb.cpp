@@ -2,13 +2,23 @@
 
 #include "TestingGrounds.h"
 #include "Bomb.h"
+#include "RadialDamageResolver.h"
+#include "../TickAggregator.h"
+#include "../GameplayTimerService.h"
+#include "../VisualState.h"
+#include "../TestingGroundsStats.h"
+
+static TAutoConsoleVariable<int32> CVarBombDormancy(
+    TEXT("tg.Net.BombDormancy"),
+    1,
+    TEXT("1: armed bombs stop replicating once they rest, until they explode. 0: they keep replicating"));
 
 
 // Sets default values
 ABomb::ABomb()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+    // Nothing to update per frame. Periodic updates go through the ATickAggregator
+	PrimaryActorTick.bCanEverTick = false;
     
     SphereComp = CreateDefaultSubobject<USphereComponent>(FName("SphereComp"));
     
@@ -23,6 +33,20 @@ ABomb::ABomb()
     // Since we need to replicate some functionality
     // - for this actor, we need to mark it as true
     SetReplicates(true);
+    
+    // Bombs only matter to players around them
+    ReplicationPolicy.CullDistance = 5000.f;
+    ReplicationPolicy.MaxUpdateFrequency = 20.f;
+    ReplicationPolicy.MinUpdateFrequency = 2.f;
+    ReplicationPolicy.FullRateSpeed = 500.f;
+}
+
+void ABomb::PostInitializeComponents()
+{
+    Super::PostInitializeComponents();
+    
+    // The policy may have been tweaked in the blueprint
+    ReplicationPolicy.ApplyTo(this);
 }
 
 // Called when the game starts or when spawned
@@ -32,6 +56,24 @@ void ABomb::BeginPlay()
 	
     // Register the function that will be called in any bounce event
     ProjectileMovementComp->OnProjectileBounce.AddDynamic(this, &ABomb::OnProjectileBounce);
+    ProjectileMovementComp->OnProjectileStop.AddDynamic(this, &ABomb::OnProjectileStop);
+    
+    ATickAggregator* TickAggregator = ATickAggregator::Get(GetWorld());
+    if (TickAggregator && Role == ROLE_Authority)
+    {
+        TickAggregator->Register(ETickCategory::Weapon, this, &ABomb::UpdateReplication);
+    }
+}
+
+void ABomb::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    ATickAggregator* TickAggregator = ATickAggregator::Get(GetWorld());
+    if (TickAggregator)
+    {
+        TickAggregator->Unregister(ETickCategory::Weapon, this);
+    }
+    
+    Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -51,12 +93,11 @@ void ABomb::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimePro
 
 void ABomb::ArmBomb()
 {
-    if (bIsArmed)
+    // Change the base color of the static mesh, through the material every armed bomb shares
+    AVisualStateCache* VisualState = AVisualStateCache::Get(GetWorld());
+    if (bIsArmed && VisualState)
     {
-        // Change the base color of the static mesh to red
-        UMaterialInstanceDynamic* DynamicMAT = SM->CreateAndSetMaterialInstanceDynamic(0);
-        
-        DynamicMAT->SetVectorParameterValue(FName("Color"), FLinearColor::Red);
+        VisualState->SetVectorParameter(SM, 0, FName("Color"), ArmedColor);
     }
 }
 
@@ -70,9 +111,30 @@ void ABomb::OnProjectileBounce(const FHitResult& ImpactResult, const FVector& Im
         ArmBomb();
         
         PreformDelayedExplosion(FuseTime);
+        TryGoDormant();
     }
 }
 
+void ABomb::OnProjectileStop(const FHitResult& ImpactResult)
+{
+    bIsResting = true;
+    TryGoDormant();
+}
+
+void ABomb::TryGoDormant()
+{
+    if (Role == ROLE_Authority && bIsArmed && bIsResting && CVarBombDormancy.GetValueOnGameThread() != 0)
+    {
+        // Flushes the armed state to the clients before the channel closes
+        SetNetDormancy(DORM_DormantAll);
+    }
+}
+
+void ABomb::UpdateReplication(float DeltaSeconds)
+{
+    ReplicationPolicy.UpdateFrequency(this);
+}
+
 void ABomb::OnRep_IsArmed()
 {
     // Will get called when the bomb is armed
@@ -85,49 +147,61 @@ void ABomb::OnRep_IsArmed()
 
 void ABomb::PreformDelayedExplosion(float ExplosionDelay)
 {
-    FTimerHandle TimerHandle;
-    
-    FTimerDelegate TimerDel;
-    TimerDel.BindUFunction(this, FName("Explode"));
-    
-    GetWorld()->GetTimerManager().SetTimer(TimerHandle, TimerDel, ExplosionDelay, false);
+    // The fuse doesn't outlive the bomb
+    AGameplayTimerService* Timers = AGameplayTimerService::Get(GetWorld());
+    if (Timers)
+    {
+        Timers->SetTimer(this, &ABomb::Explode, ExplosionDelay);
+    }
 }
 
 void ABomb::Explode()
 {
+    TG_SCOPE_CYCLE_COUNTER(BombExplode);
+    
+    // Dormant actors have no channel to send the explosion through
+    SetNetDormancy(DORM_Awake);
+    
     SimulateExplosionFX();
     
     // We won't use any specific damage types in our case
     TSubclassOf<UDamageType> DmgType;
-    // Do not ignore any actors
-    TArray<AActor*> IgnoreActors;
     
+    // Bombs exploding in the same frame get resolved together at the end of it.
     // This will eventually call the TakeDamage function that we have overriden in the character class
-    UGameplayStatics::ApplyRadialDamage(
-                                        GetWorld(),
-                                        ExplosionDamage,
-                                        GetActorLocation(),
-                                        ExplosionRadius,
-                                        DmgType,
-                                        IgnoreActors,
-                                        this,
-                                        GetInstigatorController());
-    FTimerHandle TimerHandle;
-    FTimerDelegate TimerDel;
-    
-    TimerDel.BindLambda([&]()
-                        {
-                            Destroy();
-                        });
-    
-    // Destroy the actor after 0.3 seconds.
-    GetWorld()->GetTimerManager().SetTimer(TimerHandle, TimerDel, 0.3f, false);
+    ARadialDamageResolver* DamageResolver = ARadialDamageResolver::Get(GetWorld());
+    if (DamageResolver)
+    {
+        DamageResolver->QueueExplosion(GetActorLocation(), ExplosionRadius, ExplosionDamage, DmgType, this, GetInstigatorController());
+    }
+    else
+    {
+        // Do not ignore any actors
+        TArray<AActor*> IgnoreActors;
+        
+        UGameplayStatics::ApplyRadialDamage(
+                                            GetWorld(),
+                                            ExplosionDamage,
+                                            GetActorLocation(),
+                                            ExplosionRadius,
+                                            DmgType,
+                                            IgnoreActors,
+                                            this,
+                                            GetInstigatorController());
+    }
+    // Destroy the actor after 0.3 seconds. The timer only runs while we're still around
+    AGameplayTimerService* Timers = AGameplayTimerService::Get(GetWorld());
+    if (Timers)
+    {
+        Timers->SetTimer(this, 0.3f, [this]() { Destroy(); });
+    }
 }
 
 void ABomb::SimulateExplosionFX_Implementation()
 {
-    if (ExplosionFX)
+    // Loaded with the combat bundle, a bomb going off before it's in goes off without it
+    if (ExplosionFX.Get())
     {
-        UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ExplosionFX, GetTransform(), true);
+        UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ExplosionFX.Get(), GetTransform(), true);
     }
 }
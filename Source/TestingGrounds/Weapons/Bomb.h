@@ -4,6 +4,7 @@
 
 #include "GameFramework/Actor.h"
 #include "GameFramework/ProjectileMovementComponent.h"
+#include "../ReplicationPolicy.h"
 #include "Bomb.generated.h"
 
 UCLASS()
@@ -18,6 +19,16 @@ public:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 	
+    virtual void PostInitializeComponents() override;
+    
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    
+    // Sets the delay until explosion. Only affects bombs that haven't armed yet
+    void SetFuseTime(float NewFuseTime) { FuseTime = NewFuseTime; }
+    
+    // The explosion effect, for whoever preloads the bomb
+    const TAssetPtr<UParticleSystem>& GetExplosionFX() const { return ExplosionFX; }
+	
 //	// Called every frame
 //	virtual void Tick( float DeltaSeconds ) override;
 
@@ -46,9 +57,17 @@ protected:
     UPROPERTY(EditAnywhere, Category = "BombProps")
     float ExplosionDamage = 25.f;
     
+    // The base color of the bomb once armed
+    UPROPERTY(EditAnywhere, Category = "BombProps")
+    FLinearColor ArmedColor = FLinearColor::Red;
+    
     // The particle system of the explosion
     UPROPERTY(EditAnywhere)
-    UParticleSystem* ExplosionFX;
+    TAssetPtr<UParticleSystem> ExplosionFX;
+    
+    // Relevancy and update frequency of the bomb. Resting armed bombs go dormant on top of it
+    UPROPERTY(EditDefaultsOnly, Category = "BombProps")
+    FReplicationPolicy ReplicationPolicy;
     
 private:
     
@@ -69,6 +88,19 @@ private:
     UFUNCTION()
     void OnProjectileBounce(const FHitResult& ImpactResult, const FVector& ImpactVelocity);
     
+    // Called when our bomb comes to rest
+    UFUNCTION()
+    void OnProjectileStop(const FHitResult& ImpactResult);
+    
+    // Stops replicating the bomb once it's armed and resting - nothing changes until it explodes
+    void TryGoDormant();
+    
+    // Scales the net update frequency with the bomb's speed. Runs in the Weapon category of the ATickAggregator
+    void UpdateReplication(float DeltaSeconds);
+    
+    // True once the projectile movement has come to rest
+    bool bIsResting = false;
+    
     // Preforms an explosion after a certain amount of time
     void PreformDelayedExplosion(float ExplosionDelay);
     
@@ -3,14 +3,17 @@
 #include "TestingGrounds.h"
 #include "Gun.h"
 #include "BallProjectile.h"
+#include "ProjectilePool.h"
+#include "PredictedFireComponent.h"
+#include "../TestingGroundsStats.h"
 #include "Animation/AnimInstance.h"
 
 
 // Sets default values
 AGun::AGun()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+    // Nothing to update per frame. Periodic updates go through the ATickAggregator
+	PrimaryActorTick.bCanEverTick = false;
 
     // Create a gun mesh component
     FP_Gun = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("FP_Gun"));
@@ -31,17 +34,25 @@ void AGun::BeginPlay()
 {
 	Super::BeginPlay();
 	
-}
-
-// Called every frame
-void AGun::Tick( float DeltaTime )
-{
-	Super::Tick( DeltaTime );
-
+    // Pre-warm the pool so the first shots don't pay for the spawns
+    ProjectilePool = AProjectilePool::Get(GetWorld());
+    if (ProjectilePool.IsValid() && ProjectileClass != NULL)
+    {
+        ProjectilePool->Prewarm(ProjectileClass, ProjectilePoolSize);
+    }
+    
+    // The gun doesn't replicate, its owner carries the fire RPC for it. Spawn the gun with its pawn as owner
+    if (GetOwner())
+    {
+        FireComponent = GetOwner()->FindComponentByClass<UPredictedFireComponent>();
+        if (FireComponent.IsValid()) FireComponent->SetGun(this);
+    }
 }
 
 void AGun::OnFire()
 {
+    TG_SCOPE_CYCLE_COUNTER(GunFire);
+    
     // try and fire a projectile
     if (ProjectileClass != NULL)
     {
@@ -49,11 +60,16 @@ void AGun::OnFire()
         // MuzzleOffset is in camera space, so transform it to world space before offsetting from the character location to find the final muzzle position
         const FVector SpawnLocation = FP_MuzzleLocation->GetComponentLocation();
         
-        UWorld* const World = GetWorld();
-        if (World != NULL)
+        APawn* Shooter = Cast<APawn>(GetOwner());
+        if (FireMode == EGunFireMode::Predicted && FireComponent.IsValid() && Shooter && Shooter->Role < ROLE_Authority)
         {
-            // spawn the projectile at the muzzle
-            World->SpawnActor<ABallProjectile>(ProjectileClass, SpawnLocation, SpawnRotation);
+            // Remote client: show the shot now, the server launches the real one
+            FireComponent->FirePredicted(SpawnLocation, SpawnRotation);
+        }
+        else
+        {
+            ABallProjectile* Projectile = LaunchProjectile(SpawnLocation, SpawnRotation);
+            if (Projectile && Shooter && FireMode == EGunFireMode::Predicted) Projectile->SetShot(Shooter, 0);
         }
     }
     
@@ -73,4 +89,18 @@ void AGun::OnFire()
         }
     }
     
-}
\ No newline at end of file
+}
+
+ABallProjectile* AGun::LaunchProjectile(const FVector& Location, const FRotator& Rotation)
+{
+    if (ProjectileClass == NULL) return nullptr;
+    
+    TG_INC_COUNTER(Spawns);
+    if (ProjectilePool.IsValid())
+    {
+        return ProjectilePool->AcquireProjectile(ProjectileClass, Location, Rotation);
+    }
+    
+    UWorld* const World = GetWorld();
+    return World ? World->SpawnActor<ABallProjectile>(ProjectileClass, Location, Rotation) : nullptr;
+}
@@ -5,6 +5,16 @@
 #include "GameFramework/Actor.h"
 #include "Gun.generated.h"
 
+// How the gun's shots reach the other players
+UENUM(BlueprintType)
+enum class EGunFireMode : uint8
+{
+    // The machine that fired launches the projectile. Shots of clients stay on that client
+    Local,
+    // The server launches the projectile and replicates it, the owning client shows a cosmetic one meanwhile
+    Predicted
+};
+
 UCLASS()
 class TESTINGGROUNDS_API AGun : public AActor
 {
@@ -25,13 +35,18 @@ public:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 	
-	// Called every frame
-	virtual void Tick( float DeltaSeconds ) override;
-
     /** Projectile class to spawn */
     UPROPERTY(EditDefaultsOnly, Category=Projectile)
     TSubclassOf<class ABallProjectile> ProjectileClass;
     
+    /** How the shots reach the other players */
+    UPROPERTY(EditDefaultsOnly, Category=Projectile)
+    EGunFireMode FireMode = EGunFireMode::Predicted;
+    
+    /** Number of projectiles pre-spawned into the world's projectile pool */
+    UPROPERTY(EditDefaultsOnly, Category=Projectile)
+    int32 ProjectilePoolSize = 32;
+    
     /** Sound to play each time we fire */
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay)
     class USoundBase* FireSound;
@@ -46,5 +61,14 @@ public:
     /** Fires a projectile. */
     UFUNCTION(BlueprintCallable, Category = "Input")
     void OnFire();
+    
+    /** Takes a projectile from the pool and launches it from the given location */
+    class ABallProjectile* LaunchProjectile(const FVector& Location, const FRotator& Rotation);
 	
+private:
+    /** The component of our owner that carries predicted shots to the server */
+    TWeakObjectPtr<class UPredictedFireComponent> FireComponent;
+    
+    /** The pool our projectiles are taken from */
+    TWeakObjectPtr<class AProjectilePool> ProjectilePool;
 };
@@ -0,0 +1,301 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "PredictedFireComponent.h"
+#include "Gun.h"
+#include "BallProjectile.h"
+#include "../LagCompensation.h"
+#include "../Magic/SkillsComponent.h"
+#include "../LoadTest/LoadTestNetDriver.h"
+#include "../TestingGroundsStats.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+
+
+// Sets default values for this component's properties
+UPredictedFireComponent::UPredictedFireComponent()
+{
+	// Only ticks on frames with reported hits, once the projectiles have moved
+	bWantsBeginPlay = false;
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+
+    // Needed for the fire RPC
+    bReplicates = true;
+}
+
+void UPredictedFireComponent::FirePredicted(const FVector& Origin, const FRotator& Rotation)
+{
+    if (!Gun.IsValid()) return;
+
+    DropExpiredShots();
+
+    LastShotID = GetNextShotID(LastShotID);
+
+    // The player sees the shot this frame, whatever the round trip
+    ABallProjectile* Cosmetic = Gun->LaunchProjectile(Origin, Rotation);
+    if (Cosmetic)
+    {
+        Cosmetic->SetCosmetic(true);
+        Cosmetic->SetShot(Cast<APawn>(GetOwner()), LastShotID);
+    }
+
+    FPendingShot& Shot = PendingShots[PendingShots.AddDefaulted()];
+    Shot.ShotID = LastShotID;
+    Shot.Cosmetic = Cosmetic;
+    Shot.FireTime = FPlatformTime::Seconds();
+    TG_INC_COUNTER(ShotsFired);
+
+    ServerFire(Origin, Rotation.Vector(), LastShotID);
+}
+
+void UPredictedFireComponent::ConfirmShot(uint8 ShotID, ABallProjectile* Authoritative)
+{
+    const int32 Index = PendingShots.IndexOfByPredicate([ShotID](const FPendingShot& Shot) { return Shot.ShotID == ShotID; });
+    if (Index == INDEX_NONE) return;
+
+    const FPendingShot Shot = PendingShots[Index];
+    PendingShots.RemoveAtSwap(Index, 1, false);
+
+    TG_INC_COUNTER(ShotsConfirmed);
+    const uint32 ConfirmUs = (uint32)((FPlatformTime::Seconds() - Shot.FireTime) * 1000000.0);
+    TG_SET_DWORD(ShotConfirmUs, ConfirmUs);
+
+    // The cosmetic projectile is where the player expects the shot to be, it stays the visible one
+    if (Shot.Cosmetic.IsValid() && !Shot.Cosmetic->IsInPool())
+    {
+        Authoritative->HideBehindCosmetic(Shot.Cosmetic.Get());
+    }
+}
+
+void UPredictedFireComponent::ServerFire_Implementation(FVector_NetQuantize Origin, FVector_NetQuantizeNormal Direction, uint8 ShotID)
+{
+    ULoadTestNetDriver::CountReceivedRPC(GetOwner(), FName("ServerFire"));
+
+    APawn* Shooter = Cast<APawn>(GetOwner());
+    if (!Gun.IsValid() || Shooter == nullptr) return;
+
+    // A shot from somewhere else than the shooter, drop it instead of trusting the client
+    if (FVector::DistSquared(Origin, Shooter->GetActorLocation()) > FMath::Square(MaxOriginDistance)) return;
+
+    ABallProjectile* Projectile = Gun->LaunchProjectile(Origin, Direction.Rotation());
+    if (Projectile) Projectile->SetShot(Shooter, ShotID);
+
+    // The owning client reports what the shot hits, somewhere along its flight
+    const ABallProjectile* ProjectileDefaults = Gun->ProjectileClass ? Gun->ProjectileClass->GetDefaultObject<ABallProjectile>() : nullptr;
+    AddServerShot(ShotID, ESkillType::MAX, Origin, Direction, ProjectileDefaults ? ProjectileDefaults->GetProjectileMovement() : nullptr);
+}
+
+bool UPredictedFireComponent::ServerFire_Validate(FVector_NetQuantize Origin, FVector_NetQuantizeNormal Direction, uint8 ShotID)
+{
+    return ShotID != 0;
+}
+
+void UPredictedFireComponent::CastPredicted(ESkillType SkillType, const TArray<ASkill*>& Instances)
+{
+    const int32 NumInstances = FMath::Min(Instances.Num(), MaxInstancesPerCast);
+    if (NumInstances == 0) return;
+
+    const uint8 FirstShotID = GetNextShotID(LastShotID);
+    TArray<FSkillCastInstance> CastInstances;
+    for (int32 i = 0; i < NumInstances; i++)
+    {
+        LastShotID = GetNextShotID(LastShotID);
+
+        // An instance that failed to spawn keeps its ID but never reports a hit
+        FSkillCastInstance& CastInstance = CastInstances[CastInstances.AddDefaulted()];
+        const AActor* Launched = Instances[i];
+        if (Launched == nullptr) Launched = GetOwner();
+        CastInstance.Origin = Launched->GetActorLocation();
+        CastInstance.Direction = Launched->GetActorForwardVector();
+        if (Instances[i]) Instances[i]->SetShotID(LastShotID);
+    }
+
+    // The server sees the hits of its own skills, there's nothing to record
+    if (GetOwnerRole() != ROLE_Authority)
+    {
+        ServerCastSkill(SkillType, FirstShotID, CastInstances);
+    }
+}
+
+void UPredictedFireComponent::ServerCastSkill_Implementation(ESkillType SkillType, uint8 FirstShotID, const TArray<FSkillCastInstance>& Instances)
+{
+    ULoadTestNetDriver::CountReceivedRPC(GetOwner(), FName("ServerCastSkill"));
+
+    // The cooldown counts on the server too, or a client could cast as often as it likes
+    USkillsComponent* SkillsComponent = GetOwner()->FindComponentByClass<USkillsComponent>();
+    if (SkillsComponent == nullptr || !SkillsComponent->IsSkillReady(SkillType)) return;
+    SkillsComponent->CommitSkillCooldown(SkillType);
+
+    ASkill* SkillDefaults = SkillsComponent->GetSkillByType(SkillType);
+    const UProjectileMovementComponent* Movement = SkillDefaults ? SkillDefaults->GetProjectileMovement() : nullptr;
+    const FVector ShooterLocation = GetOwner()->GetActorLocation();
+
+    // Every level adds an instance
+    const int32 NumAllowed = FMath::Min<int32>(Instances.Num(), SkillsComponent->GetSkillLevelByType(SkillType));
+    uint8 ShotID = FirstShotID;
+    for (int32 i = 0; i < NumAllowed; i++)
+    {
+        // Same as shots, an instance launched from somewhere else than the caster never hits
+        const FSkillCastInstance& Instance = Instances[i];
+        if (FVector::DistSquared(Instance.Origin, ShooterLocation) <= FMath::Square(MaxOriginDistance))
+        {
+            AddServerShot(ShotID, SkillType, Instance.Origin, Instance.Direction, Movement);
+        }
+        ShotID = GetNextShotID(ShotID);
+    }
+}
+
+bool UPredictedFireComponent::ServerCastSkill_Validate(ESkillType SkillType, uint8 FirstShotID, const TArray<FSkillCastInstance>& Instances)
+{
+    return FirstShotID != 0 && SkillType < ESkillType::MAX && Instances.Num() > 0 && Instances.Num() <= MaxInstancesPerCast;
+}
+
+void UPredictedFireComponent::AddServerShot(uint8 ShotID, ESkillType SkillType, const FVector& Origin, const FVector& Direction, const UProjectileMovementComponent* Movement)
+{
+    ServerShots.RemoveAll([ShotID](const FPendingShot& Shot) { return Shot.ShotID == ShotID; });
+    FPendingShot& Shot = ServerShots[ServerShots.AddDefaulted()];
+    Shot.ShotID = ShotID;
+    Shot.SkillType = SkillType;
+    Shot.FireTime = FPlatformTime::Seconds();
+    Shot.Origin = Origin;
+    Shot.Direction = Direction.GetSafeNormal();
+
+    // Without a movement to go by, nothing the shot reports gets accepted
+    if (Movement)
+    {
+        Shot.Speed = FMath::Max(Movement->InitialSpeed, Movement->MaxSpeed);
+        Shot.bStraight = !Movement->bShouldBounce && Movement->ProjectileGravityScale == 0.f;
+    }
+}
+
+bool UPredictedFireComponent::IsOnShotPath(const FPendingShot& Shot, const FVector& HitLocation) const
+{
+    if (Shot.Speed <= 0.f) return false;
+
+    // Not even a straight flight at full speed gets further in the time the shot had
+    const float FlightTime = (float)(FPlatformTime::Seconds() - Shot.FireTime) + HitTimeTolerance;
+    const FVector Offset = HitLocation - Shot.Origin;
+    if (Offset.SizeSquared() > FMath::Square(Shot.Speed * FlightTime + HitPathTolerance)) return false;
+
+    // Bouncing or falling shots may hit anywhere in reach, straight ones only ahead along their ray
+    if (!Shot.bStraight) return true;
+    return (Offset | Shot.Direction) >= -HitPathTolerance && FMath::PointDistToLine(HitLocation, Shot.Direction, Shot.Origin) <= HitPathTolerance;
+}
+
+void UPredictedFireComponent::ReportHit(AActor* Victim, const FVector& HitLocation, uint8 ShotID, ESkillType SkillType, float Damage)
+{
+    APawn* Shooter = Cast<APawn>(GetOwner());
+    if (Victim == nullptr || Shooter == nullptr || Victim == Shooter) return;
+
+    // The server saw the hit itself, there's nothing to compensate
+    if (GetOwnerRole() == ROLE_Authority)
+    {
+        const FVector ShotDirection = (HitLocation - Shooter->GetActorLocation()).GetSafeNormal();
+        FHitResult HitResult(Victim, nullptr, HitLocation, -ShotDirection);
+        UGameplayStatics::ApplyPointDamage(Victim, Damage, ShotDirection, HitResult, Shooter->GetController(), Shooter, UDamageType::StaticClass());
+        return;
+    }
+
+    UWorld* World = GetWorld();
+    FReportedHit& Hit = PendingHits[PendingHits.AddDefaulted()];
+    Hit.Victim = Victim;
+    Hit.HitLocation = HitLocation;
+    Hit.ViewTime = World->GameState ? World->GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+    Hit.ShotID = ShotID;
+    Hit.SkillType = SkillType;
+
+    // Every hit of the frame goes out in the same report, at the end of the frame
+    SetComponentTickEnabled(true);
+}
+
+void UPredictedFireComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    SendReportedHits();
+    SetComponentTickEnabled(false);
+}
+
+void UPredictedFireComponent::SendReportedHits()
+{
+    for (int32 First = 0; First < PendingHits.Num(); First += MaxHitsPerReport)
+    {
+        const int32 NumHits = FMath::Min(MaxHitsPerReport, PendingHits.Num() - First);
+        ServerReportHits(TArray<FReportedHit>(PendingHits.GetData() + First, NumHits));
+    }
+    PendingHits.Reset();
+}
+
+void UPredictedFireComponent::ServerReportHits_Implementation(const TArray<FReportedHit>& Hits)
+{
+    ULoadTestNetDriver::CountReceivedRPC(GetOwner(), FName("ServerReportHits"));
+
+    APawn* Shooter = Cast<APawn>(GetOwner());
+    ALagCompensation* LagCompensation = ALagCompensation::Get(GetWorld());
+    if (Shooter == nullptr || LagCompensation == nullptr) return;
+
+    // The lag compensation checks them against where the victims were when the client saw them
+    for (const FReportedHit& Hit : Hits)
+    {
+        if (Hit.Victim == nullptr || Hit.Victim == Shooter) continue;
+
+        FVector ShotOrigin;
+        const float Damage = GetReportedHitDamage(Hit, ShotOrigin);
+        if (Damage < 0.f) continue;
+
+        FCompensatedHit CompensatedHit;
+        CompensatedHit.Victim = Hit.Victim;
+        CompensatedHit.HitLocation = Hit.HitLocation;
+        CompensatedHit.ShotDirection = (Hit.HitLocation - ShotOrigin).GetSafeNormal();
+        CompensatedHit.ViewTime = LagCompensation->ClampViewTime(Shooter, Hit.ViewTime);
+        CompensatedHit.Damage = Damage;
+        CompensatedHit.InstigatedBy = Shooter->GetController();
+        CompensatedHit.DamageCauser = Shooter;
+        LagCompensation->QueueHit(CompensatedHit);
+    }
+}
+
+bool UPredictedFireComponent::ServerReportHits_Validate(const TArray<FReportedHit>& Hits)
+{
+    return Hits.Num() <= MaxHitsPerReport;
+}
+
+float UPredictedFireComponent::GetReportedHitDamage(const FReportedHit& Hit, FVector& OutShotOrigin)
+{
+    // A shot or skill instance hits once, and only while it could still be flying
+    const double OldestFireTime = FPlatformTime::Seconds() - MaxShotFlightTime;
+    ServerShots.RemoveAll([OldestFireTime](const FPendingShot& Shot) { return Shot.FireTime < OldestFireTime; });
+
+    const int32 Index = ServerShots.IndexOfByPredicate([&Hit](const FPendingShot& Shot) { return Shot.ShotID == Hit.ShotID; });
+    if (Index == INDEX_NONE || ServerShots[Index].SkillType != Hit.SkillType) return -1.f;
+
+    // A hit off the shot's path doesn't use the shot up, its real hit may still come
+    if (!IsOnShotPath(ServerShots[Index], Hit.HitLocation)) return -1.f;
+    OutShotOrigin = ServerShots[Index].Origin;
+    ServerShots.RemoveAtSwap(Index, 1, false);
+
+    if (Hit.SkillType == ESkillType::MAX)
+    {
+        if (!Gun.IsValid() || Gun->ProjectileClass == nullptr) return -1.f;
+        return Gun->ProjectileClass->GetDefaultObject<ABallProjectile>()->GetHitDamage();
+    }
+
+    // The cast already checked the level
+    USkillsComponent* SkillsComponent = GetOwner()->FindComponentByClass<USkillsComponent>();
+    ASkill* SkillDefaults = SkillsComponent ? SkillsComponent->GetSkillByType(Hit.SkillType) : nullptr;
+    return SkillDefaults ? SkillDefaults->GetHitDamage() : -1.f;
+}
+
+void UPredictedFireComponent::DropExpiredShots()
+{
+    const double ExpireTime = FPlatformTime::Seconds() - ShotConfirmTimeout;
+    for (int32 i = PendingShots.Num() - 1; i >= 0; i--)
+    {
+        if (PendingShots[i].FireTime < ExpireTime)
+        {
+            PendingShots.RemoveAtSwap(i, 1, false);
+            TG_INC_COUNTER(ShotsLost);
+        }
+    }
+}
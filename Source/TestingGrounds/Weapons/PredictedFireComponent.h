@@ -0,0 +1,196 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "../Magic/Skill.h"
+#include "PredictedFireComponent.generated.h"
+
+class AGun;
+class ABallProjectile;
+class UProjectileMovementComponent;
+
+// A shot the local client fired and the server hasn't confirmed yet, or one the server launched and that didn't hit yet
+struct FPendingShot
+{
+    uint8 ShotID = 0;
+
+    // The skill of a skill instance, MAX for gun shots
+    ESkillType SkillType = ESkillType::MAX;
+
+    // The cosmetic projectile the client launched when the shot was fired
+    TWeakObjectPtr<ABallProjectile> Cosmetic;
+
+    double FireTime = 0.0;
+
+    // Where the shot or skill instance was launched from and where it headed. Server only
+    FVector Origin = FVector::ZeroVector;
+    FVector Direction = FVector::ForwardVector;
+
+    // The fastest it flies, and whether it flies a straight line along Direction. Server only
+    float Speed = 0.f;
+    bool bStraight = false;
+};
+
+// A hit the owning client saw one of its shots or skills make
+USTRUCT()
+struct FReportedHit
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    AActor* Victim = nullptr;
+
+    UPROPERTY()
+    FVector_NetQuantize HitLocation;
+
+    // The server time of the world the client saw when the hit happened
+    UPROPERTY()
+    float ViewTime = 0.f;
+
+    // The shot or skill instance that hit
+    UPROPERTY()
+    uint8 ShotID = 0;
+
+    // The skill that hit, MAX for gun shots
+    UPROPERTY()
+    ESkillType SkillType = ESkillType::MAX;
+};
+
+// Where one instance of a cast skill was launched
+USTRUCT()
+struct FSkillCastInstance
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    FVector_NetQuantize Origin;
+
+    UPROPERTY()
+    FVector_NetQuantizeNormal Direction;
+};
+
+/**
+ * Carries the gun fire of a pawn to the server.
+ * The owning client launches a cosmetic projectile right away and sends a compact fire RPC;
+ * the server launches the authoritative projectile, which replicates back with the shot ID so the
+ * client can reconcile it with its cosmetic one. Skill casts get a shot ID per instance the same way.
+ * The hits the owning client's shots and skills make on characters get reported back, once per frame, and the server
+ * applies them if they lie on the path of the shot as it was fired and hold up against the ALagCompensation history.
+ * Test with lag on a client console, e.g. "Net PktLag=150" for a 150 ms round trip,
+ * and use "stat TestingGrounds" or tg.Stats.Capture there to see how long the server takes to confirm the shots.
+ */
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class TESTINGGROUNDS_API UPredictedFireComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	UPredictedFireComponent();
+
+    // Sends the hits reported this frame
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+    // The gun whose shots go through this component
+    void SetGun(AGun* InGun) { Gun = InGun; }
+
+    // Launches a cosmetic projectile and asks the server for the real one. Owning client only
+    void FirePredicted(const FVector& Origin, const FRotator& Rotation);
+
+    // Called on the owning client when the authoritative projectile of one of our shots arrives
+    void ConfirmShot(uint8 ShotID, ABallProjectile* Authoritative);
+
+    // Gives every instance of a skill we just cast a shot ID and tells the server about the cast. Owning client only
+    void CastPredicted(ESkillType SkillType, const TArray<ASkill*>& Instances);
+
+    /**
+     * Reports that one of our shots or skill instances (ShotID) hit Victim. Owning client only.
+     * Hits seen by the server itself deal Damage right away. Remote clients send theirs along with the frame's other hits,
+     * and the server works out their damage itself.
+     */
+    void ReportHit(AActor* Victim, const FVector& HitLocation, uint8 ShotID, ESkillType SkillType, float Damage);
+
+protected:
+    // Shots the server hasn't confirmed after this many seconds are considered lost
+    UPROPERTY(EditDefaultsOnly, Category = "Fire")
+    float ShotConfirmTimeout = 1.f;
+
+    // The server ignores shots whose origin is further than this from the pawn
+    UPROPERTY(EditDefaultsOnly, Category = "Fire")
+    float MaxOriginDistance = 300.f;
+
+    // The server accepts the hit of a shot or skill instance for this long after it was fired
+    UPROPERTY(EditDefaultsOnly, Category = "Fire")
+    float MaxShotFlightTime = 3.f;
+
+    // How far off its path a shot or skill instance may hit, covering its collision and the victim's capsule
+    UPROPERTY(EditDefaultsOnly, Category = "Fire")
+    float HitPathTolerance = 120.f;
+
+    // The seconds a reported hit may arrive early compared to its fire RPC, covering jitter
+    UPROPERTY(EditDefaultsOnly, Category = "Fire")
+    float HitTimeTolerance = 0.1f;
+
+private:
+    /** Launches the authoritative projectile of a shot the owning client fired. Unreliable, a lost shot times out on the client */
+    UFUNCTION(Server, Unreliable, WithValidation)
+    void ServerFire(FVector_NetQuantize Origin, FVector_NetQuantizeNormal Direction, uint8 ShotID);
+
+    void ServerFire_Implementation(FVector_NetQuantize Origin, FVector_NetQuantizeNormal Direction, uint8 ShotID);
+
+    bool ServerFire_Validate(FVector_NetQuantize Origin, FVector_NetQuantizeNormal Direction, uint8 ShotID);
+
+    /** Commits the cooldown of a skill the owning client cast and lets each of its instances hit once, along its own path */
+    UFUNCTION(Server, Reliable, WithValidation)
+    void ServerCastSkill(ESkillType SkillType, uint8 FirstShotID, const TArray<FSkillCastInstance>& Instances);
+
+    void ServerCastSkill_Implementation(ESkillType SkillType, uint8 FirstShotID, const TArray<FSkillCastInstance>& Instances);
+
+    bool ServerCastSkill_Validate(ESkillType SkillType, uint8 FirstShotID, const TArray<FSkillCastInstance>& Instances);
+
+    /** Applies the hits the owning client saw, once the lag compensation confirms them */
+    UFUNCTION(Server, Reliable, WithValidation)
+    void ServerReportHits(const TArray<FReportedHit>& Hits);
+
+    void ServerReportHits_Implementation(const TArray<FReportedHit>& Hits);
+
+    bool ServerReportHits_Validate(const TArray<FReportedHit>& Hits);
+
+    // Forgets the shots the server never confirmed
+    void DropExpiredShots();
+
+    // Sends the hits reported this frame in as few reports as they fit
+    void SendReportedHits();
+
+    // Returns the damage of a reported hit and where its shot came from, or a negative value if the shooter couldn't have made it. Server only
+    float GetReportedHitDamage(const FReportedHit& Hit, FVector& OutShotOrigin);
+
+    // Returns true if the shot could have reached HitLocation by now. Server only
+    bool IsOnShotPath(const FPendingShot& Shot, const FVector& HitLocation) const;
+
+    // Remembers a shot or skill instance the owning client may report a hit of, flying like Movement. Server only
+    void AddServerShot(uint8 ShotID, ESkillType SkillType, const FVector& Origin, const FVector& Direction, const UProjectileMovementComponent* Movement);
+
+    // Returns the ID after ShotID, skipping 0
+    static uint8 GetNextShotID(uint8 ShotID) { return (ShotID == MAX_uint8) ? 1 : ShotID + 1; }
+
+    // The most hits a single report may carry
+    static const int32 MaxHitsPerReport = 32;
+
+    // The most instances a single cast may spawn
+    static const int32 MaxInstancesPerCast = 8;
+
+    TWeakObjectPtr<AGun> Gun;
+
+    TArray<FPendingShot> PendingShots;
+
+    // The hits waiting for the end of the frame. Owning client only
+    TArray<FReportedHit> PendingHits;
+
+    // The shots and skill instances of the owning client that didn't hit anyone yet. Server only
+    TArray<FPendingShot> ServerShots;
+
+    // The ID of the last shot or skill instance we fired. 0 is never used, it marks unpredicted projectiles
+    uint8 LastShotID = 0;
+};
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "ProjectilePool.h"
+#include "BallProjectile.h"
+#include "../WorldManager.h"
+
+
+AProjectilePool* AProjectilePool::Get(UWorld* World)
+{
+    return GetWorldManager<AProjectilePool>(World);
+}
+
+ABallProjectile* AProjectilePool::AcquireProjectile(TSubclassOf<ABallProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation)
+{
+    ABallProjectile* Projectile = Cast<ABallProjectile>(AcquireActor(ProjectileClass));
+    if (Projectile) Projectile->OnAcquiredFromPool(Location, Rotation);
+    return Projectile;
+}
+
+void AProjectilePool::ReleaseProjectile(ABallProjectile* Projectile)
+{
+    if (Projectile == nullptr || Projectile->IsInPool()) return;
+
+    ReleaseActor(Projectile);
+}
+
+void AProjectilePool::InitPooledActor(AActor* Actor)
+{
+    CastChecked<ABallProjectile>(Actor)->SetOwningPool(this);
+}
+
+void AProjectilePool::ParkPooledActor(AActor* Actor)
+{
+    CastChecked<ABallProjectile>(Actor)->OnReturnedToPool();
+}
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "../ActorPool.h"
+#include "ProjectilePool.generated.h"
+
+class ABallProjectile;
+
+/**
+ * Per-world pool of ABallProjectile instances.
+ * Projectiles are spawned once, handed out on fire and parked again on hit or lifespan expiry,
+ * so sustained fire doesn't churn actor spawns and garbage collection.
+ */
+UCLASS()
+class TESTINGGROUNDS_API AProjectilePool : public AActorPool
+{
+	GENERATED_BODY()
+
+public:
+    // Returns the pool of the given world, spawning it if needed
+    static AProjectilePool* Get(UWorld* World);
+
+    // Makes sure at least Count projectiles of the given class exist in the pool
+    void Prewarm(TSubclassOf<ABallProjectile> ProjectileClass, int32 Count) { PrewarmActors(ProjectileClass, Count); }
+
+    /**
+     * Hands out a projectile placed at the given location and launched along the given rotation.
+     * Spawns a new one (and counts an overflow) if every pooled projectile is in flight.
+     */
+    ABallProjectile* AcquireProjectile(TSubclassOf<ABallProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation);
+
+    // Parks the projectile until it gets handed out again
+    void ReleaseProjectile(ABallProjectile* Projectile);
+
+protected:
+    virtual void InitPooledActor(AActor* Actor) override;
+
+    virtual void ParkPooledActor(AActor* Actor) override;
+};
@@ -0,0 +1,283 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "ProjectileSimulation.h"
+#include "BallProjectile.h"
+#include "ParallelFor.h"
+#include "../WorldManager.h"
+
+
+static TAutoConsoleVariable<int32> CVarProjectileSimulation(
+    TEXT("tg.ProjectileSim.Enable"),
+    1,
+    TEXT("1: ball projectiles launched from now on move through the projectile simulation. 0: through their movement component"));
+
+static TAutoConsoleVariable<int32> CVarProjectileSimulationParallel(
+    TEXT("tg.ProjectileSim.Parallel"),
+    1,
+    TEXT("0: the projectile simulation runs on the game thread. 1: the integration runs on the task threads. 2: the sweeps as well"));
+
+
+// Sets default values
+AProjectileSimulation::AProjectileSimulation()
+{
+    // Only ticks while something is in flight, before physics like the movement components do
+	PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.bStartWithTickEnabled = false;
+    PrimaryActorTick.TickGroup = TG_PrePhysics;
+}
+
+void AProjectileSimulation::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    Simulate(DeltaSeconds);
+}
+
+AProjectileSimulation* AProjectileSimulation::Get(UWorld* World)
+{
+    return GetWorldManager<AProjectileSimulation>(World);
+}
+
+bool AProjectileSimulation::IsEnabled()
+{
+    return CVarProjectileSimulation.GetValueOnGameThread() != 0;
+}
+
+int32 AProjectileSimulation::AddProjectile(const FVector& Location, const FVector& Velocity, const FProjectileSimParams& InParams, ABallProjectile* Proxy)
+{
+    const int32 Index = Positions.Num();
+
+    int32 Handle;
+    if (FreeHandles.Num() > 0)
+    {
+        Handle = FreeHandles.Pop(false);
+        HandleToIndex[Handle] = Index;
+    }
+    else
+    {
+        Handle = HandleToIndex.Add(Index);
+    }
+
+    Positions.Add(Location);
+    Velocities.Add(Velocity);
+    Targets.Add(Location);
+    LifeRemaining.Add(InParams.LifeSpan);
+    GravityZ.Add(GetWorld()->GetGravityZ() * InParams.GravityScale);
+    MaxSpeeds.Add(InParams.MaxSpeed);
+    bResting.Add(0);
+    SweepHits.AddDefaulted();
+    bSweepHit.Add(0);
+    Params.Add(InParams);
+    Proxies.Add(Proxy);
+    IndexToHandle.Add(Handle);
+
+    SetActorTickEnabled(true);
+    return Handle;
+}
+
+void AProjectileSimulation::RemoveProjectile(int32 Handle)
+{
+    if (!HandleToIndex.IsValidIndex(Handle) || HandleToIndex[Handle] == INDEX_NONE) return;
+
+    RemoveAt(HandleToIndex[Handle]);
+}
+
+void AProjectileSimulation::Simulate(float DeltaSeconds)
+{
+    if (Positions.Num() == 0)
+    {
+        SetActorTickEnabled(false);
+        return;
+    }
+
+    const double StartTime = FPlatformTime::Seconds();
+
+    Integrate(DeltaSeconds);
+    Sweep();
+    Resolve(DeltaSeconds);
+    SyncProxies();
+
+    LastSimulateTimeMs = (float)((FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+    // The proxies may release themselves, and remove their projectile, while handling these
+    TArray<FProjectileEvent> Events = MoveTemp(PendingEvents);
+    PendingEvents.Reset();
+    for (const FProjectileEvent& Event : Events)
+    {
+        ABallProjectile* Proxy = Event.Proxy.Get();
+        if (Proxy == nullptr) continue;
+
+        if (Event.bExpired) Proxy->OnSimulatedExpiry();
+        else Proxy->OnSimulatedHit(Event.Hit);
+    }
+}
+
+void AProjectileSimulation::Integrate(float DeltaSeconds)
+{
+    FVector* RESTRICT PositionData = Positions.GetData();
+    FVector* RESTRICT VelocityData = Velocities.GetData();
+    FVector* RESTRICT TargetData = Targets.GetData();
+    float* RESTRICT LifeData = LifeRemaining.GetData();
+    const float* RESTRICT GravityData = GravityZ.GetData();
+    const float* RESTRICT MaxSpeedData = MaxSpeeds.GetData();
+    const uint8* RESTRICT RestingData = bResting.GetData();
+
+    // Small batches aren't worth the task overhead
+    const int32 BatchSize = 1024;
+    const int32 NumBatches = FMath::DivideAndRoundUp(Positions.Num(), BatchSize);
+    const int32 Num = Positions.Num();
+
+    ParallelFor(NumBatches, [=](int32 Batch)
+    {
+        const int32 End = FMath::Min((Batch + 1) * BatchSize, Num);
+        for (int32 i = Batch * BatchSize; i < End; i++)
+        {
+            LifeData[i] -= DeltaSeconds;
+            if (RestingData[i])
+            {
+                TargetData[i] = PositionData[i];
+                continue;
+            }
+
+            FVector Velocity = VelocityData[i];
+            Velocity.Z += GravityData[i] * DeltaSeconds;
+            if (MaxSpeedData[i] > 0.f) Velocity = Velocity.GetClampedToMaxSize(MaxSpeedData[i]);
+
+            VelocityData[i] = Velocity;
+            TargetData[i] = PositionData[i] + Velocity * DeltaSeconds;
+        }
+    }, CVarProjectileSimulationParallel.GetValueOnGameThread() < 1 || NumBatches < 2);
+}
+
+void AProjectileSimulation::Sweep()
+{
+    UWorld* World = GetWorld();
+    static const FName SweepTag(TEXT("ProjectileSimulation"));
+
+    // Scene queries only read the physics scene, so they can run side by side like async traces do
+    ParallelFor(Positions.Num(), [&](int32 i)
+    {
+        bSweepHit[i] = 0;
+        if (bResting[i] || Positions[i] == Targets[i]) return;
+
+        const FProjectileSimParams& ProjectileParams = Params[i];
+        const FCollisionQueryParams QueryParams(SweepTag, false, Proxies[i]);
+
+        bSweepHit[i] = World->SweepSingleByChannel(SweepHits[i],
+                                                   Positions[i],
+                                                   Targets[i],
+                                                   FQuat::Identity,
+                                                   ProjectileParams.Channel,
+                                                   FCollisionShape::MakeSphere(ProjectileParams.Radius),
+                                                   QueryParams,
+                                                   ProjectileParams.ResponseParams) ? 1 : 0;
+    }, CVarProjectileSimulationParallel.GetValueOnGameThread() < 2);
+}
+
+void AProjectileSimulation::Resolve(float DeltaSeconds)
+{
+    for (int32 i = Positions.Num() - 1; i >= 0; i--)
+    {
+        if (LifeRemaining[i] <= 0.f)
+        {
+            FProjectileEvent& Event = PendingEvents[PendingEvents.AddDefaulted()];
+            Event.Proxy = Proxies[i];
+            Event.bExpired = true;
+
+            RemoveAt(i);
+            continue;
+        }
+
+        if (!bSweepHit[i])
+        {
+            Positions[i] = Targets[i];
+            continue;
+        }
+
+        const FHitResult& Hit = SweepHits[i];
+        if (Hit.bStartPenetrating)
+        {
+            // Spawned inside something, push out and try again next step
+            Positions[i] += Hit.Normal * (Hit.PenetrationDepth + KINDA_SMALL_NUMBER);
+            continue;
+        }
+
+        Positions[i] = Hit.Location;
+
+        if (Proxies[i])
+        {
+            FProjectileEvent& Event = PendingEvents[PendingEvents.AddDefaulted()];
+            Event.Proxy = Proxies[i];
+            Event.Hit = Hit;
+        }
+
+        const FProjectileSimParams& ProjectileParams = Params[i];
+        if (!ProjectileParams.bShouldBounce)
+        {
+            Velocities[i] = FVector::ZeroVector;
+            bResting[i] = 1;
+            continue;
+        }
+
+        // Same response as the movement component: reflect the normal part, slow the tangential part
+        FVector Velocity = Velocities[i];
+        const float NormalSpeed = Velocity | Hit.Normal;
+        if (NormalSpeed < 0.f)
+        {
+            const FVector Tangent = (Velocity - NormalSpeed * Hit.Normal) * (1.f - ProjectileParams.Friction);
+            FVector Bounce = -NormalSpeed * ProjectileParams.Bounciness * Hit.Normal;
+
+            // Rolling on the ground, gravity alone would make it hop every step
+            if (Bounce.Size() < -GravityZ[i] * DeltaSeconds * 2.f) Bounce = FVector::ZeroVector;
+
+            Velocity = Tangent + Bounce;
+        }
+        Velocities[i] = Velocity;
+
+        if (Velocity.Size() < ProjectileParams.StopSpeed)
+        {
+            Velocities[i] = FVector::ZeroVector;
+            bResting[i] = 1;
+        }
+    }
+}
+
+void AProjectileSimulation::SyncProxies()
+{
+    for (int32 i = 0; i < Proxies.Num(); i++)
+    {
+        ABallProjectile* Proxy = Proxies[i];
+        if (Proxy == nullptr) continue;
+
+        // No sweep, the simulation already did it
+        const FRotator Rotation = Velocities[i].IsNearlyZero() ? Proxy->GetActorRotation() : Velocities[i].Rotation();
+        Proxy->SetActorLocationAndRotation(Positions[i], Rotation, false, nullptr, ETeleportType::None);
+
+        // Replicated movement reads the velocity of the root
+        Proxy->GetRootComponent()->ComponentVelocity = Velocities[i];
+    }
+}
+
+void AProjectileSimulation::RemoveAt(int32 Index)
+{
+    const int32 Handle = IndexToHandle[Index];
+    HandleToIndex[Handle] = INDEX_NONE;
+    FreeHandles.Add(Handle);
+
+    Positions.RemoveAtSwap(Index, 1, false);
+    Velocities.RemoveAtSwap(Index, 1, false);
+    Targets.RemoveAtSwap(Index, 1, false);
+    LifeRemaining.RemoveAtSwap(Index, 1, false);
+    GravityZ.RemoveAtSwap(Index, 1, false);
+    MaxSpeeds.RemoveAtSwap(Index, 1, false);
+    bResting.RemoveAtSwap(Index, 1, false);
+    SweepHits.RemoveAtSwap(Index, 1, false);
+    bSweepHit.RemoveAtSwap(Index, 1, false);
+    Params.RemoveAtSwap(Index, 1, false);
+    Proxies.RemoveAtSwap(Index, 1, false);
+    IndexToHandle.RemoveAtSwap(Index, 1, false);
+
+    // The last projectile took the freed index
+    if (IndexToHandle.IsValidIndex(Index)) HandleToIndex[IndexToHandle[Index]] = Index;
+}
@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "ProjectileSimulation.generated.h"
+
+class ABallProjectile;
+
+// How a simulated projectile moves and collides. Copied from the projectile's movement component
+struct FProjectileSimParams
+{
+    float Radius = 5.f;
+    float GravityScale = 1.f;
+    float MaxSpeed = 0.f;
+    float LifeSpan = 3.f;
+
+    bool bShouldBounce = false;
+    float Bounciness = 0.6f;
+    float Friction = 0.2f;
+
+    // Below this speed, in cm/sec, a bouncing projectile comes to rest
+    float StopSpeed = 5.f;
+
+    ECollisionChannel Channel = ECC_WorldDynamic;
+    FCollisionResponseParams ResponseParams;
+};
+
+/**
+ * Per-world simulation of projectile motion.
+ * The state of every projectile lives in parallel arrays: one loop integrates all of them,
+ * one pass sweeps all of them, and the actors, if any, only follow the result.
+ * Projectiles without an actor cost no more than their array entries.
+ */
+UCLASS()
+class TESTINGGROUNDS_API AProjectileSimulation : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AProjectileSimulation();
+
+    // Steps the simulation
+    virtual void Tick(float DeltaSeconds) override;
+
+    // Returns the simulation of the given world, spawning it if needed
+    static AProjectileSimulation* Get(UWorld* World);
+
+    // Returns true if projectiles should move through the simulation instead of their movement component
+    static bool IsEnabled();
+
+    /**
+     * Starts simulating a projectile. Proxy is the actor that follows it and gets told about its hits, may be null.
+     * Returns the handle of the projectile.
+     */
+    int32 AddProjectile(const FVector& Location, const FVector& Velocity, const FProjectileSimParams& Params, ABallProjectile* Proxy = nullptr);
+
+    // Stops simulating the projectile. Its handle may be handed out again
+    void RemoveProjectile(int32 Handle);
+
+    // Moves every projectile by DeltaSeconds
+    void Simulate(float DeltaSeconds);
+
+    // Returns the number of projectiles in flight
+    int32 GetNumProjectiles() const { return Positions.Num(); }
+
+    // Returns the milliseconds the last step took
+    UFUNCTION(BlueprintCallable, Category = "ProjectileSimulation")
+    float GetLastSimulateTimeMs() const { return LastSimulateTimeMs; }
+
+private:
+    // A hit or an expiry, delivered once the arrays are done changing
+    struct FProjectileEvent
+    {
+        TWeakObjectPtr<ABallProjectile> Proxy;
+        FHitResult Hit;
+        bool bExpired = false;
+    };
+
+    // Applies gravity and speed limits and computes where every projectile wants to go
+    void Integrate(float DeltaSeconds);
+
+    // Sweeps every projectile from its position to its target
+    void Sweep();
+
+    // Moves the projectiles to the end of their sweep, bouncing or stopping the ones that hit something
+    void Resolve(float DeltaSeconds);
+
+    // Places the actors on their projectile
+    void SyncProxies();
+
+    // Removes the projectile at the given array index
+    void RemoveAt(int32 Index);
+
+    // Hot state, touched every step
+    TArray<FVector> Positions;
+    TArray<FVector> Velocities;
+    TArray<FVector> Targets;
+    TArray<float> LifeRemaining;
+    TArray<float> GravityZ;
+    TArray<float> MaxSpeeds;
+    TArray<uint8> bResting;
+
+    // Written by the sweep pass
+    TArray<FHitResult> SweepHits;
+    TArray<uint8> bSweepHit;
+
+    // Cold state, only read on hits
+    TArray<FProjectileSimParams> Params;
+
+    // The actor of every projectile, null for actor-less ones
+    UPROPERTY(Transient)
+    TArray<ABallProjectile*> Proxies;
+
+    // Stable handles on top of the swap-removed arrays
+    TArray<int32> IndexToHandle;
+    TArray<int32> HandleToIndex;
+    TArray<int32> FreeHandles;
+
+    TArray<FProjectileEvent> PendingEvents;
+
+    float LastSimulateTimeMs = 0.f;
+};
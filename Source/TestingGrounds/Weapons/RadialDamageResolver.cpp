@@ -0,0 +1,162 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TestingGrounds.h"
+#include "RadialDamageResolver.h"
+#include "../WorldManager.h"
+
+
+// Sets default values
+ARadialDamageResolver::ARadialDamageResolver()
+{
+    // Only ticks on frames with queued explosions, after the timers that make bombs explode
+	PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.bStartWithTickEnabled = false;
+    PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+}
+
+void ARadialDamageResolver::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    ResolveExplosions();
+}
+
+ARadialDamageResolver* ARadialDamageResolver::Get(UWorld* World)
+{
+    return GetWorldManager<ARadialDamageResolver>(World);
+}
+
+void ARadialDamageResolver::QueueExplosion(const FVector& Origin, float Radius, float BaseDamage, TSubclassOf<UDamageType> DamageType, AActor* DamageCauser, AController* InstigatedBy)
+{
+    if (Radius <= 0.f) return;
+
+    FQueuedExplosion& Explosion = QueuedExplosions[QueuedExplosions.AddDefaulted()];
+    Explosion.Origin = Origin;
+    Explosion.Radius = Radius;
+    Explosion.BaseDamage = BaseDamage;
+    Explosion.DamageType = DamageType;
+    Explosion.DamageCauser = DamageCauser;
+    Explosion.InstigatedBy = InstigatedBy;
+
+    SetActorTickEnabled(true);
+}
+
+void ARadialDamageResolver::ResolveExplosions()
+{
+    // Explosions caused by the damage we're about to apply resolve on the next frame
+    TArray<FQueuedExplosion> Explosions = MoveTemp(QueuedExplosions);
+    QueuedExplosions.Reset();
+    SetActorTickEnabled(false);
+
+    if (Explosions.Num() == 0) return;
+
+    const double StartTime = FPlatformTime::Seconds();
+
+    // Explosions of the same cell share one overlap query
+    TMap<FIntVector, TArray<int32>> Cells;
+    for (int32 i = 0; i < Explosions.Num(); i++)
+    {
+        Cells.FindOrAdd(GetCell(Explosions[i].Origin)).Add(i);
+    }
+
+    // The causers are skipped explosion by explosion, one bomb still gets hit by the others
+    const FCollisionQueryParams OverlapParams(FName("RadialDamage"), false);
+
+    TMap<AActor*, FVictimDamage> Victims;
+    TArray<FOverlapResult> Overlaps;
+
+    for (const auto& Cell : Cells)
+    {
+        FBox Bounds(0);
+        for (int32 ExplosionIndex : Cell.Value)
+        {
+            const FQueuedExplosion& Explosion = Explosions[ExplosionIndex];
+            Bounds += FBox(Explosion.Origin - FVector(Explosion.Radius), Explosion.Origin + FVector(Explosion.Radius));
+        }
+
+        Overlaps.Reset();
+        GetWorld()->OverlapMultiByObjectType(Overlaps,
+                                             Bounds.GetCenter(),
+                                             FQuat::Identity,
+                                             FCollisionObjectQueryParams(FCollisionObjectQueryParams::InitType::AllDynamicObjects),
+                                             FCollisionShape::MakeBox(Bounds.GetExtent()),
+                                             OverlapParams);
+
+        // Explosion by explosion, so the components of a victim are checked one after the other
+        for (int32 ExplosionIndex : Cell.Value)
+        {
+            const FQueuedExplosion& Explosion = Explosions[ExplosionIndex];
+
+            for (const FOverlapResult& Overlap : Overlaps)
+            {
+                AActor* Victim = Overlap.GetActor();
+                UPrimitiveComponent* Component = Overlap.Component.Get();
+                if (Victim == nullptr || Component == nullptr || Victim == Explosion.DamageCauser.Get()) continue;
+
+                if (Component->Bounds.GetBox().ComputeSquaredDistanceToPoint(Explosion.Origin) > FMath::Square(Explosion.Radius)) continue;
+
+                FVictimDamage& VictimDamage = Victims.FindOrAdd(Victim);
+
+                // Another component of the victim already took this explosion
+                if (VictimDamage.LastExplosion == ExplosionIndex) continue;
+                if (!IsComponentReachable(Explosion, Component)) continue;
+
+                VictimDamage.LastExplosion = ExplosionIndex;
+                VictimDamage.Damage += Explosion.BaseDamage;
+                if (VictimDamage.StrongestExplosion == INDEX_NONE || Explosion.BaseDamage > Explosions[VictimDamage.StrongestExplosion].BaseDamage)
+                {
+                    VictimDamage.StrongestExplosion = ExplosionIndex;
+                }
+
+                const FVector HitLocation = Component->Bounds.Origin;
+                VictimDamage.Hits.Add(FHitResult(Victim, Component, HitLocation, (HitLocation - Explosion.Origin).GetSafeNormal()));
+            }
+        }
+    }
+
+    DispatchDamage(Explosions, Victims);
+
+    LastResolveTimeMs = (float)((FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+bool ARadialDamageResolver::IsComponentReachable(const FQueuedExplosion& Explosion, UPrimitiveComponent* Component) const
+{
+    FCollisionQueryParams TraceParams(FName("RadialDamageVisibility"), true, Explosion.DamageCauser.Get());
+
+    FHitResult Hit;
+    GetWorld()->LineTraceSingleByChannel(Hit, Explosion.Origin, Component->Bounds.Origin, ECC_Visibility, TraceParams);
+
+    // Blocked by something other than the victim itself
+    return !Hit.bBlockingHit || Hit.Component.Get() == Component;
+}
+
+FIntVector ARadialDamageResolver::GetCell(const FVector& Location) const
+{
+    return FIntVector(FMath::FloorToInt(Location.X / CellSize),
+                      FMath::FloorToInt(Location.Y / CellSize),
+                      FMath::FloorToInt(Location.Z / CellSize));
+}
+
+void ARadialDamageResolver::DispatchDamage(const TArray<FQueuedExplosion>& Explosions, TMap<AActor*, FVictimDamage>& Victims)
+{
+    for (auto& Pair : Victims)
+    {
+        AActor* Victim = Pair.Key;
+        FVictimDamage& VictimDamage = Pair.Value;
+
+        // The damage of a previous victim may have destroyed this one
+        if (VictimDamage.StrongestExplosion == INDEX_NONE || Victim->IsPendingKill()) continue;
+
+        const FQueuedExplosion& Strongest = Explosions[VictimDamage.StrongestExplosion];
+
+        // Linear falloff to 0 at the radius, the params UGameplayStatics::ApplyRadialDamage hands to TakeDamage by default
+        FRadialDamageEvent DamageEvent;
+        DamageEvent.DamageTypeClass = Strongest.DamageType ? Strongest.DamageType : TSubclassOf<UDamageType>(UDamageType::StaticClass());
+        DamageEvent.Origin = Strongest.Origin;
+        DamageEvent.Params = FRadialDamageParams(VictimDamage.Damage, 0.f, 0.f, Strongest.Radius, 1.f);
+        DamageEvent.ComponentHits = MoveTemp(VictimDamage.Hits);
+
+        // One call per victim per frame, so a character only replicates its health once
+        Victim->TakeDamage(VictimDamage.Damage, DamageEvent, Strongest.InstigatedBy.Get(), Strongest.DamageCauser.Get());
+    }
+}
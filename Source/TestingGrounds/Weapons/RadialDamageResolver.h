@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "RadialDamageResolver.generated.h"
+
+// An explosion waiting for the end of the frame
+struct FQueuedExplosion
+{
+    FVector Origin;
+    float Radius;
+    float BaseDamage;
+    TSubclassOf<UDamageType> DamageType;
+    TWeakObjectPtr<AActor> DamageCauser;
+    TWeakObjectPtr<AController> InstigatedBy;
+};
+
+/**
+ * Per-world resolver of radial damage. Server only.
+ * Explosions are queued during the frame and resolved together at the end of it:
+ * nearby explosions share one overlap query, and every victim gets a single TakeDamage call
+ * with the damage of every explosion that reached it.
+ */
+UCLASS()
+class TESTINGGROUNDS_API ARadialDamageResolver : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ARadialDamageResolver();
+
+    // Resolves the explosions queued this frame
+    virtual void Tick(float DeltaSeconds) override;
+
+    // Returns the resolver of the given world, spawning it if needed
+    static ARadialDamageResolver* Get(UWorld* World);
+
+    // Queues a radial damage to be applied at the end of the frame. Every actor within Radius takes BaseDamage
+    void QueueExplosion(const FVector& Origin, float Radius, float BaseDamage, TSubclassOf<UDamageType> DamageType, AActor* DamageCauser, AController* InstigatedBy);
+
+    // Applies every queued explosion right away
+    void ResolveExplosions();
+
+    // Returns the number of explosions waiting for the end of the frame
+    int32 GetNumQueued() const { return QueuedExplosions.Num(); }
+
+    // Returns the milliseconds the last resolve took
+    UFUNCTION(BlueprintCallable, Category = "RadialDamage")
+    float GetLastResolveTimeMs() const { return LastResolveTimeMs; }
+
+protected:
+    // Explosions falling in the same cell of this size share one overlap query
+    UPROPERTY(EditAnywhere, Category = "RadialDamage")
+    float CellSize = 1000.f;
+
+private:
+    // The damage a single victim collected this frame
+    struct FVictimDamage
+    {
+        float Damage = 0.f;
+
+        // The explosion that dealt the most damage, used to fill the damage event
+        int32 StrongestExplosion = INDEX_NONE;
+
+        // The last explosion that counted this victim - an explosion only hurts a victim once
+        int32 LastExplosion = INDEX_NONE;
+
+        TArray<FHitResult> Hits;
+    };
+
+    // Returns true if nothing blocks the explosion from reaching the component
+    bool IsComponentReachable(const FQueuedExplosion& Explosion, UPrimitiveComponent* Component) const;
+
+    // Returns the cell the given location falls into
+    FIntVector GetCell(const FVector& Location) const;
+
+    // Applies the collected damage of every victim
+    void DispatchDamage(const TArray<FQueuedExplosion>& Explosions, TMap<AActor*, FVictimDamage>& Victims);
+
+    TArray<FQueuedExplosion> QueuedExplosions;
+
+    float LastResolveTimeMs = 0.f;
+};
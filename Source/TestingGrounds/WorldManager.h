@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "EngineUtils.h"
+
+/**
+ * Returns the manager actor of type T that lives in the given world, spawning it on first use.
+ * The result is cached per world, so callers on hot paths don't walk the actor list every time.
+ * Game thread only.
+ */
+template<class T>
+T* GetWorldManager(UWorld* World)
+{
+    if (World == nullptr || World->bIsTearingDown)
+    {
+        return nullptr;
+    }
+
+    static TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<T>> ManagerCache;
+
+    TWeakObjectPtr<T>* CachedManager = ManagerCache.Find(World);
+    if (CachedManager && CachedManager->IsValid())
+    {
+        return CachedManager->Get();
+    }
+
+    // Drop entries of worlds that have been torn down (PIE sessions, seamless travel)
+    for (auto It = ManagerCache.CreateIterator(); It; ++It)
+    {
+        if (!It.Key().IsValid() || !It.Value().IsValid())
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    // A manager may already have been placed in the level
+    T* Manager = nullptr;
+    for (TActorIterator<T> It(World); It; ++It)
+    {
+        Manager = *It;
+        break;
+    }
+
+    if (Manager == nullptr)
+    {
+        FActorSpawnParameters SpawnParams;
+        SpawnParams.ObjectFlags |= RF_Transient;
+        Manager = World->SpawnActor<T>(T::StaticClass(), SpawnParams);
+    }
+
+    if (Manager)
+    {
+        ManagerCache.Add(World, Manager);
+    }
+    return Manager;
+}